@@ -0,0 +1,57 @@
+/**
+ * @file AlignedAllocator.h
+ * @brief STL allocator returning memory aligned to a fixed boundary
+ *
+ */
+
+#ifndef ALIGNEDALLOCATOR_H
+#define ALIGNEDALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+#include <stdlib.h>
+
+/**
+ * Minimal C++11 allocator whose blocks start on an Alignment-byte boundary
+ * (e.g. 64 = one cache line, also enough for AVX-512 loads)
+ */
+template <typename T, std::size_t Alignment>
+class AlignedAllocator
+{
+public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator() {}
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(std::size_t count) {
+        void* ptr = NULL;
+        if (posix_memalign(&ptr, Alignment, count * sizeof(T)) != 0) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, std::size_t) {
+        free(ptr);
+    }
+};
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) {
+    return true;
+}
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) {
+    return false;
+}
+
+#endif /* ALIGNEDALLOCATOR_H */
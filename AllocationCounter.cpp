@@ -0,0 +1,68 @@
+/**
+ * @file AllocationCounter.cpp
+ * @brief Heap allocation counter used to check the solve loops
+ */
+
+#include "AllocationCounter.h"
+
+#ifdef COUNT_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+
+static thread_local unsigned long allocations = 0;
+
+unsigned long AllocationCounter::count() {
+    return allocations;
+}
+
+static void* countedAllocation(std::size_t size) {
+    allocations++;
+    void* p = std::malloc(size > 0 ? size : 1);
+    if (p == NULL) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(std::size_t size) {
+    return countedAllocation(size);
+}
+
+void* operator new[](std::size_t size) {
+    return countedAllocation(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    allocations++;
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    allocations++;
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#else
+
+unsigned long AllocationCounter::count() {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,34 @@
+/**
+ * @file AllocationCounter.h
+ * @brief Heap allocation counter used to check the solve loops
+ *
+ */
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+/**
+ * Counts the calls to operator new made by each thread.
+ *
+ * Counting replaces the global operator new / delete and is only compiled in
+ * with COUNT_ALLOCATIONS (make COUNT_ALLOCATIONS=1); otherwise count() is
+ * always 0. The solvers report the allocations made by their main loop, which
+ * should be none once the first iteration has sized the buffers.
+ */
+class AllocationCounter
+{
+public:
+
+    static bool enabled() {
+#ifdef COUNT_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /** allocations made so far by the calling thread */
+    static unsigned long count();
+};
+
+#endif /* ALLOCATIONCOUNTER_H */
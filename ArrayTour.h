@@ -0,0 +1,110 @@
+/**
+ * @file ArrayTour.h
+ * @brief Tour stored as a node array
+ *
+ */
+
+#ifndef ARRAYTOUR_H
+#define ARRAYTOUR_H
+
+#include <vector>
+
+#include "Tour.h"
+
+/**
+ * Nodes in tour order plus the position of every node. A flip reverses the
+ * shorter of the two paths, wrapping around the end of the array, so it moves
+ * at most n / 2 nodes; node 0 may leave position 0, toSequence() rotates back.
+ */
+class ArrayTour final : public Tour
+{
+public:
+
+    explicit ArrayTour(int n) : mTour(n), mPos(n) {
+        for (int i = 0; i < n; i++) {
+            mTour[i] = mPos[i] = i;
+        }
+    }
+
+    int size() const {
+        return (int)mTour.size();
+    }
+
+    void load(const std::vector<int>& sequence) {
+        for (int p = 0; p < size(); p++) {
+            mTour[p] = sequence[p];
+            mPos[sequence[p]] = p;
+        }
+    }
+
+    void toSequence(std::vector<int>& sequence) const {
+        const int n = size();
+        sequence.resize(n + 1);
+        for (int k = 0; k < n; k++) {
+            int p = mPos[0] + k;
+            sequence[k] = mTour[p < n ? p : p - n];
+        }
+        sequence[n] = 0;
+    }
+
+    inline int next(int a) const {
+        int p = mPos[a] + 1;
+        return mTour[p == size() ? 0 : p];
+    }
+
+    inline int prev(int a) const {
+        int p = mPos[a];
+        return mTour[p == 0 ? size() - 1 : p - 1];
+    }
+
+    inline bool between(int a, int b, int c) const {
+        int pa = mPos[a], pb = mPos[b], pc = mPos[c];
+        if (pa <= pc) {
+            return pa <= pb && pb <= pc;
+        }
+        return pb >= pa || pb <= pc;
+    }
+
+    void flip(int a, int b, int c, int d) {
+        const int n = size();
+        int inside = mPos[c] - mPos[b];     // nodes on b ... c, minus one
+        if (inside < 0) {
+            inside += n;
+        }
+        if (2 * (inside + 1) <= n) {
+            reverse(mPos[b], inside + 1);
+        } else {
+            reverse(mPos[d], n - inside - 1);
+        }
+    }
+
+private:
+
+    // reverse the `count` positions from i, wrapping around the end
+    void reverse(int i, int count) {
+        const int n = size();
+        int j = i + count - 1;
+        if (j >= n) {
+            j -= n;
+        }
+        for (int k = count / 2; k > 0; k--) {
+            int u = mTour[i];
+            int v = mTour[j];
+            mTour[i] = v;
+            mPos[v] = i;
+            mTour[j] = u;
+            mPos[u] = j;
+            if (++i == n) {
+                i = 0;
+            }
+            if (--j < 0) {
+                j = n - 1;
+            }
+        }
+    }
+
+    std::vector<int> mTour;     // node at each position
+    std::vector<int> mPos;      // position of each node
+};
+
+#endif /* ARRAYTOUR_H */
@@ -0,0 +1,336 @@
+/**
+ * @file BenchmarkRunner.cpp
+ * @brief Benchmark matrix (instances x solvers x seeds x budgets), results file and regression check
+ */
+
+#include "BenchmarkRunner.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <map>
+#include <cmath>
+#include <cstdlib>
+
+#include "TSP.h"
+#include "TSPSolution.h"
+#include "TourConstruction.h"
+#include "SolverOptions.h"
+#include "CpuTime.h"
+#include "Logger.h"
+
+using namespace std;
+
+namespace {
+
+const char* const HEADER =
+    "instance,solver,budget,runs,"
+    "value_mean,value_median,value_best,value_worst,value_sd,value_ci95_low,value_ci95_high,"
+    "cpu_mean,cpu_sd,iterations_mean,"
+    "throughput_mean,throughput_median,throughput_sd,throughput_ci95_low,throughput_ci95_high";
+
+vector<string> split(const string& line, char separator) {
+    vector<string> fields;
+    stringstream in(line);
+    string field;
+    while (getline(in, field, separator)) {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+vector<string> tokens(const string& line) {
+    vector<string> words;
+    istringstream in(line);
+    string word;
+    while (in >> word) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+}
+
+
+void BenchmarkRunner::readConfig(const string& filename) {
+    ifstream in(filename.c_str());
+    if (!in) {
+        throw runtime_error("cannot open " + filename);
+    }
+
+    string line;
+    for (int number = 1; getline(in, line); number++) {
+        line = line.substr(0, line.find('#'));
+        vector<string> words = tokens(line);
+        if (words.empty()) {
+            continue;
+        }
+
+        ostringstream where;
+        where << filename << ":" << number << ": ";
+
+        const string& directive = words[0];
+        if ((directive == "instance" || directive == "solver" || directive == "budget") && words.size() >= 2
+                && words[1].find(',') != string::npos) {
+            throw runtime_error(where.str() + "no comma in an instance or a name, it goes into a CSV field");
+        }
+
+        if (directive == "instance" && words.size() == 2) {
+            mInstances.push_back(words[1]);
+        } else if ((directive == "solver" || directive == "budget") && words.size() >= 2) {
+            Entry entry;
+            entry.name = words[1];
+            entry.options.assign(words.begin() + 2, words.end());
+            (directive == "solver" ? mSolvers : mBudgets).push_back(entry);
+        } else if (directive == "seeds" && words.size() >= 2) {
+            for (size_t i = 1; i < words.size(); i++) {
+                char* end;
+                unsigned long seed = strtoul(words[i].c_str(), &end, 0);
+                if (*end != '\0') {
+                    throw runtime_error(where.str() + "bad seed '" + words[i] + "'");
+                }
+                mSeeds.push_back(seed);
+            }
+        } else {
+            throw runtime_error(where.str() + "expected instance <file>, solver <name> <options>, "
+                                "budget <name> <options> or seeds <seed> ...");
+        }
+    }
+
+    if (mInstances.empty() || mSolvers.empty()) {
+        throw runtime_error(filename + ": at least an instance and a solver");
+    }
+    if (mBudgets.empty()) {
+        mBudgets.push_back(Entry());
+        mBudgets.back().name = "default";
+    }
+    if (mSeeds.empty()) {
+        mSeeds.push_back(1);
+    }
+
+    // bad options are reported now, not after hours of runs
+    for (size_t s = 0; s < mSolvers.size(); s++) {
+        for (size_t b = 0; b < mBudgets.size(); b++) {
+            SolverOptions options;
+            options.parse(mSolvers[s].options);
+            options.parse(mBudgets[b].options);
+        }
+    }
+}
+
+void BenchmarkRunner::run() {
+    mCells.clear();
+
+    const size_t runs = mInstances.size() * mSolvers.size() * mBudgets.size() * mSeeds.size();
+    size_t done = 0;
+
+    for (size_t i = 0; i < mInstances.size(); i++) {
+        TSP tsp;
+        tsp.readFromFile(mInstances[i].c_str());
+
+        int builtCandidates = 0;
+        bool builtQuadrant = false;
+
+        for (size_t s = 0; s < mSolvers.size(); s++) {
+            for (size_t b = 0; b < mBudgets.size(); b++) {
+                SolverOptions options;
+                options.parse(mSolvers[s].options);
+                options.parse(mBudgets[b].options);
+
+                if (options.candidates > 0 && (options.candidates != builtCandidates || options.quadrant != builtQuadrant)) {
+                    tsp.buildCandidateLists(options.candidates, options.quadrant);
+                    builtCandidates = options.candidates;
+                    builtQuadrant = options.quadrant;
+                }
+
+                vector<double> values, cpuTimes, iterations, throughputs;
+
+                for (size_t r = 0; r < mSeeds.size(); r++) {
+                    const unsigned long seed = mSeeds[r];
+
+                    TSPSolution init(tsp);
+                    if (options.initMethod == TourConstruction::RANDOM) {
+                        init.initRandom(seed);
+                        init.evaluate(tsp);
+                    } else {
+                        TourConstruction::build(tsp, options.initMethod, init, seed);
+                    }
+
+                    Solver* solver = options.buildSolver(seed);
+                    TSPSolution best(init);
+
+                    // the CPU time of the thread leaves out the logger's
+                    double start = threadCpuTime();
+                    bool ok = solver->solve(tsp, init, best);
+                    double cpuTime = threadCpuTime() - start + solver->workerCpuTime();
+
+                    string stop = solver->stopCriteria().reasonName();
+                    delete solver;
+
+                    if (!ok) {
+                        throw runtime_error("run failed: " + mInstances[i] + " " + mSolvers[s].name + " " + mBudgets[b].name);
+                    }
+
+                    values.push_back(best.value());
+                    cpuTimes.push_back(cpuTime);
+                    iterations.push_back(best.iterations);
+                    throughputs.push_back(best.iterations / max(cpuTime, 1e-9));
+
+                    LOG_INFO << "[" << ++done << "/" << runs << "] " << mInstances[i] << " " << mSolvers[s].name
+                             << " " << mBudgets[b].name << " seed " << seed << ": value " << best.value()
+                             << "\tCPU " << cpuTime << " s\titerations " << best.iterations << "\tstop: " << stop;
+                }
+
+                Cell cell;
+                cell.instance = mInstances[i];
+                cell.solver = mSolvers[s].name;
+                cell.budget = mBudgets[b].name;
+                cell.value = Statistics(values);
+                cell.cpuTime = Statistics(cpuTimes);
+                cell.iterations = Statistics(iterations);
+                cell.throughput = Statistics(throughputs);
+                mCells.push_back(cell);
+            }
+        }
+    }
+}
+
+void BenchmarkRunner::writeResults(const string& filename) const {
+    ofstream out(filename.c_str());
+    if (!out) {
+        throw runtime_error("cannot create " + filename);
+    }
+    out.precision(10);
+    out << HEADER << "\n";
+
+    for (size_t c = 0; c < mCells.size(); c++) {
+        const Cell& cell = mCells[c];
+        double valueCi = cell.value.confidenceHalfWidth();
+        double throughputCi = cell.throughput.confidenceHalfWidth();
+
+        out << cell.instance << ',' << cell.solver << ',' << cell.budget << ',' << cell.value.n << ','
+            << cell.value.mean << ',' << cell.value.median << ',' << cell.value.min << ',' << cell.value.max << ','
+            << cell.value.sd << ',' << cell.value.mean - valueCi << ',' << cell.value.mean + valueCi << ','
+            << cell.cpuTime.mean << ',' << cell.cpuTime.sd << ',' << cell.iterations.mean << ','
+            << cell.throughput.mean << ',' << cell.throughput.median << ',' << cell.throughput.sd << ','
+            << cell.throughput.mean - throughputCi << ',' << cell.throughput.mean + throughputCi << "\n";
+    }
+
+    if (!out) {
+        throw runtime_error("cannot write " + filename);
+    }
+    LOG_INFO << "results written to " << filename;
+}
+
+vector<BenchmarkRunner::Cell> BenchmarkRunner::readResults(const string& filename) {
+    ifstream in(filename.c_str());
+    if (!in) {
+        throw runtime_error("cannot open " + filename);
+    }
+
+    string line;
+    getline(in, line);
+    vector<string> header = split(line, ',');
+    map<string, size_t> column;
+    for (size_t k = 0; k < header.size(); k++) {
+        column[header[k]] = k;
+    }
+
+    const char* required[] = {"instance", "solver", "budget", "runs", "value_mean", "value_median", "value_best",
+                              "value_worst", "value_sd", "cpu_mean", "cpu_sd", "iterations_mean",
+                              "throughput_mean", "throughput_median", "throughput_sd"};
+    for (size_t k = 0; k < sizeof(required) / sizeof(required[0]); k++) {
+        if (column.find(required[k]) == column.end()) {
+            throw runtime_error(filename + ": not a benchmark results file (no " + required[k] + " column)");
+        }
+    }
+
+    vector<Cell> cells;
+    for (int number = 2; getline(in, line); number++) {
+        if (line.empty()) {
+            continue;
+        }
+        vector<string> fields = split(line, ',');
+        if (fields.size() != header.size()) {
+            ostringstream message;
+            message << filename << ":" << number << ": " << fields.size() << " fields, " << header.size() << " expected";
+            throw runtime_error(message.str());
+        }
+
+        Cell cell;
+        cell.instance = fields[column["instance"]];
+        cell.solver = fields[column["solver"]];
+        cell.budget = fields[column["budget"]];
+
+        int runs = atoi(fields[column["runs"]].c_str());
+        cell.value.n = cell.cpuTime.n = cell.iterations.n = cell.throughput.n = runs;
+        cell.value.mean = atof(fields[column["value_mean"]].c_str());
+        cell.value.median = atof(fields[column["value_median"]].c_str());
+        cell.value.min = atof(fields[column["value_best"]].c_str());
+        cell.value.max = atof(fields[column["value_worst"]].c_str());
+        cell.value.sd = atof(fields[column["value_sd"]].c_str());
+        cell.cpuTime.mean = atof(fields[column["cpu_mean"]].c_str());
+        cell.cpuTime.sd = atof(fields[column["cpu_sd"]].c_str());
+        cell.iterations.mean = atof(fields[column["iterations_mean"]].c_str());
+        cell.throughput.mean = atof(fields[column["throughput_mean"]].c_str());
+        cell.throughput.median = atof(fields[column["throughput_median"]].c_str());
+        cell.throughput.sd = atof(fields[column["throughput_sd"]].c_str());
+        cells.push_back(cell);
+    }
+
+    return cells;
+}
+
+int BenchmarkRunner::compare(const vector<Cell>& baseline, double qualityTolerance, double speedTolerance, double alpha) const {
+    map<string, const Cell*> base;
+    for (size_t c = 0; c < baseline.size(); c++) {
+        base[baseline[c].instance + "," + baseline[c].solver + "," + baseline[c].budget] = &baseline[c];
+    }
+
+    int regressions = 0;
+
+    LOG_INFO << "------------------------------- BASELINE -------------------------------------";
+
+    for (size_t c = 0; c < mCells.size(); c++) {
+        const Cell& cell = mCells[c];
+        const string key = cell.instance + "," + cell.solver + "," + cell.budget;
+
+        map<string, const Cell*>::const_iterator found = base.find(key);
+        if (found == base.end()) {
+            LOG_INFO << key << ": not in the baseline";
+            continue;
+        }
+        const Cell& old = *found->second;
+
+        // relative changes, positive = worse
+        double quality = (cell.value.mean - old.value.mean) / max(fabs(old.value.mean), 1e-12);
+        double speed = (old.throughput.mean - cell.throughput.mean) / max(fabs(old.throughput.mean), 1e-12);
+
+        double pQuality = Statistics::pGreater(cell.value, old.value);
+        double pSpeed = Statistics::pGreater(old.throughput, cell.throughput);
+
+        bool worseQuality = quality > qualityTolerance && pQuality < alpha;
+        bool worseSpeed = speed > speedTolerance && pSpeed < alpha;
+        bool betterQuality = -quality > qualityTolerance && Statistics::pGreater(old.value, cell.value) < alpha;
+        bool betterSpeed = -speed > speedTolerance && Statistics::pGreater(cell.throughput, old.throughput) < alpha;
+
+        string verdict;
+        if (worseQuality || worseSpeed) {
+            verdict = string("REGRESSION") + (worseQuality ? " quality" : "") + (worseSpeed ? " speed" : "");
+            regressions++;
+        } else if (betterQuality || betterSpeed) {
+            verdict = string("improved") + (betterQuality ? " quality" : "") + (betterSpeed ? " speed" : "");
+        } else {
+            verdict = "ok";
+        }
+
+        LOG_AT(worseQuality || worseSpeed ? Logger::WARN : Logger::INFO) << key << ": value " << old.value.mean << " -> " << cell.value.mean
+                 << " (" << (quality >= 0 ? "+" : "") << 100 * quality << " %, p " << pQuality << ")"
+                 << "\tthroughput " << old.throughput.mean << " -> " << cell.throughput.mean
+                 << " (" << (speed > 0 ? "-" : "+") << 100 * fabs(speed) << " %, p " << pSpeed << ")"
+                 << "\t" << verdict;
+    }
+
+    LOG_AT(regressions > 0 ? Logger::WARN : Logger::INFO) << regressions << " regression(s)";
+    return regressions;
+}
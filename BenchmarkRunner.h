@@ -0,0 +1,99 @@
+/**
+ * @file BenchmarkRunner.h
+ * @brief Benchmark matrix (instances x solvers x seeds x budgets), results file and regression check
+ *
+ */
+
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include <string>
+#include <vector>
+
+#include "Statistics.h"
+
+/**
+ * Runs every combination of a benchmark config and summarizes the seeds of each
+ * cell (instance, solver, budget).
+ *
+ * Config, one directive per line, # starts a comment:
+ *
+ *   instance <file>                 instance file (any format of TSP::readFromFile)
+ *   solver <name> <options>         solver options of main, e.g. --ts --tenure 50
+ *   budget <name> <options>         stop options added to every solver, e.g. --secs 2
+ *   seeds <seed> ...                one run per seed: the random initial tour (--init
+ *                                   random) and the random generator of the solver
+ *
+ * Runs execute one at a time, so that their CPU times do not interfere (the CPU
+ * time is the one of the calling thread, plus that of the islands). The
+ * results file is CSV, one line per cell: the value (mean, median, best, standard
+ * deviation, 95% confidence interval of the mean), the CPU time, the iterations
+ * and the throughput (iterations per CPU second, with its interval).
+ *
+ * compare() reads a results file of a previous run (the baseline) and reports a
+ * regression for a cell whose mean value is higher, or whose mean throughput is
+ * lower, by more than a relative tolerance with a one-sided Welch t-test below
+ * alpha.
+ */
+class BenchmarkRunner
+{
+public:
+
+    /** summary of the runs of a cell */
+    struct Cell {
+        std::string instance;
+        std::string solver;
+        std::string budget;
+        Statistics value;
+        Statistics cpuTime;
+        Statistics iterations;
+        Statistics throughput;  // iterations per CPU second
+    };
+
+    /**
+     * @throw std::runtime_error on a malformed config (the solver options are checked too)
+     */
+    void readConfig(const std::string& filename);
+
+    /** execute every run, the cells are then in cells() */
+    void run();
+
+    const std::vector<Cell>& cells() const {
+        return mCells;
+    }
+
+    /**
+     * @throw std::runtime_error if the file cannot be written
+     */
+    void writeResults(const std::string& filename) const;
+
+    /**
+     * @throw std::runtime_error if the file cannot be read or is not a results file
+     */
+    static std::vector<Cell> readResults(const std::string& filename);
+
+    /**
+     * compare the cells with those of the baseline (same instance, solver and budget)
+     * @param qualityTolerance relative increase of the mean value tolerated, 0.005 = 0.5%
+     * @param speedTolerance relative decrease of the mean throughput tolerated
+     * @param alpha significance level of the tests
+     * @return number of regressions
+     */
+    int compare(const std::vector<Cell>& baseline, double qualityTolerance, double speedTolerance, double alpha) const;
+
+private:
+
+    struct Entry {
+        std::string name;
+        std::vector<std::string> options;
+    };
+
+    std::vector<std::string> mInstances;
+    std::vector<Entry> mSolvers;
+    std::vector<Entry> mBudgets;
+    std::vector<unsigned long> mSeeds;
+
+    std::vector<Cell> mCells;
+};
+
+#endif /* BENCHMARKRUNNER_H */
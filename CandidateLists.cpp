@@ -0,0 +1,264 @@
+/**
+ * @file CandidateLists.cpp
+ * @brief Candidate neighbour lists used to prune the 2-opt neighbourhood
+ */
+
+#include "CandidateLists.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <utility>
+
+#include "TSP.h"
+#include "RowCache.h"
+
+using namespace std;
+
+namespace {
+
+// orders candidates by cost, ties by node index so lists are deterministic
+struct ByCost {
+    const double* costs;
+    bool operator()(int a, int b) const {
+        return costs[a] < costs[b] || (costs[a] == costs[b] && a < b);
+    }
+};
+
+// bounded max-heap of (squared distance, node): keeps the `capacity` nearest nodes seen
+class NearestHeap {
+public:
+    explicit NearestHeap(int capacity = 0) : mCapacity(capacity) {}
+
+    void push(double d2, int j) {
+        if ((int)mHeap.size() < mCapacity) {
+            mHeap.push(make_pair(d2, j));
+        } else if (mCapacity > 0 && make_pair(d2, j) < mHeap.top()) {
+            mHeap.pop();
+            mHeap.push(make_pair(d2, j));
+        }
+    }
+
+    bool full() const {
+        return (int)mHeap.size() >= mCapacity;
+    }
+
+    double worst() const {
+        return mHeap.empty() ? 0.0 : mHeap.top().first;
+    }
+
+    void drain(vector<int>& out) {
+        while (!mHeap.empty()) {
+            out.push_back(mHeap.top().second);
+            mHeap.pop();
+        }
+    }
+
+private:
+    int mCapacity;
+    priority_queue< pair<double, int> > mHeap;
+};
+
+}
+
+
+CandidateLists::CandidateLists(const TSP& tsp, int k, bool quadrant)
+    : mK(k), mQuadrant(quadrant)
+{
+    if (mK > tsp.n - 1) {
+        mK = tsp.n - 1;
+    }
+    if (mK < 0) {
+        mK = 0;
+    }
+
+    const TSPCoordinates* coords = tsp.coordinates();
+    bool planar = coords != NULL && coords->type() != TSPCoordinates::GEO;
+
+    if (!planar) {
+        mQuadrant = false;
+    }
+
+    if (planar && tsp.n > 4 * mK) {
+        buildFromGrid(tsp);
+    } else {
+        buildFromRows(tsp);
+    }
+}
+
+bool CandidateLists::contains(int i, int j) const {
+    for (const int* it = begin(i); it != end(i); ++it) {
+        if (*it == j) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CandidateLists::buildFromRows(const TSP& tsp) {
+    const int n = tsp.n;
+    RowCache rows(2);
+
+    mOffset.assign(n + 1, 0);
+    mNeighbors.clear();
+    mNeighbors.reserve((size_t)n * mK);
+
+    vector<int> others;
+    others.reserve(n);
+
+    for (int i = 0; i < n; i++) {
+        ByCost byCost;
+        byCost.costs = rows.row(tsp, i);
+
+        others.clear();
+        for (int j = 0; j < n; j++) {
+            if (j != i) {
+                others.push_back(j);
+            }
+        }
+
+        nth_element(others.begin(), others.begin() + mK, others.end(), byCost);
+        sort(others.begin(), others.begin() + mK, byCost);
+
+        mNeighbors.insert(mNeighbors.end(), others.begin(), others.begin() + mK);
+        mOffset[i + 1] = mNeighbors.size();
+    }
+}
+
+void CandidateLists::buildFromGrid(const TSP& tsp) {
+    const int n = tsp.n;
+    const TSPCoordinates& coords = *tsp.coordinates();
+
+    // uniform grid with about two nodes per cell
+    double minX = coords.x(0), maxX = coords.x(0);
+    double minY = coords.y(0), maxY = coords.y(0);
+    for (int i = 1; i < n; i++) {
+        minX = min(minX, coords.x(i));
+        maxX = max(maxX, coords.x(i));
+        minY = min(minY, coords.y(i));
+        maxY = max(maxY, coords.y(i));
+    }
+
+    const int G = max(1, (int)ceil(sqrt(n / 2.0)));
+    const double cellW = max((maxX - minX) / G, 1e-9);
+    const double cellH = max((maxY - minY) / G, 1e-9);
+    const double cellMin = min(cellW, cellH);
+
+    vector<int> cellOf(n);
+    vector<int> cellStart(G * G + 1, 0);
+    for (int i = 0; i < n; i++) {
+        int cx = min(G - 1, (int)((coords.x(i) - minX) / cellW));
+        int cy = min(G - 1, (int)((coords.y(i) - minY) / cellH));
+        cellOf[i] = cy * G + cx;
+        cellStart[cellOf[i] + 1]++;
+    }
+    for (int c = 0; c < G * G; c++) {
+        cellStart[c + 1] += cellStart[c];
+    }
+    vector<int> cellPoints(n);
+    vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+    for (int i = 0; i < n; i++) {
+        cellPoints[fill[cellOf[i]]++] = i;
+    }
+
+    const int perQuadrant = max(1, mK / 4);
+
+    mOffset.assign(n + 1, 0);
+    mNeighbors.clear();
+    mNeighbors.reserve((size_t)n * mK);
+
+    vector<int> chosen;
+    vector<int> nearest;
+    vector<double> costs(n, 0.0);
+
+    for (int i = 0; i < n; i++) {
+        const double xi = coords.x(i);
+        const double yi = coords.y(i);
+        const int cx = cellOf[i] % G;
+        const int cy = cellOf[i] / G;
+
+        NearestHeap all(mK);
+        NearestHeap quadrants[4] = {
+            NearestHeap(mQuadrant ? perQuadrant : 0), NearestHeap(mQuadrant ? perQuadrant : 0),
+            NearestHeap(mQuadrant ? perQuadrant : 0), NearestHeap(mQuadrant ? perQuadrant : 0)
+        };
+
+        // last ring that still reaches each quadrant (x >= xi / x < xi, y >= yi / y < yi)
+        int reach[4];
+        reach[0] = max(G - 1 - cx, G - 1 - cy);
+        reach[1] = max(cx, G - 1 - cy);
+        reach[2] = max(G - 1 - cx, cy);
+        reach[3] = max(cx, cy);
+        const int lastRing = max(max(reach[0], reach[1]), max(reach[2], reach[3]));
+
+        for (int r = 0; r <= lastRing; r++) {
+            for (int gy = cy - r; gy <= cy + r; gy++) {
+                if (gy < 0 || gy >= G) {
+                    continue;
+                }
+                bool edgeRow = (gy == cy - r || gy == cy + r);
+                for (int gx = cx - r; gx <= cx + r; gx += (edgeRow ? 1 : 2 * r)) {
+                    if (gx >= 0 && gx < G) {
+                        int cell = gy * G + gx;
+                        for (int p = cellStart[cell]; p < cellStart[cell + 1]; p++) {
+                            int j = cellPoints[p];
+                            if (j == i) {
+                                continue;
+                            }
+                            double dx = coords.x(j) - xi;
+                            double dy = coords.y(j) - yi;
+                            double d2 = dx * dx + dy * dy;
+
+                            all.push(d2, j);
+                            if (mQuadrant) {
+                                quadrants[(dx >= 0 ? 0 : 1) + (dy >= 0 ? 0 : 2)].push(d2, j);
+                            }
+                        }
+                    }
+                    if (r == 0) {
+                        break;
+                    }
+                }
+            }
+
+            // nodes in later rings are at least r cells away
+            double bound = r * cellMin;
+            bool done = all.full() && all.worst() <= bound * bound;
+            for (int q = 0; q < 4 && done && mQuadrant; q++) {
+                done = r >= reach[q] || (quadrants[q].full() && quadrants[q].worst() <= bound * bound);
+            }
+            if (done) {
+                break;
+            }
+        }
+
+        chosen.clear();
+        for (int q = 0; q < 4; q++) {
+            quadrants[q].drain(chosen);
+        }
+        nearest.clear();
+        all.drain(nearest);
+
+        // nearest first: the heap drains from the farthest
+        for (int t = (int)nearest.size() - 1; t >= 0 && (int)chosen.size() < mK; t--) {
+            if (find(chosen.begin(), chosen.end(), nearest[t]) == chosen.end()) {
+                chosen.push_back(nearest[t]);
+            }
+        }
+
+        for (size_t t = 0; t < chosen.size(); t++) {
+            costs[chosen[t]] = tsp.cost(i, chosen[t]);
+        }
+        ByCost byCost;
+        byCost.costs = &costs[0];
+        sort(chosen.begin(), chosen.end(), byCost);
+
+        // k < 4: one node per quadrant is more than k, keep the nearest ones
+        if ((int)chosen.size() > mK) {
+            chosen.resize(mK);
+        }
+
+        mNeighbors.insert(mNeighbors.end(), chosen.begin(), chosen.end());
+        mOffset[i + 1] = mNeighbors.size();
+    }
+}
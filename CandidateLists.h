@@ -0,0 +1,74 @@
+/**
+ * @file CandidateLists.h
+ * @brief Candidate neighbour lists used to prune the 2-opt neighbourhood
+ *
+ */
+
+#ifndef CANDIDATELISTS_H
+#define CANDIDATELISTS_H
+
+#include <vector>
+
+class TSP;
+
+/**
+ * For every node the k nearest nodes, sorted by increasing cost.
+ *
+ * With quadrant neighbours (EUC_2D / ATT instances only) each node first gets
+ * the k/4 nearest nodes of each of the four quadrants around it and the list
+ * is then topped up with the nearest remaining nodes, which keeps clustered
+ * instances connected; for k < 4 the list holds the k nearest of the nearest
+ * node of each quadrant. Matrix instances have no geometry and ignore the flag.
+ *
+ * Lists are stored back to back (CSR layout): the candidates of node i are
+ * begin(i) ... end(i).
+ */
+class CandidateLists
+{
+public:
+
+    static const int DEFAULT_K = 10;
+
+    /**
+     * build the lists, O(n^2) for matrix and GEO instances, grid search
+     * (about O(n k log k)) for planar coordinate instances
+     */
+    CandidateLists(const TSP& tsp, int k = DEFAULT_K, bool quadrant = false);
+
+    inline const int* begin(int i) const {
+        return &mNeighbors[mOffset[i]];
+    }
+
+    inline const int* end(int i) const {
+        return &mNeighbors[0] + mOffset[i + 1];
+    }
+
+    inline int size(int i) const {
+        return mOffset[i + 1] - mOffset[i];
+    }
+
+    inline int k() const {
+        return mK;
+    }
+
+    inline bool quadrant() const {
+        return mQuadrant;
+    }
+
+    /** true if j is a candidate of i */
+    bool contains(int i, int j) const;
+
+private:
+
+    void buildFromRows(const TSP& tsp);
+
+    void buildFromGrid(const TSP& tsp);
+
+    int mK;
+    bool mQuadrant;
+
+    std::vector<int> mOffset;       // n + 1 entries
+    std::vector<int> mNeighbors;
+};
+
+#endif /* CANDIDATELISTS_H */
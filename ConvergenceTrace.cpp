@@ -0,0 +1,77 @@
+/**
+ * @file ConvergenceTrace.cpp
+ * @brief Samples (time, iteration, incumbent value) of a search, for convergence and time-to-target analysis
+ */
+
+#include "ConvergenceTrace.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+// at least 2 samples in the second half, so that decimate() frees one
+ConvergenceTrace::ConvergenceTrace(size_t capacity) : mSamples(max(capacity, (size_t)4)) {
+    clear();
+}
+
+void ConvergenceTrace::decimate() {
+    // keep the samples at an even distance from the last one
+    const size_t head = mSamples.size() / 2;
+    size_t kept = head;
+    for (size_t i = head + (mSize - 1 - head) % 2; i < mSize; i += 2) {
+        mSamples[kept++] = mSamples[i];
+    }
+    mSize = kept;
+    mExactTail = kept;
+}
+
+double ConvergenceTrace::timeToTarget(double target, bool* exact) const {
+    // the values only decrease: the first sample at or below the target
+    for (size_t i = 0; i < mSize; i++) {
+        if (mSamples[i].value <= target) {
+            if (exact != NULL) {
+                *exact = i < mExactHead || i >= mExactTail;
+            }
+            return mSamples[i].seconds;
+        }
+    }
+    if (exact != NULL) {
+        *exact = true;
+    }
+    return -1;
+}
+
+void ConvergenceTrace::mergeBest(const vector<const ConvergenceTrace*>& traces) {
+    vector<Sample> all;
+    bool decimated = false;
+    for (size_t t = 0; t < traces.size(); t++) {
+        decimated = decimated || traces[t]->dropped() > 0;
+        for (size_t i = 0; i < traces[t]->size(); i++) {
+            all.push_back((*traces[t])[i]);
+        }
+    }
+    stable_sort(all.begin(), all.end(), [](const Sample& a, const Sample& b) {
+        return a.seconds < b.seconds;
+    });
+
+    clear();
+    double best = numeric_limits<double>::infinity();
+    for (size_t i = 0; i < all.size(); i++) {
+        if (all[i].value < best) {
+            best = all[i].value;
+            record(all[i].seconds, all[i].iteration, all[i].value);
+        }
+    }
+    if (decimated) {
+        mExactHead = 0;
+        mExactTail = mSize;
+    }
+}
+
+void ConvergenceTrace::writeCsv(ostream& out, const string& columns) const {
+    for (size_t i = 0; i < size(); i++) {
+        const Sample& sample = (*this)[i];
+        out << columns << ',' << sample.seconds << ',' << sample.iteration << ',' << sample.value << '\n';
+    }
+}
@@ -0,0 +1,111 @@
+/**
+ * @file ConvergenceTrace.h
+ * @brief Samples (time, iteration, incumbent value) of a search, for convergence and time-to-target analysis
+ *
+ */
+
+#ifndef CONVERGENCETRACE_H
+#define CONVERGENCETRACE_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstddef>
+
+/**
+ * Improvements of the incumbent of one run, recorded by StopCriteria::stop()
+ * (see StopCriteria::setTrace()) into a buffer allocated once by the constructor:
+ * recording is a few stores, no allocation and no I/O. The first half of the
+ * buffer keeps the first samples; when the buffer is full, every other sample of
+ * the second half is dropped (the last one is kept), so the later samples are
+ * decimated more and more. dropped() tells how many, and timeToTarget() whether
+ * its answer is exact.
+ *
+ * The samples are written and summarized after the run (writeCsv(), timeToTarget()).
+ */
+class ConvergenceTrace
+{
+public:
+
+    struct Sample {
+        double seconds;     // wall-clock seconds since the start of the search
+        long iteration;     // in the unit of the solver (see StopCriteria)
+        double value;       // best value found so far
+    };
+
+    static const size_t DEFAULT_CAPACITY = 1 << 14;
+
+    explicit ConvergenceTrace(size_t capacity = DEFAULT_CAPACITY);
+
+    void clear() {
+        mSize = 0;
+        mRecorded = 0;
+        mExactHead = mSamples.size() / 2;
+        mExactTail = 0;
+    }
+
+    inline void record(double seconds, long iteration, double value) {
+        if (mSize == mSamples.size()) {
+            decimate();
+        }
+        Sample& sample = mSamples[mSize++];
+        sample.seconds = seconds;
+        sample.iteration = iteration;
+        sample.value = value;
+        mRecorded++;
+    }
+
+    /** samples kept */
+    size_t size() const {
+        return mSize;
+    }
+
+    /** samples dropped when the buffer was full */
+    size_t dropped() const {
+        return mRecorded - mSize;
+    }
+
+    /** @param i 0 = oldest sample kept */
+    const Sample& operator[](size_t i) const {
+        return mSamples[i];
+    }
+
+    /**
+     * @param exact (output, optional) false if samples were dropped just before
+     *        the first one at or below target: the result is then an upper bound,
+     *        the incumbent reached the target after the previous sample kept
+     * @return seconds until the incumbent first reached target or better, < 0 if
+     *         it never did
+     */
+    double timeToTarget(double target, bool* exact = NULL) const;
+
+    /**
+     * replace the samples by the global incumbent of several searches running at
+     * the same time (the islands of a parallel search): their samples in time
+     * order, those improving the best value of all. If a trace dropped samples,
+     * no time to target of the merged trace is exact
+     */
+    void mergeBest(const std::vector<const ConvergenceTrace*>& traces);
+
+    /**
+     * one line "<columns>,<seconds>,<iteration>,<value>" per sample
+     * @param columns first columns of every line, identify the run
+     */
+    void writeCsv(std::ostream& out, const std::string& columns) const;
+
+private:
+
+    /** drop every other sample of the second half of the buffer, the last one kept */
+    void decimate();
+
+    std::vector<Sample> mSamples;
+    size_t mSize;
+    size_t mRecorded;
+
+    // the samples before mExactHead and from mExactTail on follow the previous
+    // sample recorded, the others may follow dropped ones
+    size_t mExactHead;
+    size_t mExactTail;
+};
+
+#endif /* CONVERGENCETRACE_H */
@@ -0,0 +1,116 @@
+/**
+ * @file CoolingSchedule.h
+ * @brief Temperature schedules of the simulated annealing solver
+ *
+ */
+
+#ifndef COOLINGSCHEDULE_H
+#define COOLINGSCHEDULE_H
+
+#include <string>
+#include <sstream>
+#include <cmath>
+
+/**
+ * Temperature of each epoch (a fixed number of proposals) of a simulated annealing run.
+ */
+class CoolingSchedule
+{
+public:
+
+    virtual ~CoolingSchedule() {}
+
+    virtual CoolingSchedule* clone() const = 0;
+
+    virtual std::string getName() const = 0;
+
+    /**
+     * called before the first epoch
+     * @param temperature initial temperature
+     */
+    virtual void start(double temperature) {}
+
+    /**
+     * temperature of the next epoch
+     * @param temperature temperature of the epoch just ended
+     * @param progress elapsed fraction of the budget, 0 ... 1
+     * @param acceptance accepted / proposed moves in the epoch just ended
+     */
+    virtual double next(double temperature, double progress, double acceptance) = 0;
+};
+
+/**
+ * T = T0 endRatio^progress: geometric over the budget, from the initial
+ * temperature T0 to endRatio T0 at its end whatever the number of epochs
+ */
+class GeometricCooling : public CoolingSchedule
+{
+public:
+
+    explicit GeometricCooling(double endRatio = 0.001) : mEndRatio(endRatio), mStart(1) {}
+
+    CoolingSchedule* clone() const {
+        return new GeometricCooling(mEndRatio);
+    }
+
+    std::string getName() const {
+        std::ostringstream name;
+        name << "geometric -> " << mEndRatio << " T0";
+        return name.str();
+    }
+
+    void start(double temperature) {
+        mStart = temperature;
+    }
+
+    double next(double, double progress, double) {
+        return mStart * std::pow(mEndRatio, progress);
+    }
+
+private:
+
+    double mEndRatio;
+    double mStart;
+};
+
+/**
+ * Follows a target acceptance rate that decreases geometrically from `start` to
+ * `end` over the time budget: the temperature is scaled up when fewer moves than
+ * the target were accepted in the last epoch, down otherwise.
+ */
+class AdaptiveCooling : public CoolingSchedule
+{
+public:
+
+    AdaptiveCooling(double start = 0.5, double end = 0.001) : mStart(start), mEnd(end) {}
+
+    CoolingSchedule* clone() const {
+        return new AdaptiveCooling(mStart, mEnd);
+    }
+
+    std::string getName() const {
+        std::ostringstream name;
+        name << "adaptive " << mStart << " -> " << mEnd;
+        return name.str();
+    }
+
+    double next(double temperature, double progress, double acceptance) {
+        double target = mStart * std::pow(mEnd / mStart, progress);
+
+        // multiplicative correction, damped and bounded so that one noisy epoch cannot swing it
+        double ratio = (acceptance > 0) ? target / acceptance : 2.0;
+        if (ratio > 2.0) {
+            ratio = 2.0;
+        } else if (ratio < 0.5) {
+            ratio = 0.5;
+        }
+        return temperature * std::pow(ratio, 0.25);
+    }
+
+private:
+
+    double mStart;
+    double mEnd;
+};
+
+#endif /* COOLINGSCHEDULE_H */
@@ -0,0 +1,22 @@
+/**
+ * @file CpuTime.h
+ * @brief CPU time of the calling thread
+ *
+ */
+
+#ifndef CPUTIME_H
+#define CPUTIME_H
+
+#include <time.h>
+
+/**
+ * CPU seconds used by the calling thread. Unlike clock(), which counts the whole
+ * process, it measures a single run when several runs execute at the same time.
+ */
+inline double threadCpuTime() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#endif /* CPUTIME_H */
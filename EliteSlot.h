@@ -0,0 +1,115 @@
+/**
+ * @file EliteSlot.h
+ * @brief Best tour shared by concurrent searches, lock-free
+ *
+ */
+
+#ifndef ELITESLOT_H
+#define ELITESLOT_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "TSPSolution.h"
+
+/**
+ * A single tour and its value, written and read by several threads without a lock.
+ *
+ * The slot is a seqlock: the version is odd while a writer copies a tour in, and
+ * a reader retries when the version changed during its copy. Writers take the
+ * slot with a compare-and-swap on the version, readers never block a writer.
+ * value() is a single atomic load, so a search can check the slot every few
+ * iterations at no cost and copy the tour only when it is worth it.
+ */
+class EliteSlot
+{
+public:
+
+    /**
+     * @param size length of the tours (sequence.size(), node 0 at both ends)
+     * @param empty value of the empty slot, e.g. tsp.infinite
+     */
+    EliteSlot(int size, double empty)
+        : mSize(size), mVersion(0), mValue(empty), mSequence(new std::atomic<int>[size]) {
+        for (int i = 0; i < size; i++) {
+            mSequence[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /** value of the stored tour */
+    inline double value() const {
+        return mValue.load(std::memory_order_acquire);
+    }
+
+    /** changes every time a tour is stored */
+    inline unsigned version() const {
+        return mVersion.load(std::memory_order_acquire) / 2;
+    }
+
+    /**
+     * store the tour if it is better than the stored one
+     * @return true if stored
+     */
+    bool offer(const TSPSolution& sol, double value) {
+        unsigned version = mVersion.load(std::memory_order_relaxed);
+        for (;;) {
+            if (value >= mValue.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            if ((version & 1) == 0 &&
+                mVersion.compare_exchange_weak(version, version + 1, std::memory_order_acquire)) {
+                break;
+            }
+            version = mVersion.load(std::memory_order_relaxed);
+        }
+        // the odd version before any store of the copy (pairs with the fence of read())
+        std::atomic_thread_fence(std::memory_order_release);
+
+        // another writer may have stored a better tour meanwhile
+        bool better = value < mValue.load(std::memory_order_relaxed);
+        if (better) {
+            for (int i = 0; i < mSize; i++) {
+                mSequence[i].store(sol.sequence[i], std::memory_order_relaxed);
+            }
+            mValue.store(value, std::memory_order_relaxed);
+        }
+        mVersion.store(version + (better ? 2 : 0), std::memory_order_release);
+        return better;
+    }
+
+    /**
+     * copy the stored tour into sol (sequence only: call evaluate() before using it)
+     * @return its value
+     */
+    double read(TSPSolution& sol) const {
+        for (;;) {
+            unsigned before = mVersion.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;   // a writer is copying
+            }
+            for (int i = 0; i < mSize; i++) {
+                sol.sequence[i] = mSequence[i].load(std::memory_order_relaxed);
+            }
+            double value = mValue.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (mVersion.load(std::memory_order_relaxed) == before) {
+                return value;
+            }
+        }
+    }
+
+private:
+
+    EliteSlot(const EliteSlot&);
+    EliteSlot& operator=(const EliteSlot&);
+
+    const int mSize;
+
+    std::atomic<unsigned> mVersion;     // 2 * stores, odd while a writer copies
+    std::atomic<double> mValue;
+    std::unique_ptr< std::atomic<int>[] > mSequence;
+};
+
+#endif /* ELITESLOT_H */
@@ -0,0 +1,60 @@
+/**
+ * @file FastRandom.h
+ * @brief Small, fast pseudo-random generator (xorshift128+)
+ *
+ */
+
+#ifndef FASTRANDOM_H
+#define FASTRANDOM_H
+
+#include <stdint.h>
+
+/**
+ * xorshift128+ generator: a few shifts and xors per number and 16 bytes of
+ * state, so every solver (hence every thread) owns one instead of sharing
+ * rand(). Not suitable for anything but search decisions.
+ */
+class FastRandom
+{
+public:
+
+    explicit FastRandom(uint64_t seed = 1) {
+        this->seed(seed);
+    }
+
+    /** restart the sequence (the seed is spread with splitmix64, any value is fine) */
+    void seed(uint64_t seed) {
+        for (int k = 0; k < 2; k++) {
+            seed += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            mState[k] = z ^ (z >> 31);
+        }
+    }
+
+    inline uint64_t next() {
+        uint64_t s1 = mState[0];
+        const uint64_t s0 = mState[1];
+        mState[0] = s0;
+        s1 ^= s1 << 23;
+        mState[1] = s1 ^ s0 ^ (s1 >> 18) ^ (s0 >> 5);
+        return mState[1] + s0;
+    }
+
+    /** uniform in 0 ... n-1 (multiply-shift, no division) */
+    inline uint32_t below(uint32_t n) {
+        return (uint32_t)(((next() >> 32) * n) >> 32);
+    }
+
+    /** uniform in [0, 1) */
+    inline double uniform() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+
+    uint64_t mState[2];
+};
+
+#endif /* FASTRANDOM_H */
@@ -0,0 +1,326 @@
+/**
+ * @file HeldKarpBound.cpp
+ * @brief Held-Karp lower bound (1-trees and subgradient optimization)
+ */
+
+#include "HeldKarpBound.h"
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <functional>
+#include <utility>
+
+#include "CandidateLists.h"
+#include "TSPSolution.h"
+#include "TourConstruction.h"
+
+using namespace std;
+
+static const double INF = numeric_limits<double>::infinity();
+
+
+HeldKarpBound::HeldKarpBound(Graph graph, int maxIterations)
+    : mGraph(graph), mMaxIterations(maxIterations), mValue(0), mIterations(0), mOptimal(false), mRows(2) {}
+
+double HeldKarpBound::compute(const TSP& tsp, double upperBound) {
+    const int n = tsp.n;
+
+    mIterations = 0;
+    mOptimal = false;
+    mPi.assign(n, 0.0);
+    mBestPi = mPi;
+    mDirection.assign(n, 0.0);
+
+    if (n < 3) {
+        // a single tour
+        TSPSolution sol(tsp);
+        mOptimal = true;
+        return mValue = sol.value();
+    }
+
+    if (upperBound >= tsp.infinite) {
+        TSPSolution sol(tsp);
+        TourConstruction::build(tsp, TourConstruction::NEAREST_NEIGHBOR, sol);
+        upperBound = sol.value();
+    }
+
+    Graph graph = mGraph;
+    if (graph == AUTO) {
+        graph = (n >= AUTO_CANDIDATES_NODES) ? CANDIDATES : DENSE;
+    }
+    const CandidateLists* cand = tsp.candidates();
+    unique_ptr<CandidateLists> own;
+    if (graph == CANDIDATES && cand == NULL) {
+        own.reset(new CandidateLists(tsp, CandidateLists::DEFAULT_K));
+        cand = own.get();
+    }
+
+    const int maxIterations = (mMaxIterations > 0) ? mMaxIterations : (graph == DENSE ? 1000 : 300);
+    const int period = max(10, maxIterations / 20);
+
+    double best = -INF;         // best bound of the ascent, the sparse ones may be too high
+    double bestDense = -INF;    // best valid bound
+    double lambda = 2.0;
+    int sinceImprovement = 0;
+    bool refresh = true;        // next tree on the whole matrix
+
+    mEdges.clear();
+
+    for (mIterations = 0; mIterations < maxIterations; ) {
+        bool dense = (graph == DENSE || refresh);
+        double tree = dense ? INF : sparseTree(tsp);
+        if (tree == INF) {
+            tree = denseTree(tsp);
+            dense = true;
+        }
+        if (graph == CANDIDATES && refresh) {
+            // the graph grows with the edges of the dense trees: the sparse trees
+            // follow the penalties, and it stays connected
+            addGraphEdges(tsp, mIterations == 0 ? cand : NULL);
+            refresh = false;
+        }
+        mIterations++;
+
+        double sumPi = 0;
+        double norm = 0;
+        for (int i = 0; i < n; i++) {
+            sumPi += mPi[i];
+            norm += (double)(mDegree[i] - 2) * (mDegree[i] - 2);
+        }
+        double bound = tree - 2 * sumPi;
+
+        if (dense && bound > bestDense) {
+            bestDense = bound;
+            mDensePi = mPi;
+        }
+        if (bound > best) {
+            best = bound;
+            mBestPi = mPi;
+            sinceImprovement = 0;
+        } else if (++sinceImprovement >= period) {
+            lambda /= 2;
+            sinceImprovement = 0;
+            refresh = true;
+        }
+
+        // a dense 1-tree that is a tour, or a bound reaching the tour: nothing to gain
+        if (dense && ((norm == 0 && tsp.isSymmetric()) || bound >= upperBound - 1e-9 * fabs(upperBound))) {
+            mOptimal = true;
+            mBestPi = mPi;
+            best = bound;
+            break;
+        }
+        if (norm == 0 || lambda < 1e-4) {
+            break;
+        }
+
+        // the candidate tree may weigh more than the tour: keep a minimum step
+        double distance = max(upperBound - bound, 1e-6 * max(1.0, fabs(upperBound)));
+        double step = lambda * distance / norm;
+        for (int i = 0; i < n; i++) {
+            mDirection[i] = 0.7 * (mDegree[i] - 2) + 0.3 * mDirection[i];
+            mPi[i] += step * mDirection[i];
+        }
+    }
+
+    if (graph == CANDIDATES && !mOptimal) {
+        // the ascent bound is not valid: evaluate its penalties on the whole matrix
+        mPi = mBestPi;
+        double sumPi = 0;
+        for (int i = 0; i < n; i++) {
+            sumPi += mPi[i];
+        }
+        best = denseTree(tsp) - 2 * sumPi;
+
+        mOptimal = tsp.isSymmetric();
+        for (int i = 0; i < n && mOptimal; i++) {
+            mOptimal = (mDegree[i] == 2);
+        }
+        if (best < bestDense) {
+            best = bestDense;
+            mBestPi = mDensePi;
+            mOptimal = false;
+        }
+    }
+
+    return mValue = best;
+}
+
+double HeldKarpBound::denseTree(const TSP& tsp) {
+    const int n = tsp.n;
+    const bool symmetric = tsp.isSymmetric();
+    const double* pi = &mPi[0];
+
+    mKey.assign(n, INF);
+    mParent.assign(n, -1);
+    mInTree.assign(n, 0);
+    mDegree.assign(n, 0);
+
+    double total = 0;
+
+    // Prim on 1 ... n-1: relax the edges of the last node added, pick the nearest node in the same pass
+    int u = 1;
+    mInTree[u] = 1;
+    for (int added = 1; added < n - 1; added++) {
+        const double* row = mRows.row(tsp, u);
+        const double pu = pi[u];
+
+        int next = -1;
+        double nextKey = INF;
+        for (int v = 1; v < n; v++) {
+            if (mInTree[v]) {
+                continue;
+            }
+            double c = symmetric ? row[v] : min(row[v], tsp.cost(v, u));
+            double w = c + pu + pi[v];
+            if (w < mKey[v]) {
+                mKey[v] = w;
+                mParent[v] = u;
+            }
+            if (mKey[v] < nextKey) {
+                nextKey = mKey[v];
+                next = v;
+            }
+        }
+
+        mInTree[next] = 1;
+        total += nextKey;
+        mDegree[next]++;
+        mDegree[mParent[next]]++;
+        u = next;
+    }
+
+    // the two cheapest edges of node 0
+    const double* row = mRows.row(tsp, 0);
+    int first = -1, second = -1;
+    double firstCost = INF, secondCost = INF;
+    for (int v = 1; v < n; v++) {
+        double c = symmetric ? row[v] : min(row[v], tsp.cost(v, 0));
+        double w = c + pi[0] + pi[v];
+        if (w < firstCost) {
+            second = first;
+            secondCost = firstCost;
+            first = v;
+            firstCost = w;
+        } else if (w < secondCost) {
+            second = v;
+            secondCost = w;
+        }
+    }
+    total += firstCost + secondCost;
+    mDegree[0] = 2;
+    mDegree[first]++;
+    mDegree[second]++;
+
+    return total;
+}
+
+double HeldKarpBound::sparseTree(const TSP& tsp) {
+    const int n = tsp.n;
+    const double* pi = &mPi[0];
+    greater< pair<double, int> > heapOrder;     // min-heap
+
+    mKey.assign(n, INF);
+    mParent.assign(n, -1);
+    mInTree.assign(n, 0);
+    mDegree.assign(n, 0);
+    mHeap.clear();
+
+    double total = 0;
+    int added = 0;
+
+    // Prim on 1 ... n-1 with a lazy heap: outdated entries are skipped when popped
+    mKey[1] = 0;
+    mHeap.push_back(make_pair(0.0, 1));
+    while (!mHeap.empty()) {
+        pop_heap(mHeap.begin(), mHeap.end(), heapOrder);
+        int u = mHeap.back().second;
+        mHeap.pop_back();
+        if (mInTree[u]) {
+            continue;
+        }
+
+        mInTree[u] = 1;
+        added++;
+        if (mParent[u] >= 0) {
+            total += mKey[u];
+            mDegree[u]++;
+            mDegree[mParent[u]]++;
+        }
+
+        for (int a = mOffset[u]; a < mOffset[u + 1]; a++) {
+            int v = mAdjacent[a];
+            if (v == 0 || mInTree[v]) {
+                continue;
+            }
+            double w = edgeCost(tsp, u, v) + pi[u] + pi[v];
+            if (w < mKey[v]) {
+                mKey[v] = w;
+                mParent[v] = u;
+                mHeap.push_back(make_pair(w, v));
+                push_heap(mHeap.begin(), mHeap.end(), heapOrder);
+            }
+        }
+    }
+
+    if (added < n - 1 || mOffset[1] - mOffset[0] < 2) {
+        return INF;
+    }
+
+    // the two cheapest candidate edges of node 0
+    int first = -1, second = -1;
+    double firstCost = INF, secondCost = INF;
+    for (int a = mOffset[0]; a < mOffset[1]; a++) {
+        int v = mAdjacent[a];
+        double w = edgeCost(tsp, 0, v) + pi[0] + pi[v];
+        if (w < firstCost) {
+            second = first;
+            secondCost = firstCost;
+            first = v;
+            firstCost = w;
+        } else if (w < secondCost) {
+            second = v;
+            secondCost = w;
+        }
+    }
+    total += firstCost + secondCost;
+    mDegree[0] = 2;
+    mDegree[first]++;
+    mDegree[second]++;
+
+    return total;
+}
+
+void HeldKarpBound::addGraphEdges(const TSP& tsp, const CandidateLists* cand) {
+    const int n = tsp.n;
+
+    // both directions of every edge, without duplicates
+    if (cand != NULL) {
+        mEdges.reserve((size_t)2 * n * (cand->k() + 1));
+        for (int i = 0; i < n; i++) {
+            for (const int* it = cand->begin(i); it != cand->end(i); ++it) {
+                mEdges.push_back(make_pair(i, *it));
+                mEdges.push_back(make_pair(*it, i));
+            }
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        if (mParent[i] >= 0) {
+            mEdges.push_back(make_pair(i, mParent[i]));
+            mEdges.push_back(make_pair(mParent[i], i));
+        }
+    }
+    sort(mEdges.begin(), mEdges.end());
+    mEdges.erase(unique(mEdges.begin(), mEdges.end()), mEdges.end());
+
+    mOffset.assign(n + 1, 0);
+    mAdjacent.resize(mEdges.size());
+    for (size_t e = 0; e < mEdges.size(); e++) {
+        mOffset[mEdges[e].first + 1]++;
+        mAdjacent[e] = mEdges[e].second;
+    }
+    for (int i = 0; i < n; i++) {
+        mOffset[i + 1] += mOffset[i];
+    }
+}
@@ -0,0 +1,139 @@
+/**
+ * @file HeldKarpBound.h
+ * @brief Held-Karp lower bound (1-trees and subgradient optimization)
+ *
+ */
+
+#ifndef HELDKARPBOUND_H
+#define HELDKARPBOUND_H
+
+#include <vector>
+#include <algorithm>
+
+#include "TSP.h"
+#include "RowCache.h"
+
+class CandidateLists;
+
+/**
+ * Lower bound on the value of any tour, to tell how far a solution can still be
+ * from the optimum.
+ *
+ * A 1-tree is a minimum spanning tree of the nodes 1 ... n-1 plus the two cheapest
+ * edges of node 0; every tour is a 1-tree, so its cost is a lower bound. With node
+ * penalties pi the edge (i, j) costs c(i, j) + pi[i] + pi[j], every tour cost grows
+ * by exactly 2 sum(pi) and L(pi) = 1-tree - 2 sum(pi) is still a bound. Subgradient
+ * optimization raises it: pi[i] += t v[i] with v = 0.7 (degree - 2) + 0.3 v (the
+ * previous direction damps the zigzag), the step t = lambda (upperBound - L) /
+ * |degree - 2|^2 and lambda halved whenever the bound has not improved for a
+ * period. On a symmetric instance a 1-tree where every degree is 2 is an optimal tour.
+ *
+ *  DENSE       Prim on the whole cost matrix, O(n^2) per iteration
+ *  CANDIDATES  the ascent works on the candidate graph (symmetrized), Prim with a
+ *              heap in O(n k log n). The graph is incremental: the first iteration
+ *              and the one after every halving of lambda build a dense 1-tree and
+ *              add its edges, so the graph stays connected and follows the
+ *              penalties. A sparse tree can only be heavier than the dense one,
+ *              so the bound returned is a dense 1-tree with the best penalties
+ *  AUTO        CANDIDATES from AUTO_CANDIDATES_NODES nodes on, DENSE below
+ *
+ * Asymmetric instances are bounded with min(c(i, j), c(j, i)) for edge (i, j).
+ */
+class HeldKarpBound
+{
+public:
+
+    enum Graph {
+        DENSE,
+        CANDIDATES,
+        AUTO
+    };
+
+    static const int AUTO_CANDIDATES_NODES = 5000;
+
+    /**
+     * @param graph graph of the 1-trees of the ascent
+     * @param maxIterations subgradient iterations, 0 = 1000 on DENSE, 300 on CANDIDATES
+     */
+    HeldKarpBound(Graph graph = AUTO, int maxIterations = 0);
+
+    /**
+     * run the subgradient optimization
+     * @param upperBound value of a known tour (steps are proportional to upperBound - L),
+     *        tsp.infinite or more: a nearest neighbour tour is built first
+     * @return the bound, also value()
+     */
+    double compute(const TSP& tsp, double upperBound);
+
+    inline double value() const {
+        return mValue;
+    }
+
+    inline int iterations() const {
+        return mIterations;
+    }
+
+    /** the best 1-tree is a tour: value() is the optimum */
+    inline bool optimal() const {
+        return mOptimal;
+    }
+
+    /** penalties of the bound */
+    inline const std::vector<double>& penalties() const {
+        return mBestPi;
+    }
+
+    /** (value - bound) / bound, the relative distance of a tour from the bound */
+    static double gap(double value, double bound) {
+        return (value - bound) / bound;
+    }
+
+private:
+
+    /**
+     * 1-tree with the penalties mPi on the whole matrix, sets mDegree
+     * @return its cost with the penalties
+     */
+    double denseTree(const TSP& tsp);
+
+    /**
+     * 1-tree with the penalties mPi on the candidate graph, sets mDegree
+     * @return its cost with the penalties, or +infinity if the graph does not span the nodes
+     */
+    double sparseTree(const TSP& tsp);
+
+    /** c(i, j), symmetrized on asymmetric instances */
+    inline double edgeCost(const TSP& tsp, int i, int j) const {
+        return tsp.isSymmetric() ? tsp.cost(i, j) : std::min(tsp.cost(i, j), tsp.cost(j, i));
+    }
+
+    /** add the candidate edges (if cand) and the edges of the last dense tree (mParent) to the graph */
+    void addGraphEdges(const TSP& tsp, const CandidateLists* cand);
+
+    Graph mGraph;
+    int mMaxIterations;
+
+    double mValue;
+    int mIterations;
+    bool mOptimal;
+
+    std::vector<double> mPi;
+    std::vector<double> mBestPi;
+    std::vector<double> mDirection;
+    std::vector<double> mDensePi;       // penalties of the best dense tree
+    std::vector<int> mDegree;
+
+    // Prim
+    RowCache mRows;
+    std::vector<double> mKey;
+    std::vector<int> mParent;
+    std::vector<char> mInTree;
+    std::vector< std::pair<double, int> > mHeap;
+
+    // symmetrized candidate graph, CSR layout
+    std::vector< std::pair<int, int> > mEdges;
+    std::vector<int> mOffset;
+    std::vector<int> mAdjacent;
+};
+
+#endif /* HELDKARPBOUND_H */
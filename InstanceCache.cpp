@@ -0,0 +1,204 @@
+/**
+ * @file InstanceCache.cpp
+ * @brief Loaded TSP instances kept in memory, keyed by content hash, least recently used evicted
+ */
+
+#include "InstanceCache.h"
+
+#include <fstream>
+#include <vector>
+#include <stdexcept>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include "CandidateLists.h"
+#include "Logger.h"
+
+using namespace std;
+
+InstanceCache::InstanceCache(size_t capacity)
+    : mCapacity(capacity), mBytes(0), mHits(0), mMisses(0), mEvictions(0) {}
+
+string InstanceCache::hashFile(const string& filename) {
+    ifstream in(filename.c_str(), ios::in | ios::binary);
+    if (!in) {
+        throw runtime_error("cannot open " + filename);
+    }
+
+    uint64_t hash = 14695981039346656037ULL;
+    vector<char> buffer(1 << 16);
+    while (in) {
+        in.read(&buffer[0], buffer.size());
+        streamsize count = in.gcount();
+        for (streamsize i = 0; i < count; i++) {
+            hash = (hash ^ (unsigned char)buffer[i]) * 1099511628211ULL;
+        }
+    }
+    if (in.bad()) {
+        throw runtime_error("cannot read " + filename);
+    }
+
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)hash);
+    return hex;
+}
+
+string InstanceCache::entryKey(const string& hash, int candidates, bool quadrant) {
+    if (candidates <= 0) {
+        return hash;
+    }
+    return hash + "/k" + to_string(candidates) + (quadrant ? "q" : "");
+}
+
+size_t InstanceCache::bytesOf(const TSP& tsp) {
+    size_t bytes = tsp.hasMatrix() ? (size_t)tsp.n * tsp.stride() * sizeof(double)
+                                   : (size_t)tsp.n * 2 * sizeof(double);
+    if (tsp.candidates() != NULL) {
+        bytes += (size_t)tsp.n * tsp.candidates()->k() * sizeof(int);
+    }
+    return bytes;
+}
+
+string InstanceCache::contentHash(const string& filename) {
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0) {
+        throw runtime_error("cannot open " + filename);
+    }
+    long long modified = (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+
+    {
+        lock_guard<mutex> lock(mMutex);
+        map<string, FileHash>::const_iterator known = mFileHashes.find(filename);
+        if (known != mFileHashes.end() && known->second.size == (long long)info.st_size
+            && known->second.modified == modified) {
+            return known->second.hash;
+        }
+    }
+
+    FileHash fileHash;
+    fileHash.size = info.st_size;
+    fileHash.modified = modified;
+    fileHash.hash = hashFile(filename);
+
+    lock_guard<mutex> lock(mMutex);
+    mFileHashes[filename] = fileHash;
+    return fileHash.hash;
+}
+
+shared_ptr<const TSP> InstanceCache::lookup(const string& key) {
+    map<string, Entries::iterator>::iterator found = mIndex.find(key);
+    if (found == mIndex.end()) {
+        return shared_ptr<const TSP>();
+    }
+    mEntries.splice(mEntries.begin(), mEntries, found->second);
+    return found->second->tsp;
+}
+
+shared_ptr<const TSP> InstanceCache::insert(const string& key, const shared_ptr<const TSP>& tsp) {
+    // loaded by another run at the same time: keep the first one
+    shared_ptr<const TSP> cached = lookup(key);
+    if (cached) {
+        return cached;
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.tsp = tsp;
+    entry.bytes = bytesOf(*tsp);
+    mEntries.push_front(entry);
+    mIndex[key] = mEntries.begin();
+    mBytes += entry.bytes;
+
+    // the new entry stays, even alone above the capacity
+    while (mBytes > mCapacity && mEntries.size() > 1) {
+        const Entry& last = mEntries.back();
+        LOG_DEBUG << "instance cache: evict " << last.key << " (" << last.bytes << " bytes)";
+        mBytes -= last.bytes;
+        mIndex.erase(last.key);
+        mEntries.pop_back();
+        mEvictions++;
+    }
+
+    return tsp;
+}
+
+shared_ptr<const TSP> InstanceCache::withCandidates(const string& hash, const shared_ptr<const TSP>& plain,
+                                                    int candidates, bool quadrant, bool& hit) {
+    if (candidates <= 0) {
+        return plain;
+    }
+
+    const string key = entryKey(hash, candidates, quadrant);
+    {
+        lock_guard<mutex> lock(mMutex);
+        shared_ptr<const TSP> cached = lookup(key);
+        if (cached) {
+            return cached;
+        }
+    }
+
+    // a copy: the runs using the plain instance read it meanwhile
+    hit = false;
+    shared_ptr<TSP> tsp(new TSP(*plain));
+    tsp->buildCandidateLists(candidates, quadrant);
+
+    lock_guard<mutex> lock(mMutex);
+    return insert(key, tsp);
+}
+
+shared_ptr<const TSP> InstanceCache::get(const string& filename, int candidates, bool quadrant,
+                                         string& key, bool& hit) {
+    key = contentHash(filename);
+    hit = true;
+
+    shared_ptr<const TSP> plain;
+    {
+        lock_guard<mutex> lock(mMutex);
+        plain = lookup(key);
+        if (plain) {
+            mHits++;
+        } else {
+            mMisses++;
+        }
+    }
+
+    if (!plain) {
+        hit = false;
+        shared_ptr<TSP> tsp(new TSP());
+        tsp->readFromFile(filename.c_str());
+
+        lock_guard<mutex> lock(mMutex);
+        plain = insert(key, tsp);
+    }
+
+    return withCandidates(key, plain, candidates, quadrant, hit);
+}
+
+shared_ptr<const TSP> InstanceCache::find(const string& key, int candidates, bool quadrant, bool& hit) {
+    hit = true;
+
+    shared_ptr<const TSP> plain;
+    {
+        lock_guard<mutex> lock(mMutex);
+        plain = lookup(key);
+        if (plain) {
+            mHits++;
+        } else {
+            mMisses++;
+            return plain;
+        }
+    }
+
+    return withCandidates(key, plain, candidates, quadrant, hit);
+}
+
+InstanceCache::Stats InstanceCache::stats() const {
+    lock_guard<mutex> lock(mMutex);
+    Stats stats;
+    stats.entries = mEntries.size();
+    stats.bytes = mBytes;
+    stats.hits = mHits;
+    stats.misses = mMisses;
+    stats.evictions = mEvictions;
+    return stats;
+}
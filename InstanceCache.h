@@ -0,0 +1,117 @@
+/**
+ * @file InstanceCache.h
+ * @brief Loaded TSP instances kept in memory, keyed by content hash, least recently used evicted
+ *
+ */
+
+#ifndef INSTANCECACHE_H
+#define INSTANCECACHE_H
+
+#include <string>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+
+#include "TSP.h"
+
+/**
+ * Instances of a long-lived process (see SolverDaemon), loaded once and shared
+ * read-only by the runs.
+ *
+ * An instance is identified by the hash of its file content, so that the same
+ * file under two names, or a file rewritten with the same content, is loaded
+ * once; the hash of a file is remembered with its size and modification time and
+ * computed again only when one of them changes. Candidate lists are part of the
+ * instance (TSP::buildCandidateLists), so each configuration (k, quadrant) is an
+ * entry of its own, copied from the plain instance rather than parsed again.
+ *
+ * When the entries exceed the capacity (bytes of matrices, coordinates and
+ * candidate lists) the least recently used ones are dropped; a run still using
+ * one keeps it alive until it ends. Every method may be called from any thread.
+ */
+class InstanceCache
+{
+public:
+
+    struct Stats {
+        size_t entries;
+        size_t bytes;
+        unsigned long hits;
+        unsigned long misses;
+        unsigned long evictions;
+    };
+
+    /** @param capacity bytes of the instances kept */
+    explicit InstanceCache(size_t capacity);
+
+    /**
+     * the instance of a file, loaded if it is not cached
+     * @param candidates candidate lists to build, 0 = none
+     * @param key (output) content hash of the file, see find()
+     * @param hit (output) true if the instance was cached
+     * @throw std::runtime_error if the file cannot be read or parsed
+     */
+    std::shared_ptr<const TSP> get(const std::string& filename, int candidates, bool quadrant,
+                                   std::string& key, bool& hit);
+
+    /**
+     * a cached instance by the key returned by get(), with its candidate lists
+     * built if needed
+     * @return NULL if the instance is not cached (never loaded, or evicted)
+     */
+    std::shared_ptr<const TSP> find(const std::string& key, int candidates, bool quadrant, bool& hit);
+
+    Stats stats() const;
+
+    /** 64-bit FNV-1a of a file content, 16 hexadecimal digits */
+    static std::string hashFile(const std::string& filename);
+
+private:
+
+    struct Entry {
+        std::string key;    // content hash, "/k<candidates>[q]" for a candidate configuration
+        std::shared_ptr<const TSP> tsp;
+        size_t bytes;
+    };
+
+    typedef std::list<Entry> Entries;   // most recently used first
+
+    // hash of a file while its size and modification time do not change
+    struct FileHash {
+        long long size;
+        long long modified;     // nanoseconds
+        std::string hash;
+    };
+
+    static std::string entryKey(const std::string& hash, int candidates, bool quadrant);
+
+    static size_t bytesOf(const TSP& tsp);
+
+    // the file hash, from mFileHashes if the file did not change
+    std::string contentHash(const std::string& filename);
+
+    // with mMutex held: the entry moved to the front, NULL if absent
+    std::shared_ptr<const TSP> lookup(const std::string& key);
+
+    // with mMutex held: insert (or keep the entry inserted meanwhile) and evict
+    std::shared_ptr<const TSP> insert(const std::string& key, const std::shared_ptr<const TSP>& tsp);
+
+    // the entry of (hash, candidates, quadrant), built from the plain instance
+    std::shared_ptr<const TSP> withCandidates(const std::string& hash, const std::shared_ptr<const TSP>& plain,
+                                              int candidates, bool quadrant, bool& hit);
+
+    size_t mCapacity;
+
+    mutable std::mutex mMutex;
+    Entries mEntries;
+    std::map<std::string, Entries::iterator> mIndex;
+    std::map<std::string, FileHash> mFileHashes;
+    size_t mBytes;
+    unsigned long mHits;
+    unsigned long mMisses;
+    unsigned long mEvictions;
+};
+
+#endif /* INSTANCECACHE_H */
@@ -0,0 +1,153 @@
+/**
+ * @file IslandTabuSearchSolver.cpp
+ * @brief TSP solver (parallel tabu search, island model)
+ */
+
+#include "IslandTabuSearchSolver.h"
+
+#include <sstream>
+#include <random>
+#include <thread>
+
+#include "CpuTime.h"
+#include "ThreadPool.h"
+#include "EliteSlot.h"
+#include "Logger.h"
+
+using namespace std;
+
+std::string IslandTabuSearchSolver::getSolverName() const {
+    ostringstream name;
+    name << "Island ";
+    if (mIslands > 0) {
+        name << mIslands;
+    } else {
+        name << "all";
+    }
+    name << " x " << mPrototype->getSolverName()
+         << ", migration: " << mMigrationInterval << ", restart: " << mRestartAfter;
+    return name.str();
+}
+
+void IslandTabuSearchSolver::perturb(const TSP& tsp, TSPSolution& sol, int island) const {
+    const int last = sol.sequence.size() - 1;
+    if (last < 4) {
+        return;
+    }
+
+    minstd_rand random(island);
+    TSPMove move;
+    move.type = TSPMove::TWO_OPT;
+
+    for (int k = max(1, last / 8); k > 0; k--) {
+        // 1 <= from < to < last
+        move.from = 1 + random() % (last - 2);
+        move.to = move.from + 1 + random() % (last - 1 - move.from);
+        sol.apply(tsp, move);
+    }
+}
+
+bool IslandTabuSearchSolver::solve(const TSP& tsp, const TSPSolution& initSol, TSPSolution& bestSol) {
+
+    const int islands = (mIslands > 0) ? mIslands : ThreadPool::defaultThreads();
+
+    vector<TabuSearchSolver*> solvers;
+    vector<TSPSolution*> starts;
+    vector<TSPSolution*> results;
+    vector<int> done(islands, 0);
+    vector<double> cpuTimes(islands, 0);
+    bool ok = true;
+    mWorkerCpuTime = 0;
+
+    // every island records its own trace, merged into the one of this search
+    ConvergenceTrace* trace = mStop.trace();
+    vector<ConvergenceTrace> traces(trace != NULL ? islands : 0);
+
+    mStop.start();
+
+    try {
+        EliteSlot elite(initSol.sequence.size(), tsp.infinite);
+
+        for (int k = 0; k < islands; k++) {
+            solvers.push_back(static_cast<TabuSearchSolver*>(mPrototype->clone()));
+            solvers.back()->joinIsland(&elite, mMigrationInterval, mRestartAfter);
+            solvers.back()->stopCriteria() = mStop;
+            solvers.back()->stopCriteria().setTrace(trace != NULL ? &traces[k] : NULL);
+
+            starts.push_back(new TSPSolution(initSol));
+            starts.back()->evaluate(tsp);
+            if (k > 0) {
+                perturb(tsp, *starts.back(), k);
+            }
+            results.push_back(new TSPSolution(initSol));
+        }
+
+        vector<thread> threads;
+        try {
+            for (int k = 0; k < islands; k++) {
+                threads.push_back(thread([&, k]() {
+                    double start = threadCpuTime();
+                    done[k] = solvers[k]->solve(tsp, *starts[k], *results[k]) ? 1 : 0;
+                    cpuTimes[k] = threadCpuTime() - start;
+                }));
+            }
+        }
+        catch (...) {
+            for (size_t k = 0; k < threads.size(); k++) {
+                threads[k].join();
+            }
+            throw;
+        }
+        for (size_t k = 0; k < threads.size(); k++) {
+            threads[k].join();
+            mWorkerCpuTime += cpuTimes[k];
+        }
+
+        int best = -1;
+        uint iterations = 0;
+        for (int k = 0; k < islands; k++) {
+            ok = ok && done[k];
+            iterations += results[k]->iterations;
+
+            double value = results[k]->value();
+            LOG_INFO << "island " << k << ": value " << value
+                     << "\titerations " << results[k]->iterations
+                     << "\tpublished " << solvers[k]->mPublished
+                     << "\trestarts " << solvers[k]->mRestarts
+                     << "\tstop: " << solvers[k]->stopCriteria().reasonName();
+
+            if (best < 0 || value < results[best]->value()) {
+                best = k;
+            }
+        }
+
+        if (trace != NULL) {
+            vector<const ConvergenceTrace*> merged;
+            for (int k = 0; k < islands; k++) {
+                merged.push_back(&traces[k]);
+            }
+            trace->mergeBest(merged);
+        }
+
+        bestSol = *results[best];
+        mStop.stopBy(solvers[best]->stopCriteria().reason());
+        bestSol.iterations = iterations;
+    }
+    catch (std::exception& e) {
+        LOG_ERROR << ">>>EXCEPTION: " << e.what();
+        ok = false;
+    }
+
+    // a throw during the setup leaves the vectors of different sizes
+    for (size_t k = 0; k < solvers.size(); k++) {
+        delete solvers[k];
+    }
+    for (size_t k = 0; k < starts.size(); k++) {
+        delete starts[k];
+    }
+    for (size_t k = 0; k < results.size(); k++) {
+        delete results[k];
+    }
+
+    return ok;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file IslandTabuSearchSolver.h
+ * @brief TSP solver (parallel tabu search, island model)
+ *
+ */
+
+#ifndef ISLANDTABUSEARCHSOLVER_H
+#define ISLANDTABUSEARCHSOLVER_H
+
+#include "solver.h"
+#include "TabuSearchSolver.h"
+
+/**
+ * Class that runs several tabu searches at the same time, one thread each.
+ *
+ * Every island is a clone of the prototype TabuSearchSolver with its own tabu
+ * memory; island 0 starts from the initial solution, the others from random
+ * 2-opt perturbations of it. They exchange tours through an EliteSlot: every
+ * migrationInterval iterations an island offers its best tour and, when its
+ * best has not improved for restartAfter migrations, restarts from the elite
+ * tour if that one is better.
+ */
+class IslandTabuSearchSolver : public Solver
+{
+public:
+
+    TabuSearchSolver* mPrototype;
+
+    int mIslands;
+    int mMigrationInterval;
+    int mRestartAfter;
+
+    /**
+     * @param islands number of islands (threads), 0 = hardware threads
+     * @param prototype configuration of every island (copied), its stop criteria
+     *        become those of this solver, which every island then uses
+     * @param migrationInterval iterations between two visits of the elite slot
+     * @param restartAfter migrations without improvement before restarting from the elite, 0 = never
+     */
+    IslandTabuSearchSolver(int islands, const TabuSearchSolver& prototype, int migrationInterval = 100, int restartAfter = 2)
+        : mPrototype(static_cast<TabuSearchSolver*>(prototype.clone())), mIslands(islands),
+          mMigrationInterval(migrationInterval), mRestartAfter(restartAfter), mWorkerCpuTime(0) {
+        mStop = prototype.stopCriteria();
+    }
+
+    ~IslandTabuSearchSolver() {
+        delete mPrototype;
+    }
+
+    Solver* clone() const {
+        IslandTabuSearchSolver* solver = new IslandTabuSearchSolver(mIslands, *mPrototype, mMigrationInterval, mRestartAfter);
+        solver->mStop = mStop;
+        return solver;
+    }
+
+    std::string getSolverName() const;
+
+    /**
+     * search for a good tour with the islands in parallel
+     * @param TSP TSP data
+     * @param initSol initial solution
+     * @param bestSol best tour of all islands (output), iterations summed over the islands
+     * @return true id everything OK, false otherwise
+     */
+    bool solve(const TSP& tsp, const TSPSolution& initSol, TSPSolution& bestSol);
+
+    /** CPU seconds of the island threads, summed */
+    double workerCpuTime() const {
+        return mWorkerCpuTime;
+    }
+
+private:
+
+    double mWorkerCpuTime;
+
+    IslandTabuSearchSolver(const IslandTabuSearchSolver&);
+    IslandTabuSearchSolver& operator=(const IslandTabuSearchSolver&);
+
+    /**
+     * random 2-opt moves applied to sol, different for every island
+     */
+    void perturb(const TSP& tsp, TSPSolution& sol, int island) const;
+};
+
+#endif /* ISLANDTABUSEARCHSOLVER_H */
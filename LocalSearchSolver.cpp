@@ -4,14 +4,31 @@
  */
 
 #include "LocalSearchSolver.h"
-#include <iostream>
+
+#include <memory>
+
+#include "ArrayTour.h"
+#include "TwoLevelListTour.h"
+#include "AllocationCounter.h"
+#include "SolverMetrics.h"
+#include "Logger.h"
 
 std::string LocalSearchSolver::getSolverName() const {
+    if (mDontLookBits) {
+        return string("Local Search Don't-Look Bits ") + (mBestImprovement ? "BI" : "FI")
+               + (mCandidateScan ? " (candidates)" : "");
+    }
     return string("Local Search ") + findNeighbor->getName();
 }
 
 bool LocalSearchSolver::solve( const TSP& tsp , const TSPSolution& initSol , TSPSolution& bestSol ) {
 
+    mStop.start();
+
+    if (mDontLookBits) {
+        return solveDontLookBits(tsp, initSol, bestSol);
+    }
+
     try {
         bool stop = false;
         int  iter = 0;
@@ -19,15 +36,18 @@ bool LocalSearchSolver::solve( const TSP& tsp , const TSPSolution& initSol , TSP
         TSPSolution currSol(initSol);
         double bestValue, currValue;
 
-        bestValue = currValue = currSol.evaluateObjectiveFunction(tsp);
+        bestValue = currValue = currSol.evaluate(tsp);
         TSPMove move;
 
+        // the first iteration sizes the buffers, the next ones should not allocate
+        unsigned long allocations = 0;
+
         while (!stop) {
             if ( tsp.n < 20 ) {
-                currSol.print(std::cout); //log current solution (only small instances)
+                LOG_TRACE << currSol; //log current solution (only small instances)
             }
 
-            std::cout << " (" << ++iter << ") value " << currValue << " (" << bestValue << ")";
+            ++iter;
 
             // first improvement
             // neigh = findFirstBestNeighbor(tsp, currSol, )
@@ -38,43 +58,193 @@ bool LocalSearchSolver::solve( const TSP& tsp , const TSPSolution& initSol , TSP
             // incremental evaluation: findBestNeighbour returns the cost increment
             double bestNeighValue = currValue + findNeighbor->execute(tsp, currSol, move);
 
-            std::cout << "\t move: " << move.from << " , " << move.to << std::endl;
+            LOG_DEBUG << " (" << iter << ") value " << currValue << " (" << bestValue << ")"
+                      << "\t move: " << move.from << " , " << move.to;
 
             // stop criteria
             if (bestNeighValue < currValue) {
                 bestValue = currValue = bestNeighValue;
-                currSol = swap(currSol,move);
+                {
+                    SolverMetrics::Timer timer(SolverMetrics::APPLY_NS);
+                    currSol.apply(tsp, move);
+                }
+                SolverMetrics::add(SolverMetrics::MOVES_APPLIED);
+                SolverMetrics::add(SolverMetrics::IMPROVEMENTS);
+                stop = mStop.stop(iter, currValue);
             }
             else {
                 stop = true;    // exit from cycle
             }
+
+            if (iter == 1) {
+                allocations = AllocationCounter::count();
+            }
+        }
+
+        if (AllocationCounter::enabled()) {
+            LOG_INFO << "heap allocations after the first iteration: " << AllocationCounter::count() - allocations;
         }
 
         bestSol = currSol;
         bestSol.iterations = iter;
     }
     catch (std::exception& e) {
-        std::cout << ">>>EXCEPTION: " << e.what() << std::endl;
+        LOG_ERROR << ">>>EXCEPTION: " << e.what();
         return false;
     }
 
     return true;
 }
 
-TSPSolution& LocalSearchSolver::swap( TSPSolution& tspSol , const TSPMove& move ) {
+bool LocalSearchSolver::solveDontLookBits( const TSP& tsp , const TSPSolution& initSol , TSPSolution& bestSol ) {
+
+    try {
+        const CandidateLists* cand = mCandidateScan ? &requireCandidates(tsp) : NULL;
+
+        TSPSolution currSol(initSol);
+        double currValue = currSol.evaluate(tsp);
+        int iter;
+
+        std::unique_ptr<Tour> tour(Tour::create(mTourType, tsp.n));
+        tour->load(currSol.sequence);
+
+        // one dispatch, the descent works on the concrete type
+        if (ArrayTour* array = dynamic_cast<ArrayTour*>(tour.get())) {
+            iter = descend(tsp, cand, *array, currValue);
+        } else {
+            iter = descend(tsp, cand, *static_cast<TwoLevelListTour*>(tour.get()), currValue);
+        }
+
+        tour->toSequence(currSol.sequence);
+        currSol.evaluate(tsp);
 
-    TSPSolution tmpSol(tspSol);
+        LOG_INFO << " (" << iter << ") value " << currValue;
 
-    for (int i = move.from ; i <= move.to ; ++i) {
-        tspSol.sequence[i] = tmpSol.sequence[move.to-(i-move.from)];
+        bestSol = currSol;
+        bestSol.iterations = iter;
+    }
+    catch (std::exception& e) {
+        LOG_ERROR << ">>>EXCEPTION: " << e.what();
+        return false;
     }
 
-    return tspSol;
+    return true;
 }
 
+template <class TourT>
+int LocalSearchSolver::descend( const TSP& tsp , const CandidateLists* cand , TourT& tour , double& value ) {
+    const int n = tsp.n;
+    int iter = 0;
+
+    // every city starts active, queued in tour order
+    mQueue.resize(n);
+    mActive.assign(n, true);
+    for (int p = 0, c = 0; p < n; p++, c = tour.next(c)) {
+        mQueue[p] = c;
+    }
+    int head = 0;
+    int queued = n;
 
+    vector<int> allCities;
+    if (cand == NULL) {
+        for (int c = 0; c < n; c++) {
+            allCities.push_back(c);
+        }
+    }
 
+    while (queued > 0) {
+        int c = mQueue[head];
+        head = (head + 1) % n;
+        queued--;
+        mActive[c] = false;
+
+        const int* begin = cand ? cand->begin(c) : &allCities[0];
+        const int* end = cand ? cand->end(c) : &allCities[0] + n;
+
+        const int succC = tour.next(c);
+        const int predC = tour.prev(c);
+
+        // candidates are sorted: a neighbour farther than both tour neighbours cannot help
+        double limit = max(tsp.cost(c, succC), tsp.cost(predC, c));
+
+        double bestCostVariation = 0;
+        int bestFlip[4];    // a, b = next(a), c, d = next(c)
+
+        {
+            SolverMetrics::Timer timer(SolverMetrics::NEIGHBORHOOD_NS);
+            uint64_t evaluated = 0;
+            for (const int* it = begin; it != end; ++it) {
+                int d = *it;
+                if (d == c) {
+                    continue;
+                }
+                if (cand != NULL && tsp.cost(c, d) >= limit) {
+                    break;
+                }
+
+                // new edge (c, d) from the edges leaving c and d
+                int succD = tour.next(d);
+                if (d != succC && succD != c) {
+                    double variation = - tsp.cost(c, succC) - tsp.cost(d, succD) + tsp.cost(c, d) + tsp.cost(succC, succD);
+                    evaluated++;
+                    if (variation < bestCostVariation - 1e-9) {
+                        bestCostVariation = variation;
+                        bestFlip[0] = c;
+                        bestFlip[1] = succC;
+                        bestFlip[2] = d;
+                        bestFlip[3] = succD;
+                    }
+                }
+
+                // ... or from the edges entering c and d
+                int predD = tour.prev(d);
+                if (d != predC && predD != c) {
+                    double variation = - tsp.cost(predC, c) - tsp.cost(predD, d) + tsp.cost(predC, predD) + tsp.cost(c, d);
+                    evaluated++;
+                    if (variation < bestCostVariation - 1e-9) {
+                        bestCostVariation = variation;
+                        bestFlip[0] = predC;
+                        bestFlip[1] = c;
+                        bestFlip[2] = predD;
+                        bestFlip[3] = d;
+                    }
+                }
+
+                if (!mBestImprovement && bestCostVariation < 0) {
+                    break;
+                }
+            }
+            SolverMetrics::add(SolverMetrics::MOVES_EVALUATED, evaluated);
+        }
 
+        if (bestCostVariation < 0) {
+            // the edge met first going forward from node 0 is queued first
+            int first = tour.between(0, bestFlip[0], bestFlip[2]) ? 0 : 2;
 
+            {
+                SolverMetrics::Timer timer(SolverMetrics::APPLY_NS);
+                tour.flip(bestFlip[0], bestFlip[1], bestFlip[2], bestFlip[3]);
+            }
+            SolverMetrics::add(SolverMetrics::MOVES_APPLIED);
+            SolverMetrics::add(SolverMetrics::IMPROVEMENTS);
+            value += bestCostVariation;
+            iter++;
+
+            // endpoints of the removed edges become active again
+            for (int k = 0; k < 4; k++) {
+                int e = bestFlip[(first + k) % 4];
+                if (!mActive[e]) {
+                    mActive[e] = true;
+                    mQueue[(head + queued) % n] = e;
+                    queued++;
+                }
+            }
 
+            if (mStop.stop(iter, value)) {
+                break;
+            }
+        }
+    }
 
+    return iter;
+}
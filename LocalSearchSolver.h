@@ -11,6 +11,7 @@
 
 #include "solver.h"
 #include "neighborimprovement.h"
+#include "Tour.h"
 
 
 
@@ -22,16 +23,47 @@ class LocalSearchSolver : public Solver
 public:
     NeigthborImprovement* findNeighbor;
 
-    LocalSearchSolver(bool bestImprovement = true) {
-        if (bestImprovement) {
+    bool mDontLookBits;      // city driven descent with don't-look bits
+    bool mBestImprovement;
+    bool mCandidateScan;
+    Tour::Type mTourType;    // tour representation of the don't-look bits descent
+
+    /**
+     * @param bestImprovement best (true) or first (false) improvement
+     * @param candidateScan only scan moves adding a candidate edge (needs TSP::buildCandidateLists)
+     * @param dontLookBits re-examine only the cities whose tour edges changed (see solveDontLookBits)
+     * @param tourType tour representation used with dontLookBits (see Tour::create)
+     */
+    LocalSearchSolver(bool bestImprovement = true, bool candidateScan = false, bool dontLookBits = false,
+                      Tour::Type tourType = Tour::AUTO)
+        : mDontLookBits(dontLookBits), mBestImprovement(bestImprovement), mCandidateScan(candidateScan),
+          mTourType(tourType) {
+        if (candidateScan) {
+            if (bestImprovement) {
+                findNeighbor = new CandidateBestImprovement();
+            } else {
+                findNeighbor = new CandidateFirstImprovement();
+            }
+        } else if (bestImprovement) {
             findNeighbor = new BestImprovement();
         } else {
             findNeighbor = new FirstImprovement();
         }
     }
 
+    ~LocalSearchSolver() {
+        delete findNeighbor;
+    }
+
+    Solver* clone() const {
+        LocalSearchSolver* solver = new LocalSearchSolver(mBestImprovement, mCandidateScan, mDontLookBits, mTourType);
+        solver->mStop = mStop;
+        return solver;
+    }
+
   /**
-   * search for a good tour by neighbourhood search
+   * search for a good tour by neighbourhood search, down to a local optimum or
+   * until a stop criterion fires (an iteration is an applied move)
    * @param TSP TSP data
    * @param initSol initial solution
    * @param bestSol best found solution (output)
@@ -42,13 +74,29 @@ public:
   std::string getSolverName() const;
 
 
+private:
+
   /**
-   * perform a swap move (corresponding to 2-opt)
-   * @param tspSol solution to be perturbed
-   * @param move move to perform
-   * @return (into param tspSol) the perturbed solution
+   * descent driven by a FIFO queue of active cities: a city is popped, the 2-opt
+   * moves adding an edge from it to one of its neighbours (candidates, or every
+   * city) are evaluated and the best (or first) improving one is applied. The four
+   * endpoints of an applied move become active again, every other city keeps its
+   * don't-look bit set, so a pass costs O(n k) instead of O(n^2) per move.
+   *
+   * Moves are applied to a Tour (array or two-level list, see mTourType), so on
+   * large instances a flip costs O(sqrt(n)) instead of an O(n) reversal.
    */
-  TSPSolution& swap( TSPSolution& tspSol , const TSPMove& move );
+  bool solveDontLookBits( const TSP& tsp , const TSPSolution& initSol , TSPSolution& bestSol );
+
+  /**
+   * the descent of solveDontLookBits on a concrete tour type (calls are not virtual)
+   * @return number of applied moves
+   */
+  template <class TourT>
+  int descend( const TSP& tsp , const CandidateLists* cand , TourT& tour , double& value );
+
+  std::vector<int> mQueue;
+  std::vector<bool> mActive;
 };
 
 #endif /* LOCALSEARCHSOLVER_H */
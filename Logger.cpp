@@ -0,0 +1,295 @@
+/**
+ * @file Logger.cpp
+ * @brief Leveled logging, written by a background thread
+ */
+
+#include "Logger.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <chrono>
+#include <cstring>
+#include <stdint.h>
+
+using namespace std;
+
+std::atomic<int> Logger::sLevel(Logger::INFO);
+
+/**
+ * Ring of records [uint32 length][uint8 channel][text]; head and tail count the
+ * bytes ever written and read, the producer only moves head, the writer tail.
+ */
+struct Logger::ThreadBuffer
+{
+    static const size_t CAPACITY = 1 << 18;
+    static const size_t HEADER = 5;
+
+    vector<char> data;
+    atomic<size_t> head;
+    atomic<size_t> tail;
+    atomic<bool> retired;   // the thread ended: removed once drained
+
+    ThreadBuffer() : data(CAPACITY), head(0), tail(0), retired(false) {}
+
+    void put(size_t at, const char* bytes, size_t n) {
+        size_t offset = at % CAPACITY;
+        size_t first = min(n, CAPACITY - offset);
+        memcpy(&data[offset], bytes, first);
+        memcpy(&data[0], bytes + first, n - first);
+    }
+
+    void get(size_t at, char* bytes, size_t n) const {
+        size_t offset = at % CAPACITY;
+        size_t first = min(n, CAPACITY - offset);
+        memcpy(bytes, &data[offset], first);
+        memcpy(bytes + first, &data[0], n - first);
+    }
+};
+
+namespace {
+
+// owned by each thread that logs: marks its ring retired when the thread ends
+struct BufferHolder
+{
+    shared_ptr<void> buffer;
+    atomic<bool>* retired;
+
+    BufferHolder() : retired(NULL) {}
+
+    ~BufferHolder() {
+        if (retired != NULL) {
+            retired->store(true, memory_order_release);
+        }
+    }
+};
+
+thread_local BufferHolder threadHolder;
+thread_local string* captureTarget = NULL;
+
+}
+
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() : mWakeRequested(false), mStop(false), mFlushRequested(0), mFlushDone(0) {
+    mWriter = thread(&Logger::writerLoop, this);
+}
+
+Logger::~Logger() {
+    {
+        lock_guard<mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWake.notify_one();
+    mWriter.join();
+}
+
+const char* Logger::levelName(Level level) {
+    switch (level) {
+    case ERROR: return "error";
+    case WARN:  return "warn";
+    case INFO:  return "info";
+    case DEBUG: return "debug";
+    default:    return "trace";
+    }
+}
+
+Logger::Level Logger::parseLevel(const string& name) {
+    for (int level = ERROR; level <= TRACE; level++) {
+        if (name == levelName((Level)level)) {
+            return (Level)level;
+        }
+    }
+    throw runtime_error("unknown log level '" + name + "' (error, warn, info, debug or trace)");
+}
+
+void Logger::open(Channel channel, const string& filename) {
+    flush();
+    lock_guard<mutex> lock(mMutex);
+    mFiles[channel].close();
+    mFiles[channel].clear();
+    mFiles[channel].open(filename.c_str(), ios::out | ios::trunc);
+    if (!mFiles[channel]) {
+        throw runtime_error("cannot create " + filename);
+    }
+}
+
+void Logger::close(Channel channel) {
+    flush();
+    lock_guard<mutex> lock(mMutex);
+    mFiles[channel].close();
+}
+
+void Logger::flush() {
+    unique_lock<mutex> lock(mMutex);
+    unsigned long ticket = ++mFlushRequested;
+    mWake.notify_one();
+    mFlushed.wait(lock, [&]() { return mFlushDone >= ticket; });
+}
+
+void Logger::capture(string* buffer) {
+    captureTarget = buffer;
+}
+
+string* Logger::captured() {
+    return captureTarget;
+}
+
+Logger::ThreadBuffer& Logger::threadBuffer() {
+    if (!threadHolder.buffer) {
+        shared_ptr<ThreadBuffer> buffer = make_shared<ThreadBuffer>();
+        {
+            lock_guard<mutex> lock(mMutex);
+            mBuffers.push_back(buffer);
+        }
+        threadHolder.retired = &buffer->retired;
+        threadHolder.buffer = buffer;
+    }
+    return *static_cast<ThreadBuffer*>(threadHolder.buffer.get());
+}
+
+void Logger::wakeWriter() {
+    mWakeRequested.store(true, memory_order_relaxed);
+    mWake.notify_one();
+}
+
+void Logger::submit(Channel channel, const char* text, size_t length) {
+    if (length == 0) {
+        return;
+    }
+
+    ThreadBuffer& ring = threadBuffer();
+    const size_t need = ThreadBuffer::HEADER + length;
+
+    if (need > ThreadBuffer::CAPACITY) {
+        // larger than the ring: written directly, after the records queued before it
+        flush();
+        lock_guard<mutex> lock(mMutex);
+        write(channel, text, length);
+        (channel == CONSOLE ? (ostream&)cout : mFiles[channel]).flush();
+        return;
+    }
+
+    size_t head = ring.head.load(memory_order_relaxed);
+    while (ThreadBuffer::CAPACITY - (head - ring.tail.load(memory_order_acquire)) < need) {
+        wakeWriter();
+        this_thread::yield();
+    }
+
+    uint32_t length32 = (uint32_t)length;
+    char header[ThreadBuffer::HEADER];
+    memcpy(header, &length32, 4);
+    header[4] = (char)channel;
+
+    ring.put(head, header, ThreadBuffer::HEADER);
+    ring.put(head + ThreadBuffer::HEADER, text, length);
+    ring.head.store(head + need, memory_order_release);
+
+    if (head + need - ring.tail.load(memory_order_relaxed) > ThreadBuffer::CAPACITY / 2) {
+        wakeWriter();
+    }
+}
+
+void Logger::write(int channel, const char* text, size_t length) {
+    if (channel == CONSOLE) {
+        cout.write(text, length);
+    } else if (mFiles[channel].is_open()) {
+        mFiles[channel].write(text, length);
+    }
+}
+
+size_t Logger::drain() {
+    size_t drained = 0;
+
+    for (size_t b = 0; b < mBuffers.size(); ) {
+        ThreadBuffer& ring = *mBuffers[b];
+
+        // read retired before head: a retired ring gets no record after it
+        bool retired = ring.retired.load(memory_order_acquire);
+        size_t tail = ring.tail.load(memory_order_relaxed);
+        size_t head = ring.head.load(memory_order_acquire);
+
+        while (tail < head) {
+            char header[ThreadBuffer::HEADER];
+            ring.get(tail, header, ThreadBuffer::HEADER);
+            uint32_t length;
+            memcpy(&length, header, 4);
+
+            mScratch.resize(length);
+            ring.get(tail + ThreadBuffer::HEADER, &mScratch[0], length);
+            write(header[4], mScratch.data(), length);
+
+            tail += ThreadBuffer::HEADER + length;
+            drained += ThreadBuffer::HEADER + length;
+        }
+        ring.tail.store(tail, memory_order_release);
+
+        if (retired) {
+            mBuffers.erase(mBuffers.begin() + b);
+        } else {
+            b++;
+        }
+    }
+
+    return drained;
+}
+
+void Logger::writerLoop() {
+    unique_lock<mutex> lock(mMutex);
+
+    for (;;) {
+        mWake.wait_for(lock, chrono::milliseconds(5), [&]() {
+            return mStop || mFlushRequested > mFlushDone || mWakeRequested.load(memory_order_relaxed);
+        });
+        mWakeRequested.store(false, memory_order_relaxed);
+
+        unsigned long flushTarget = mFlushRequested;
+        bool stop = mStop;
+
+        if (drain() > 0 || flushTarget > mFlushDone) {
+            cout.flush();
+            for (int c = 0; c < CHANNELS; c++) {
+                if (mFiles[c].is_open()) {
+                    mFiles[c].flush();
+                }
+            }
+        }
+
+        if (flushTarget > mFlushDone) {
+            mFlushDone = flushTarget;
+            mFlushed.notify_all();
+        }
+
+        if (stop) {
+            return;
+        }
+    }
+}
+
+
+LogRecord::LogRecord(Logger::Channel channel) : mChannel(channel), mLine(threadLine()) {
+    mLine.buffer.text.clear();
+    mLine.stream.clear();
+    mLine.stream.flags(ios_base::dec | ios_base::skipws);
+    mLine.stream.precision(6);
+}
+
+LogRecord::~LogRecord() {
+    string& text = mLine.buffer.text;
+    text.push_back('\n');
+
+    string* capture = Logger::captured();
+    if (mChannel == Logger::CONSOLE && capture != NULL) {
+        capture->append(text);
+    } else {
+        Logger::instance().submit(mChannel, text);
+    }
+}
+
+LogRecord::Line& LogRecord::threadLine() {
+    static thread_local Line line;
+    return line;
+}
@@ -0,0 +1,211 @@
+/**
+ * @file Logger.h
+ * @brief Leveled logging, written by a background thread
+ *
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <string>
+#include <ostream>
+#include <streambuf>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * Every output of the program (console, output and LaTeX logs) goes through the
+ * logger, so that the solvers never wait on I/O.
+ *
+ * A record is formatted on the calling thread into a reused buffer, then copied
+ * into the ring buffer of that thread (single producer, single consumer, no lock);
+ * a background thread drains the rings into the channels and flushes them once
+ * per round, not once per line. A thread whose ring is full waits for the writer.
+ * Records of one thread keep their order.
+ *
+ * Levels: records above LOG_COMPILE_LEVEL are compiled out, the others are kept
+ * if they are not above the run-time level (setLevel(), INFO by default), a
+ * single relaxed load. The OUTPUT_LOG and LATEX_LOG channels (LOG_FILE) are not
+ * filtered.
+ *
+ * While runs execute in parallel, capture() keeps the console records of a run
+ * thread in memory, so that they can be printed in the serial order afterwards.
+ */
+class Logger
+{
+public:
+
+    enum Level {
+        ERROR,
+        WARN,
+        INFO,
+        DEBUG,      // progress of the searches (iterations, improvements)
+        TRACE       // tours, single moves
+    };
+
+    enum Channel {
+        CONSOLE,
+        OUTPUT_LOG,
+        LATEX_LOG,
+        CHANNELS
+    };
+
+    /** process wide logger, its writer thread starts on first use */
+    static Logger& instance();
+
+    static inline bool enabled(Level level) {
+        return level <= sLevel.load(std::memory_order_relaxed);
+    }
+
+    static void setLevel(Level level) {
+        sLevel.store(level, std::memory_order_relaxed);
+    }
+
+    static const char* levelName(Level level);
+
+    /**
+     * @param name error, warn, info, debug or trace
+     * @throw std::runtime_error for an unknown name
+     */
+    static Level parseLevel(const std::string& name);
+
+    /**
+     * send the records of a file channel to a file (truncated)
+     * @throw std::runtime_error if the file cannot be created
+     */
+    void open(Channel channel, const std::string& filename);
+
+    /** write the pending records and close the file of the channel */
+    void close(Channel channel);
+
+    /** when it returns, every record submitted before the call is written and flushed */
+    void flush();
+
+    /**
+     * queue text (one or more whole lines) on the channel, from the calling thread
+     */
+    void submit(Channel channel, const char* text, size_t length);
+
+    void submit(Channel channel, const std::string& text) {
+        submit(channel, text.data(), text.size());
+    }
+
+    /**
+     * append the console records of the calling thread to buffer instead of
+     * writing them, NULL to stop
+     */
+    static void capture(std::string* buffer);
+
+    static std::string* captured();
+
+    ~Logger();
+
+private:
+
+    struct ThreadBuffer;
+
+    Logger();
+    Logger(const Logger&);
+    Logger& operator=(const Logger&);
+
+    ThreadBuffer& threadBuffer();
+
+    void writerLoop();
+
+    /** write the records of every ring, with mMutex held @return bytes drained */
+    size_t drain();
+
+    void write(int channel, const char* text, size_t length);
+
+    void wakeWriter();
+
+    static std::atomic<int> sLevel;
+
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    std::condition_variable mFlushed;
+    std::atomic<bool> mWakeRequested;
+    bool mStop;
+    unsigned long mFlushRequested;
+    unsigned long mFlushDone;
+
+    std::vector< std::shared_ptr<ThreadBuffer> > mBuffers;
+    std::ofstream mFiles[CHANNELS];
+    std::string mScratch;
+
+    std::thread mWriter;
+};
+
+
+/**
+ * One record: formats into the reused buffer of the thread, submitted as a line
+ * by the destructor. Used through the LOG_ macros.
+ */
+class LogRecord
+{
+public:
+
+    explicit LogRecord(Logger::Channel channel);
+
+    ~LogRecord();
+
+    inline std::ostream& stream() {
+        return mLine.stream;
+    }
+
+private:
+
+    // std::string growing in place, its capacity is kept between records
+    class AppendBuffer : public std::streambuf
+    {
+    public:
+        std::string text;
+    protected:
+        int overflow(int c) {
+            if (c != traits_type::eof()) {
+                text.push_back((char)c);
+            }
+            return c;
+        }
+        std::streamsize xsputn(const char* s, std::streamsize n) {
+            text.append(s, n);
+            return n;
+        }
+    };
+
+    struct Line {
+        AppendBuffer buffer;
+        std::ostream stream;
+        Line() : stream(&buffer) {}
+    };
+
+    static Line& threadLine();
+
+    Logger::Channel mChannel;
+    Line& mLine;
+};
+
+
+// records above this level are compiled out: make LOG_LEVEL=4 keeps TRACE
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 3
+#endif
+
+#define LOG_AT(level) \
+    if ((int)(level) > LOG_COMPILE_LEVEL || !Logger::enabled(level)) {} else LogRecord(Logger::CONSOLE).stream()
+
+#define LOG_ERROR LOG_AT(Logger::ERROR)
+#define LOG_WARN  LOG_AT(Logger::WARN)
+#define LOG_INFO  LOG_AT(Logger::INFO)
+#define LOG_DEBUG LOG_AT(Logger::DEBUG)
+#define LOG_TRACE LOG_AT(Logger::TRACE)
+
+/** record on a file channel (Logger::OUTPUT_LOG or Logger::LATEX_LOG), never filtered */
+#define LOG_FILE(channel) LogRecord(channel).stream()
+
+#endif /* LOGGER_H */
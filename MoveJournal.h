@@ -0,0 +1,207 @@
+/**
+ * @file MoveJournal.h
+ * @brief Journal of applied moves: lazy best solution and rollback
+ *
+ */
+
+#ifndef MOVEJOURNAL_H
+#define MOVEJOURNAL_H
+
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+
+#include "TSPSolution.h"
+
+/**
+ * Records the moves applied to a solution since a base copy of it.
+ *
+ * The best solution of a search is the base followed by the first
+ * `best` moves: markBest() is O(1) instead of an O(n) copy of the
+ * current solution, and best() replays the moves only when asked.
+ *
+ * rollback() undoes the moves recorded since the last mark(), e.g. trial
+ * moves, on the current solution, and makes the best solution the one at
+ * the mark again. While a mark holds, the base is not moved past the best
+ * solution of the mark: a best solution marked during the trial is
+ * replayed into a spare copy by best(). A full journal drops the moves
+ * before the mark first; a trial that fills the journal by itself cannot be
+ * rolled back any more.
+ *
+ * The journal holds at most n moves, allocated by reset(). When it is full
+ * the best moves are replayed into the base; if it is still full the older
+ * half of the moves is dropped, and the next markBest() copies the current
+ * solution into the base. Replaying costs no more than applying the moves
+ * did, so a search pays at most twice its move cost and never allocates.
+ */
+class MoveJournal
+{
+public:
+
+    MoveJournal() : mBest(0), mDetached(false), mMarked(false), mMarkMoves(0), mMarkBest(0), mSaved(false) {}
+
+    /**
+     * start from `sol`, which is also the best solution
+     */
+    void reset(const TSPSolution& sol) {
+        if (mBase.get() == NULL || mBase->sequence.size() != sol.sequence.size()) {
+            mBase.reset(new TSPSolution(sol));
+            mSpare.reset(new TSPSolution(sol));
+        } else {
+            *mBase = sol;
+        }
+        mMoves.clear();
+        mMoves.reserve(std::max<size_t>(64, sol.sequence.size()));
+        mBest = 0;
+        mDetached = false;
+        mMarked = false;
+        mSaved = false;
+    }
+
+    /**
+     * record a move just applied to the current solution
+     */
+    void record(const TSP& tsp, const TSPMove& move) {
+        if (mMoves.size() == mMoves.capacity()) {
+            compact(tsp);
+            if (mMoves.size() == mMoves.capacity() && mMarked && mMarkMoves > 0) {
+                // drop the moves before the mark, a best solution after them is copied aside
+                if (mBest > 0 && !mSaved) {
+                    replayBest(tsp);
+                    mSaved = true;
+                }
+                mMoves.erase(mMoves.begin(), mMoves.begin() + mMarkMoves);
+                mBest = 0;
+                mMarkMoves = 0;
+                mDetached = true;
+            }
+            if (mMoves.size() == mMoves.capacity() && mMarked) {
+                // the trial does not fit: give up its mark
+                unmark();
+                compact(tsp);
+            }
+            if (mMoves.size() == mMoves.capacity()) {
+                // nothing but moves after the best: drop the older half, the
+                // current solution cannot be rebuilt any more (see markBest())
+                size_t dropped = mMoves.size() / 2;
+                mMoves.erase(mMoves.begin(), mMoves.begin() + dropped);
+                mDetached = true;
+            }
+        }
+        mMoves.push_back(move);
+    }
+
+    /**
+     * the current solution (base + every recorded move) is the best one
+     */
+    void markBest(const TSPSolution& current) {
+        if (mDetached && mMarked) {
+            // the moves of the trial are still needed: keep a copy
+            *mSpare = current;
+            mSaved = true;
+            return;
+        }
+        if (mDetached) {
+            *mBase = current;
+            mMoves.clear();
+            mDetached = false;
+        }
+        mBest = mMoves.size();
+    }
+
+    /**
+     * the best solution, valid until the next call on the journal
+     */
+    const TSPSolution& best(const TSP& tsp) {
+        compact(tsp);
+        if (mSaved) {
+            return *mSpare;
+        }
+        if (mBest > 0) {
+            // marked during a trial, past the base
+            replayBest(tsp);
+            return *mSpare;
+        }
+        return *mBase;
+    }
+
+    /**
+     * the position rollback() returns to: the current and the best solution,
+     * until the next mark()
+     */
+    void mark() {
+        unmark();
+        mMarked = true;
+        mMarkMoves = mMoves.size();
+        mMarkBest = mBest;
+    }
+
+    /**
+     * undo, on the current solution, the moves recorded since the mark;
+     * the best solution is the one at the mark again
+     */
+    void rollback(const TSP& tsp, TSPSolution& current) {
+        if (!mMarked) {
+            throw std::runtime_error("MoveJournal: no mark to roll back to, or the trial overflowed the journal");
+        }
+        while (mMoves.size() > mMarkMoves) {
+            current.apply(tsp, TSPSolution::inverse(mMoves.back()));
+            mMoves.pop_back();
+        }
+        mBest = mMarkBest;
+        mSaved = false;
+        mMarked = false;
+    }
+
+private:
+
+    // replay the best moves into the base, not past the best of the mark
+    void compact(const TSP& tsp) {
+        size_t replayed = mMarked ? std::min(mBest, mMarkBest) : mBest;
+        if (replayed == 0) {
+            return;
+        }
+        for (size_t k = 0; k < replayed; k++) {
+            mBase->apply(tsp, mMoves[k]);
+        }
+        mMoves.erase(mMoves.begin(), mMoves.begin() + replayed);
+        mBest -= replayed;
+        if (mMarked) {
+            mMarkMoves -= replayed;
+            mMarkBest -= replayed;
+        }
+    }
+
+    // the best solution into the spare copy
+    void replayBest(const TSP& tsp) {
+        *mSpare = *mBase;
+        for (size_t k = 0; k < mBest; k++) {
+            mSpare->apply(tsp, mMoves[k]);
+        }
+    }
+
+    // forget the mark; a best solution copied aside becomes the base
+    void unmark() {
+        if (mSaved) {
+            mBase.swap(mSpare);
+            mMoves.clear();
+            mBest = 0;
+            mSaved = false;
+        }
+        mMarked = false;
+    }
+
+    std::unique_ptr<TSPSolution> mBase;
+    std::unique_ptr<TSPSolution> mSpare;    // best() past the base, or the best copied by markBest()
+    std::vector<TSPMove> mMoves;
+
+    size_t mBest;       // the best solution is the base + mMoves[0 ... mBest)
+    bool mDetached;     // moves were dropped: base + mMoves is not the current solution
+    bool mMarked;
+    size_t mMarkMoves;  // mMoves[mMarkMoves ...) were recorded after the mark
+    size_t mMarkBest;   // mBest at the mark
+    bool mSaved;        // the best solution is the spare copy
+};
+
+#endif /* MOVEJOURNAL_H */
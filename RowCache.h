@@ -0,0 +1,91 @@
+/**
+ * @file RowCache.h
+ * @brief Row access that works for matrix and coordinate instances
+ *
+ */
+
+#ifndef ROWCACHE_H
+#define ROWCACHE_H
+
+#include <vector>
+
+#include "TSP.h"
+
+/**
+ * Gives whole rows of the cost matrix to code that scans them (the 2-opt
+ * neighbourhoods hoist the rows of the two fixed nodes).
+ *
+ * For matrix instances it returns the matrix row. For coordinate instances it
+ * keeps the last `capacity` requested rows, computed with the vectorized
+ * distance kernel and evicted least recently used first, so the hottest rows
+ * are never recomputed.
+ *
+ * Each user (solver, neighbourhood) owns its cache: it is not thread safe, and
+ * a returned pointer stays valid until capacity - 1 other rows are requested.
+ */
+class RowCache
+{
+public:
+
+    static const int DEFAULT_CAPACITY = 8;
+
+    explicit RowCache(int capacity = DEFAULT_CAPACITY)
+        : mCapacity(capacity < 2 ? 2 : capacity), mTsp(NULL), mN(0), mClock(0) {}
+
+    /**
+     * row i of tsp, n valid entries
+     */
+    inline const double* row(const TSP& tsp, int i) {
+        if (tsp.hasMatrix()) {
+            return tsp.row(i);
+        }
+        return cachedRow(tsp, i);
+    }
+
+private:
+
+    const double* cachedRow(const TSP& tsp, int i) {
+        if (mTsp != &tsp || mN != tsp.n) {
+            reset(tsp);
+        }
+
+        int victim = 0;
+        for (int s = 0; s < mCapacity; s++) {
+            if (mNode[s] == i) {
+                mLastUse[s] = ++mClock;
+                return &mRows[(size_t)s * mN];
+            }
+            if (mLastUse[s] < mLastUse[victim]) {
+                victim = s;
+            }
+        }
+
+        double* out = &mRows[(size_t)victim * mN];
+        tsp.coordinates()->distanceRow(i, out);
+        mNode[victim] = i;
+        mLastUse[victim] = ++mClock;
+
+        return out;
+    }
+
+    void reset(const TSP& tsp) {
+        mTsp = &tsp;
+        mN = tsp.n;
+        mRows.assign((size_t)mCapacity * mN, 0.0);
+        mNode.assign(mCapacity, -1);
+        mLastUse.assign(mCapacity, 0);
+        mClock = 0;
+    }
+
+    int mCapacity;
+
+    const TSP* mTsp;
+    int mN;
+
+    std::vector<double> mRows;
+    std::vector<int> mNode;                 // node cached in each slot, -1 if empty
+    std::vector<unsigned long> mLastUse;
+    unsigned long mClock;
+};
+
+#endif /* ROWCACHE_H */
@@ -0,0 +1,206 @@
+/**
+ * @file SimulatedAnnealingSolver.cpp
+ * @brief TSP solver (simulated annealing)
+ */
+
+#include "SimulatedAnnealingSolver.h"
+
+#include <sstream>
+#include <cmath>
+#include <climits>
+
+#include "Logger.h"
+
+
+using namespace std;
+
+// -ln(u) for u = (k + 0.5) / 2^ACCEPT_BITS
+static vector<double> buildMinusLogTable() {
+    const int size = 1 << SimulatedAnnealingSolver::ACCEPT_BITS;
+    vector<double> table(size);
+    for (int k = 0; k < size; k++) {
+        table[k] = -log((k + 0.5) / size);
+    }
+    return table;
+}
+
+static const vector<double>& minusLogTable() {
+    static const vector<double> table = buildMinusLogTable();     // built once, thread-safe
+    return table;
+}
+
+std::string SimulatedAnnealingSolver::getSolverName() const {
+    ostringstream name;
+    name << "Simulated Annealing (" << mCooling->getName() << ", epoch " << mEpochLength << " n)";
+    return name.str();
+}
+
+// value in 0 ... n-1 from 21 random bits
+static inline int scaled(uint64_t bits, int n) {
+    return (int)(((bits & 0x1FFFFF) * (uint64_t)n) >> 21);
+}
+
+inline double SimulatedAnnealingSolver::propose(const TSP& tsp, const TSPSolution& sol, uint64_t r, TSPMove& move) {
+    const int* seq = &sol.sequence[0];
+    const int last = sol.sequence.size() - 1;     // position of the closing node 0
+
+    if (r & 1) {
+        // 2-opt: reverse positions from ... to, 1 <= from < to < last
+        int i = 1 + scaled(r >> 1, last - 1);
+        int j = 1 + scaled(r >> 22, last - 1);
+        if (i == j) {
+            return tsp.infinite;
+        }
+        move.type = TSPMove::TWO_OPT;
+        move.from = min(i, j);
+        move.to = max(i, j);
+
+        int h = seq[move.from - 1], a = seq[move.from];
+        int b = seq[move.to], l = seq[move.to + 1];
+        return - tsp.cost(h, a) - tsp.cost(b, l) + tsp.cost(h, b) + tsp.cost(a, l);
+    }
+
+    // Or-opt: the length nodes from position from go after position to
+    // length uniform in 1 ... 3 (the modulo of 45 bits is unbiased to 2^-44)
+    const int length = 1 + (int)(((r >> 1) & 0x1FFFFFFFFFFFULL) % 3);
+    if (last < length + 3) {
+        return tsp.infinite;
+    }
+    move.type = TSPMove::OR_OPT;
+    move.length = length;
+    move.reversed = (r >> 3) & 1;
+    move.from = 1 + scaled(r >> 4, last - length);
+    move.to = scaled(r >> 25, last);
+    if (move.to >= move.from - 1 && move.to < move.from + length) {
+        return tsp.infinite;    // inside the segment or already before it
+    }
+
+    int p = seq[move.from - 1], s1 = seq[move.from];
+    int sL = seq[move.from + length - 1], q = seq[move.from + length];
+    int u = seq[move.to], v = seq[move.to + 1];
+    double variation = - tsp.cost(p, s1) - tsp.cost(sL, q) + tsp.cost(p, q) - tsp.cost(u, v);
+    if (move.reversed) {
+        return variation + tsp.cost(u, sL) + tsp.cost(s1, v);
+    }
+    return variation + tsp.cost(u, s1) + tsp.cost(sL, v);
+}
+
+double SimulatedAnnealingSolver::initialTemperature(const TSP& tsp, const TSPSolution& sol) {
+    TSPMove move;
+    double sum = 0;
+    int count = 0;
+
+    for (int k = 0; k < 1000; k++) {
+        double variation = propose(tsp, sol, mRandom.next(), move);
+        if (variation > 0 && variation < tsp.infinite) {
+            sum += variation;
+            count++;
+        }
+    }
+
+    // exp(-mean / T) = 1/2
+    return (count > 0) ? sum / count / log(2.0) : 1.0;
+}
+
+double SimulatedAnnealingSolver::progress(int epochs) const {
+    double progress = -1;
+    if (mStop.cpuTimeLimit() < HUGE_VAL) {
+        progress = max(progress, mStop.cpuSeconds() / mStop.cpuTimeLimit());
+    }
+    if (mStop.timeLimit() < HUGE_VAL) {
+        progress = max(progress, mStop.wallSeconds() / mStop.timeLimit());
+    }
+    if (mStop.iterationLimit() < LONG_MAX) {
+        progress = max(progress, (double)epochs / mStop.iterationLimit());
+    }
+    if (progress < 0) {
+        progress = (double)epochs / UNBOUNDED_EPOCHS;
+    }
+    return min(progress, 1.0);
+}
+
+bool SimulatedAnnealingSolver::solve(const TSP& tsp, const TSPSolution& initSol, TSPSolution& bestSol) {
+
+    try {
+        mRandom.seed(mSeed);
+
+        TSPSolution currSol(initSol);
+        double currValue = currSol.evaluate(tsp);
+        double bestValue = currValue;
+        mJournal.reset(currSol);
+
+        const vector<double>& minusLog = minusLogTable();
+        mThreshold.resize(minusLog.size());
+
+        const long epochProposals = (long)mEpochLength * tsp.n;
+        double temperature = initialTemperature(tsp, currSol);
+        mCooling->start(temperature);
+
+        mStop.start();
+        unsigned long proposals = 0;
+        uint iter = 0;
+        int epoch = 0;
+        int frozen = 0;
+
+        TSPMove move;
+
+        while (frozen < FROZEN_EPOCHS && !mStop.stop(epoch, bestValue)) {
+            for (size_t k = 0; k < mThreshold.size(); k++) {
+                mThreshold[k] = temperature * minusLog[k];
+            }
+
+            long accepted = 0;
+            long changed = 0;   // accepted moves with a non-zero variation
+            for (long k = 0; k < epochProposals; k++) {
+                // one random number: the move from the low bits, the acceptance from the top ones
+                uint64_t r = mRandom.next();
+                double variation = propose(tsp, currSol, r, move);
+
+                // worsening moves pass with probability exp(-variation / T)
+                if (variation >= mThreshold[r >> (64 - ACCEPT_BITS)]) {
+                    continue;
+                }
+
+                currSol.apply(tsp, move);
+                mJournal.record(tsp, move);
+                currValue += variation;
+                accepted++;
+                changed += (fabs(variation) > 1e-9);
+
+                if (currValue < bestValue - 1e-9) {
+                    bestValue = currValue;
+                    mJournal.markBest(currSol);
+                    if (mStop.targetReached(bestValue)) {
+                        break;
+                    }
+                }
+            }
+
+            proposals += epochProposals;
+            iter += accepted;
+            epoch++;
+            frozen = (changed == 0) ? frozen + 1 : 0;
+
+            double acceptance = (double)accepted / epochProposals;
+            if (epoch % 10 == 0) {
+                LOG_DEBUG << " (" << epoch << ") T " << temperature << "\taccepted " << acceptance
+                          << "\tvalue " << currValue << " (" << bestValue << ")";
+            }
+
+            temperature = mCooling->next(temperature, progress(epoch), acceptance);
+        }
+
+        double seconds = mStop.cpuSeconds();
+        LOG_INFO << "epochs " << epoch << "\tproposals " << proposals
+                 << " (" << (seconds > 0 ? proposals / seconds / 1e6 : 0) << " M/s)";
+
+        bestSol = mJournal.best(tsp);
+        bestSol.iterations = iter;
+    }
+    catch (std::exception& e) {
+        LOG_ERROR << ">>>EXCEPTION: " << e.what();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file SimulatedAnnealingSolver.h
+ * @brief TSP solver (simulated annealing)
+ *
+ */
+
+#ifndef SIMULATEDANNEALINGSOLVER_H
+#define SIMULATEDANNEALINGSOLVER_H
+
+#include <vector>
+
+#include "solver.h"
+#include "FastRandom.h"
+#include "CoolingSchedule.h"
+#include "MoveJournal.h"
+
+/**
+ * Class that solves a TSP problem by simulated annealing.
+ *
+ * Every proposal is a random 2-opt or Or-opt move (segment of 1 ... 3 nodes,
+ * reversed or not) whose cost variation is computed in O(1); only accepted moves
+ * touch the tour. A move costing delta > 0 is accepted with probability
+ * exp(-delta / T), i.e. when delta < T * -ln(u) for u uniform in (0, 1]: -ln(u)
+ * is tabulated once for ACCEPT_BITS bits of u and scaled by T once per epoch,
+ * so a proposal draws one random number (move and u) and reads one table entry,
+ * no exp().
+ *
+ * The run is cut into epochs of epochLength * n proposals; the cooling schedule
+ * sets the temperature of each one from the elapsed fraction of the budget (the
+ * CPU time, wall-clock time or epoch limit nearest to its end, UNBOUNDED_EPOCHS
+ * epochs without any). The initial temperature accepts an average worsening
+ * proposal with probability 1/2. The run stops when FROZEN_EPOCHS epochs in a row
+ * accepted no move changing the value, or on the stop criteria (checked once per
+ * epoch, an iteration is an epoch; the time budget is a CPU time limit).
+ */
+class SimulatedAnnealingSolver : public Solver
+{
+public:
+
+    static const int ACCEPT_BITS = 12;
+    static const int FROZEN_EPOCHS = 3;
+    static const int UNBOUNDED_EPOCHS = 100;
+
+    CoolingSchedule* mCooling;
+
+    double mMaxTime;
+    int mEpochLength;
+    unsigned long mSeed;
+
+    /**
+     * @param maxSeconds CPU time budget, the temperature schedule follows it
+     * @param cooling temperature schedule (owned), NULL = GeometricCooling()
+     * @param seed random generator seed: runs with the same seed and initial solution are identical
+     * @param epochLength proposals per epoch, per node
+     */
+    SimulatedAnnealingSolver(double maxSeconds = 10, CoolingSchedule* cooling = NULL, unsigned long seed = 1,
+                             int epochLength = 100)
+        : mCooling(cooling ? cooling : new GeometricCooling()), mMaxTime(maxSeconds), mEpochLength(epochLength),
+          mSeed(seed) {
+        mStop.setCpuTimeLimit(maxSeconds);
+    }
+
+    ~SimulatedAnnealingSolver() {
+        delete mCooling;
+    }
+
+    Solver* clone() const {
+        SimulatedAnnealingSolver* solver = new SimulatedAnnealingSolver(mMaxTime, mCooling->clone(), mSeed, mEpochLength);
+        solver->mStop = mStop;
+        return solver;
+    }
+
+    std::string getSolverName() const;
+
+    /**
+     * search for a good tour by simulated annealing
+     * @param TSP TSP data
+     * @param initSol initial solution
+     * @param bestSol best found solution (output), iterations = accepted moves
+     * @return true id everything OK, false otherwise
+     */
+    bool solve(const TSP& tsp, const TSPSolution& initSol, TSPSolution& bestSol);
+
+private:
+
+    SimulatedAnnealingSolver(const SimulatedAnnealingSolver&);
+    SimulatedAnnealingSolver& operator=(const SimulatedAnnealingSolver&);
+
+    /**
+     * random 2-opt or Or-opt move of sol, drawn from the low 46 bits of r
+     * @return its cost variation, tsp.infinite if the draw is not a move
+     */
+    inline double propose(const TSP& tsp, const TSPSolution& sol, uint64_t r, TSPMove& move);
+
+    /**
+     * temperature accepting an average worsening move with probability 1/2
+     */
+    double initialTemperature(const TSP& tsp, const TSPSolution& sol);
+
+    /**
+     * elapsed fraction of the budget, 0 ... 1
+     * @param epochs epochs done
+     */
+    double progress(int epochs) const;
+
+    FastRandom mRandom;
+    std::vector<double> mThreshold;     // T * -ln(u) for the 2^ACCEPT_BITS values of u
+    MoveJournal mJournal;
+};
+
+#endif /* SIMULATEDANNEALINGSOLVER_H */
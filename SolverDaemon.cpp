@@ -0,0 +1,457 @@
+/**
+ * @file SolverDaemon.cpp
+ * @brief Long-lived solver process serving jobs on a Unix domain socket
+ */
+
+#include "SolverDaemon.h"
+
+#include <sstream>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "CpuTime.h"
+#include "ThreadPool.h"
+#include "TourConstruction.h"
+#include "StopCriteria.h"
+#include "Logger.h"
+
+using namespace std;
+
+namespace {
+
+// a request longer than this closes the connection
+const size_t MAX_REQUEST = 1 << 20;
+
+vector<string> tokens(const string& line) {
+    vector<string> words;
+    istringstream in(line);
+    string word;
+    while (in >> word) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+// "time limit" -> time_limit: the values of a reply have no spaces
+string replyValue(const char* text) {
+    string value(text);
+    replace(value.begin(), value.end(), ' ', '_');
+    return value;
+}
+
+sockaddr_un socketAddress(const string& path) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        throw runtime_error("bad socket path '" + path + "'");
+    }
+    strcpy(address.sun_path, path.c_str());
+    return address;
+}
+
+}
+
+
+struct SolverDaemon::Connection
+{
+    int fd;
+    int number;         // for the log
+    string input;       // received, not yet a whole line (serve() only)
+    long requests;      // ids given (serve() only)
+    bool reading;       // false once the client shut its side down (serve() only)
+
+    mutex writeMutex;
+    atomic<bool> broken;
+    CancellationToken cancellation;
+
+    Connection(int fd, int number) : fd(fd), number(number), requests(0), reading(true), broken(false) {}
+
+    ~Connection() {
+        close(fd);
+    }
+
+    /** write a reply line, from any thread; a failure cancels the jobs of the connection */
+    void send(const string& line) {
+        if (broken.load()) {
+            return;
+        }
+        string text = line + "\n";
+
+        lock_guard<mutex> lock(writeMutex);
+        size_t sent = 0;
+        while (sent < text.size()) {
+            ssize_t n = ::send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                hangUp();
+                return;
+            }
+            sent += n;
+        }
+    }
+
+    /** the client is gone: cancel its jobs */
+    void hangUp() {
+        if (!broken.exchange(true)) {
+            cancellation.cancel();
+            LOG_DEBUG << "connection " << number << ": client gone, its jobs are cancelled";
+        }
+    }
+};
+
+
+SolverDaemon::SolverDaemon(const string& socketPath, int workers, size_t cacheBytes)
+    : mSocketPath(socketPath), mListenFd(-1), mStopping(false), mCache(cacheBytes),
+      mAccepted(0), mStop(false), mRunning(0), mDone(0) {
+    mWakePipe[0] = mWakePipe[1] = -1;
+
+    sockaddr_un address = socketAddress(socketPath);
+
+    // a socket file nobody listens on is left by a daemon that died: replace it
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe >= 0) {
+        bool alive = connect(probe, (sockaddr*)&address, sizeof(address)) == 0;
+        close(probe);
+        if (alive) {
+            throw runtime_error("another process listens on " + socketPath);
+        }
+    }
+    unlink(socketPath.c_str());
+
+    mListenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (mListenFd < 0 || bind(mListenFd, (sockaddr*)&address, sizeof(address)) != 0 || listen(mListenFd, 64) != 0) {
+        string error = strerror(errno);
+        if (mListenFd >= 0) {
+            close(mListenFd);
+        }
+        throw runtime_error("cannot listen on " + socketPath + ": " + error);
+    }
+
+    if (pipe(mWakePipe) != 0) {
+        close(mListenFd);
+        unlink(socketPath.c_str());
+        throw runtime_error(string("cannot create a pipe: ") + strerror(errno));
+    }
+
+    if (workers <= 0) {
+        workers = ThreadPool::defaultThreads();
+    }
+    for (int w = 0; w < workers; w++) {
+        mWorkers.push_back(thread(&SolverDaemon::workerLoop, this));
+    }
+
+    LOG_INFO << "listening on " << socketPath << ", " << workers << " workers";
+}
+
+SolverDaemon::~SolverDaemon() {
+    {
+        lock_guard<mutex> lock(mMutex);
+        mStop = true;
+        mQueue.clear();
+        for (size_t c = 0; c < mLive.size(); c++) {
+            shared_ptr<Connection> connection = mLive[c].lock();
+            if (connection) {
+                connection->cancellation.cancel();
+            }
+        }
+    }
+    mWake.notify_all();
+    for (size_t w = 0; w < mWorkers.size(); w++) {
+        mWorkers[w].join();
+    }
+
+    mConnections.clear();
+    close(mListenFd);
+    close(mWakePipe[0]);
+    close(mWakePipe[1]);
+    unlink(mSocketPath.c_str());
+}
+
+void SolverDaemon::stop() {
+    mStopping.store(true);
+    char byte = 0;
+    ssize_t written = write(mWakePipe[1], &byte, 1);
+    (void)written;
+}
+
+void SolverDaemon::serve() {
+    vector<pollfd> polled;
+
+    while (!mStopping.load()) {
+        polled.clear();
+        pollfd wake = { mWakePipe[0], POLLIN, 0 };
+        pollfd listening = { mListenFd, POLLIN, 0 };
+        polled.push_back(wake);
+        polled.push_back(listening);
+        for (size_t c = 0; c < mConnections.size(); c++) {
+            // a shut down connection is still polled: POLLHUP tells when the client closes it
+            pollfd client = { mConnections[c]->fd, (short)(mConnections[c]->reading ? POLLIN : 0), 0 };
+            polled.push_back(client);
+        }
+
+        if (poll(&polled[0], polled.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw runtime_error(string("poll failed: ") + strerror(errno));
+        }
+        if (mStopping.load()) {
+            break;
+        }
+
+        // connections first: accept() appends to mConnections
+        for (size_t c = polled.size() - 2; c-- > 0; ) {
+            Connection& connection = *mConnections[c];
+            short events = polled[c + 2].revents;
+            if (events == 0) {
+                continue;
+            }
+            if (connection.reading && !receive(connection, mConnections[c])) {
+                // shut down: the queued jobs still reply, the client may wait for them
+                connection.reading = false;
+            }
+            if (!connection.reading && (events & (POLLHUP | POLLERR))) {
+                LOG_DEBUG << "connection " << connection.number << " closed";
+                if (mConnections[c].use_count() > 1) {
+                    connection.hangUp();
+                }
+                mConnections.erase(mConnections.begin() + c);
+            }
+        }
+        if (polled[1].revents & POLLIN) {
+            accept();
+        }
+    }
+
+    LOG_INFO << "stopping";
+}
+
+void SolverDaemon::accept() {
+    int fd = ::accept(mListenFd, NULL, NULL);
+    if (fd < 0) {
+        LOG_WARN << "accept failed: " << strerror(errno);
+        return;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    shared_ptr<Connection> connection = make_shared<Connection>(fd, ++mAccepted);
+    mConnections.push_back(connection);
+    LOG_DEBUG << "connection " << connection->number << " opened";
+
+    lock_guard<mutex> lock(mMutex);
+    mLive.erase(remove_if(mLive.begin(), mLive.end(),
+                          [](const weak_ptr<Connection>& live) { return live.expired(); }), mLive.end());
+    mLive.push_back(connection);
+}
+
+bool SolverDaemon::receive(Connection& connection, const shared_ptr<Connection>& shared) {
+    char buffer[1 << 12];
+    ssize_t n = recv(connection.fd, buffer, sizeof(buffer), 0);
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+        return true;
+    }
+    if (n <= 0) {
+        return false;
+    }
+    connection.input.append(buffer, n);
+
+    size_t end;
+    while ((end = connection.input.find('\n')) != string::npos) {
+        string line = connection.input.substr(0, end);
+        connection.input.erase(0, end + 1);
+        if (!line.empty() && line[line.size() - 1] == '\r') {
+            line.erase(line.size() - 1);
+        }
+        request(shared, line);
+    }
+
+    if (connection.input.size() > MAX_REQUEST) {
+        connection.send("error 0 request too long");
+        connection.hangUp();
+        shutdown(connection.fd, SHUT_RDWR);
+        return false;
+    }
+    return true;
+}
+
+void SolverDaemon::request(const shared_ptr<Connection>& connection, const string& line) {
+    vector<string> words = tokens(line);
+    if (words.empty()) {
+        return;
+    }
+
+    if (words[0] == "stats") {
+        InstanceCache::Stats cache = mCache.stats();
+        ostringstream reply;
+        {
+            lock_guard<mutex> lock(mMutex);
+            reply << "stats instances=" << cache.entries << " bytes=" << cache.bytes << " hits=" << cache.hits
+                  << " misses=" << cache.misses << " evictions=" << cache.evictions
+                  << " queued=" << mQueue.size() << " running=" << mRunning << " done=" << mDone;
+        }
+        connection->send(reply.str());
+        return;
+    }
+
+    if (words[0] != "solve" && words[0] != "load") {
+        connection->send("error 0 unknown request '" + words[0] + "' (solve, load or stats)");
+        return;
+    }
+
+    Job job;
+    job.connection = connection;
+    job.id = ++connection->requests;
+    job.loadOnly = (words[0] == "load");
+    job.seed = 1;
+
+    try {
+        if (words.size() < 2) {
+            throw runtime_error("missing instance");
+        }
+        job.instance = words[1];
+
+        vector<string> options;
+        for (size_t w = 2; w < words.size(); w++) {
+            if (words[w] == "--seed" && w + 1 < words.size()) {
+                job.seed = strtoul(words[++w].c_str(), NULL, 0);
+            } else {
+                options.push_back(words[w]);
+            }
+        }
+        if (job.loadOnly && !options.empty()) {
+            throw runtime_error("load takes no option");
+        }
+        // getopt: here, on the serving thread only
+        job.options.parse(options);
+    }
+    catch (exception& e) {
+        connection->send("error " + to_string(job.id) + " " + e.what());
+        return;
+    }
+
+    connection->send("queued " + to_string(job.id));
+    {
+        lock_guard<mutex> lock(mMutex);
+        mQueue.push_back(job);
+    }
+    mWake.notify_one();
+}
+
+void SolverDaemon::workerLoop() {
+    for (;;) {
+        Job job;
+        {
+            unique_lock<mutex> lock(mMutex);
+            mWake.wait(lock, [this]() { return mStop || !mQueue.empty(); });
+            if (mStop) {
+                return;
+            }
+            job = mQueue.front();
+            mQueue.pop_front();
+            mRunning++;
+        }
+
+        if (!job.connection->broken.load()) {
+            run(job);
+        }
+
+        job.connection.reset();     // the last reference closes the socket
+
+        lock_guard<mutex> lock(mMutex);
+        mRunning--;
+        mDone++;
+    }
+}
+
+void SolverDaemon::run(const Job& job) {
+    Connection& connection = *job.connection;
+    const string id = to_string(job.id);
+
+    // the solvers print as in ./main: not for the clients
+    string output;
+    Logger::capture(&output);
+
+    try {
+        const SolverOptions& options = job.options;
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        string key;
+        bool cached;
+        shared_ptr<const TSP> tsp;
+        if (job.instance[0] == '@') {
+            key = job.instance.substr(1);
+            tsp = mCache.find(key, options.candidates, options.quadrant, cached);
+            if (!tsp) {
+                throw runtime_error("instance " + key + " not cached, send its file");
+            }
+        } else {
+            tsp = mCache.get(job.instance, options.candidates, options.quadrant, key, cached);
+        }
+
+        if (job.loadOnly) {
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            Logger::capture(NULL);
+            ostringstream reply;
+            reply << "loaded " << id << " instance=" << key << " nodes=" << tsp->n
+                  << " cached=" << (cached ? 1 : 0) << " seconds=" << seconds;
+            connection.send(reply.str());
+            return;
+        }
+
+        TSPSolution init(*tsp);
+        if (options.initMethod == TourConstruction::RANDOM) {
+            init.initRandom(job.seed);
+            init.evaluate(*tsp);
+        } else {
+            TourConstruction::build(*tsp, options.initMethod, init, job.seed);
+        }
+
+        Solver* solver = options.buildSolver(job.seed);
+        solver->stopCriteria().setCancellation(&connection.cancellation);
+        TSPSolution best(init);
+
+        double cpuStart = threadCpuTime();
+        bool ok = solver->solve(*tsp, init, best);
+        double cpuTime = threadCpuTime() - cpuStart + solver->workerCpuTime();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        string stop = replyValue(solver->stopCriteria().reasonName());
+        delete solver;
+
+        Logger::capture(NULL);
+
+        if (!ok) {
+            throw runtime_error("the solver failed");
+        }
+
+        ostringstream reply;
+        reply.precision(10);
+        reply << "result " << id << " instance=" << key << " cached=" << (cached ? 1 : 0)
+              << " value=" << best.value() << " iterations=" << best.iterations
+              << " seconds=" << seconds << " cpu=" << cpuTime << " stop=" << stop << " tour=";
+        for (size_t i = 0; i < best.sequence.size(); i++) {
+            reply << (i > 0 ? "," : "") << best.sequence[i];
+        }
+        connection.send(reply.str());
+
+        LOG_DEBUG << "connection " << connection.number << " job " << id << ": " << job.instance
+                  << (cached ? " (cached)" : " (loaded)") << " value " << best.value() << " in " << seconds << " s";
+    }
+    catch (exception& e) {
+        Logger::capture(NULL);
+        connection.send("error " + id + " " + e.what());
+    }
+}
@@ -0,0 +1,129 @@
+/**
+ * @file SolverDaemon.h
+ * @brief Long-lived solver process serving jobs on a Unix domain socket
+ *
+ */
+
+#ifndef SOLVERDAEMON_H
+#define SOLVERDAEMON_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "SolverOptions.h"
+#include "InstanceCache.h"
+
+/**
+ * Serves solve jobs to clients connected to a Unix domain socket, without the
+ * process start and the instance loading of a ./main run per job: the instances
+ * stay loaded in an InstanceCache.
+ *
+ * Protocol: text lines, one request per line, the replies are lines too.
+ *
+ *   solve <instance> [--seed n] <solver options>
+ *       <instance> is a file (absolute, or relative to the daemon directory) or
+ *       @<key>, the key of a cached instance (the instance= of a previous reply).
+ *       The solver options are those of main (--ts --tenure 50 --secs 2 ...),
+ *       the seed (default 1) sets the random initial tour and the solver.
+ *       Replies "queued <id>" at once, then "result <id> instance=<key>
+ *       cached=<0|1> value=<v> iterations=<n> seconds=<wall> cpu=<s>
+ *       stop=<reason> tour=<node>,<node>,..." when the job ended, or
+ *       "error <id> <message>".
+ *   load <instance>
+ *       load an instance ahead of the jobs: "queued <id>", then "loaded <id>
+ *       instance=<key> nodes=<n> cached=<0|1> seconds=<s>" or "error <id> ...".
+ *   stats
+ *       "stats instances=... bytes=... hits=... misses=... evictions=...
+ *       queued=... running=... done=..."
+ *
+ * Ids count the solve and load requests of a connection from 1. A connection
+ * may send any number of requests without waiting: the jobs of every connection
+ * run on a shared pool of worker threads and each result is sent when its job
+ * ends, so the results of one connection may come in any order. cpu= is the CPU
+ * time of the thread that ran the job, plus that of the islands of an island
+ * search.
+ *
+ * A single thread polls the listening socket and the connections and parses the
+ * requests; the workers load the instances, solve and write the replies. The
+ * jobs of a connection whose replies cannot be written any more are cancelled.
+ */
+class SolverDaemon
+{
+public:
+
+    /**
+     * listen on socketPath (a stale socket file is replaced) and start the workers
+     * @param workers jobs run at the same time, 0 = one per hardware thread
+     * @param cacheBytes capacity of the instance cache
+     * @throw std::runtime_error if the socket cannot be created, or another
+     *        process listens on it
+     */
+    SolverDaemon(const std::string& socketPath, int workers, size_t cacheBytes);
+
+    /** stops the workers and removes the socket file */
+    ~SolverDaemon();
+
+    /** serve the clients until stop() */
+    void serve();
+
+    /**
+     * make serve() return: the queued jobs are dropped, the running ones are
+     * cancelled and reply with their best tour. Async-signal-safe.
+     */
+    void stop();
+
+private:
+
+    SolverDaemon(const SolverDaemon&);
+    SolverDaemon& operator=(const SolverDaemon&);
+
+    struct Connection;
+
+    struct Job {
+        std::shared_ptr<Connection> connection;
+        long id;
+        bool loadOnly;
+        std::string instance;
+        SolverOptions options;
+        unsigned long seed;
+    };
+
+    void accept();
+
+    /** read what the connection sent, @return false once it is closed */
+    bool receive(Connection& connection, const std::shared_ptr<Connection>& shared);
+
+    void request(const std::shared_ptr<Connection>& connection, const std::string& line);
+
+    void workerLoop();
+
+    void run(const Job& job);
+
+    std::string mSocketPath;
+    int mListenFd;
+    int mWakePipe[2];               // stop() writes, serve() polls the read end
+    std::atomic<bool> mStopping;
+
+    InstanceCache mCache;
+
+    std::vector< std::shared_ptr<Connection> > mConnections;    // open for reading, serve() only
+    int mAccepted;
+
+    std::mutex mMutex;              // guards everything below
+    std::condition_variable mWake;
+    std::deque<Job> mQueue;
+    std::vector< std::weak_ptr<Connection> > mLive;     // every connection, for the cancellation at stop
+    bool mStop;
+    int mRunning;
+    unsigned long mDone;
+
+    std::vector<std::thread> mWorkers;
+};
+
+#endif /* SOLVERDAEMON_H */
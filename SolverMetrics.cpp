@@ -0,0 +1,334 @@
+/**
+ * @file SolverMetrics.cpp
+ * @brief Counters and timers of the solver hot paths, Prometheus textfile exposition
+ */
+
+#include "SolverMetrics.h"
+
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "Logger.h"
+
+using namespace std;
+
+thread_local SolverMetrics::ThreadBlock* SolverMetrics::sThreadBlock = NULL;
+
+namespace {
+
+// blocks of the live threads, totals of the ended ones
+struct Registry
+{
+    mutex lock;
+    vector<void*> blocks;
+    uint64_t retired[SolverMetrics::COUNTERS];
+
+    Registry() {
+        memset(retired, 0, sizeof(retired));
+    }
+};
+
+// never destroyed: threads of static objects (the thread pools) may end after the statics
+Registry& registry() {
+    static Registry* registry = new Registry();
+    return *registry;
+}
+
+}
+
+// owned by each thread that counts: moves its counts to the totals when the thread ends
+struct SolverMetrics::ThreadHolder
+{
+    ThreadBlock block;
+    bool registered;
+
+    ThreadHolder() : registered(false) {
+        for (int c = 0; c < COUNTERS; c++) {
+            block.value[c].store(0, memory_order_relaxed);
+        }
+    }
+
+    ~ThreadHolder() {
+        if (!registered) {
+            return;
+        }
+        Registry& r = registry();
+        lock_guard<mutex> guard(r.lock);
+        for (int c = 0; c < COUNTERS; c++) {
+            r.retired[c] += block.value[c].load(memory_order_relaxed);
+        }
+        r.blocks.erase(find(r.blocks.begin(), r.blocks.end(), (void*)&block));
+        sThreadBlock = NULL;
+    }
+};
+
+SolverMetrics::ThreadBlock& SolverMetrics::registerThread() {
+    static thread_local ThreadHolder holder;
+
+    Registry& r = registry();
+    {
+        lock_guard<mutex> guard(r.lock);
+        r.blocks.push_back(&holder.block);
+    }
+    holder.registered = true;
+    sThreadBlock = &holder.block;
+    return holder.block;
+}
+
+void SolverMetrics::totals(uint64_t totals[COUNTERS]) {
+    Registry& r = registry();
+    lock_guard<mutex> guard(r.lock);
+
+    for (int c = 0; c < COUNTERS; c++) {
+        totals[c] = r.retired[c];
+    }
+    for (size_t b = 0; b < r.blocks.size(); b++) {
+        const ThreadBlock* block = static_cast<const ThreadBlock*>(r.blocks[b]);
+        for (int c = 0; c < COUNTERS; c++) {
+            totals[c] += block->value[c].load(memory_order_relaxed);
+        }
+    }
+}
+
+uint64_t SolverMetrics::total(Counter counter) {
+    uint64_t values[COUNTERS];
+    totals(values);
+    return values[counter];
+}
+
+const char* SolverMetrics::metricName(Counter counter) {
+    switch (counter) {
+    case MOVES_EVALUATED:     return "tsp_moves_evaluated_total";
+    case TABU_REJECTED:       return "tsp_tabu_rejected_total";
+    case ASPIRATION_ACCEPTED: return "tsp_aspiration_accepted_total";
+    case IMPROVEMENTS:        return "tsp_improvements_total";
+    case MOVES_APPLIED:       return "tsp_moves_applied_total";
+    case NEIGHBORHOOD_NS:     return "tsp_neighborhood_seconds_total";
+    default:                  return "tsp_apply_seconds_total";
+    }
+}
+
+const char* SolverMetrics::description(Counter counter) {
+    switch (counter) {
+    case MOVES_EVALUATED:     return "Neighbour moves evaluated";
+    case TABU_REJECTED:       return "Moves discarded because tabu";
+    case ASPIRATION_ACCEPTED: return "Tabu moves accepted by the aspiration criterion";
+    case IMPROVEMENTS:        return "Improvements of the best value of a search";
+    case MOVES_APPLIED:       return "Moves applied to the current tour";
+    case NEIGHBORHOOD_NS:     return "Time spent scanning neighbourhoods";
+    default:                  return "Time spent applying moves";
+    }
+}
+
+bool SolverMetrics::writeTextfile(const string& filename) {
+    const string temporary = filename + ".tmp";
+    {
+        ofstream out(temporary.c_str(), ios::out | ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out.precision(9);
+
+        uint64_t values[COUNTERS];
+        totals(values);
+        for (int c = 0; c < COUNTERS; c++) {
+            Counter counter = (Counter)c;
+            out << "# HELP " << metricName(counter) << " " << description(counter) << "\n"
+                << "# TYPE " << metricName(counter) << " counter\n"
+                << metricName(counter) << " ";
+            if (counter == NEIGHBORHOOD_NS || counter == APPLY_NS) {
+                out << values[c] * 1e-9 << "\n";
+            } else {
+                out << values[c] << "\n";
+            }
+        }
+
+        const HardwareCounters& hardware = HardwareCounters::instance();
+        for (int e = 0; e < HardwareCounters::EVENTS; e++) {
+            HardwareCounters::Event event = (HardwareCounters::Event)e;
+            uint64_t value;
+            if (hardware.read(event, value)) {
+                out << "# HELP " << HardwareCounters::metricName(event) << " " << HardwareCounters::description(event) << "\n"
+                    << "# TYPE " << HardwareCounters::metricName(event) << " counter\n"
+                    << HardwareCounters::metricName(event) << " " << value << "\n";
+            }
+        }
+
+        out << "# HELP tsp_metrics_compiled_in 1 if the solver counters are compiled in (make METRICS=1)\n"
+            << "# TYPE tsp_metrics_compiled_in gauge\n"
+            << "tsp_metrics_compiled_in " << (enabled() ? 1 : 0) << "\n";
+
+        out.flush();
+        if (!out) {
+            return false;
+        }
+    }
+    return rename(temporary.c_str(), filename.c_str()) == 0;
+}
+
+void SolverMetrics::printSummary(double seconds) {
+    uint64_t values[COUNTERS];
+    totals(values);
+
+    LOG_INFO << "\n-----------------------------------------------------------------------------------\n"
+             << "Metrics" << (enabled() ? "" : " (solver counters not compiled in: make METRICS=1)")
+             << "\n-----------------------------------------------------------------------------------";
+
+    if (enabled()) {
+        const double perSecond = (seconds > 0) ? 1 / seconds : 0;
+        LOG_INFO << "moves evaluated:     " << values[MOVES_EVALUATED]
+                 << "\t(" << values[MOVES_EVALUATED] * perSecond * 1e-6 << " M/s)";
+        LOG_INFO << "tabu rejected:       " << values[TABU_REJECTED];
+        LOG_INFO << "aspiration accepted: " << values[ASPIRATION_ACCEPTED];
+        LOG_INFO << "improvements:        " << values[IMPROVEMENTS];
+        LOG_INFO << "moves applied:       " << values[MOVES_APPLIED]
+                 << "\t(" << values[MOVES_APPLIED] * perSecond << " /s)";
+        LOG_INFO << "neighbourhood time:  " << values[NEIGHBORHOOD_NS] * 1e-9 << " s"
+                 << "\t(" << (values[MOVES_EVALUATED] > 0 ? (double)values[NEIGHBORHOOD_NS] / values[MOVES_EVALUATED] : 0)
+                 << " ns per move)";
+        LOG_INFO << "apply time:          " << values[APPLY_NS] * 1e-9 << " s"
+                 << "\t(" << (values[MOVES_APPLIED] > 0 ? (double)values[APPLY_NS] / values[MOVES_APPLIED] : 0)
+                 << " ns per move)";
+    }
+
+    const HardwareCounters& hardware = HardwareCounters::instance();
+    if (hardware.isOpen()) {
+        uint64_t cycles = 0, instructions = 0, value;
+        for (int e = 0; e < HardwareCounters::EVENTS; e++) {
+            HardwareCounters::Event event = (HardwareCounters::Event)e;
+            if (hardware.read(event, value)) {
+                LOG_INFO << HardwareCounters::description(event) << ": " << value;
+                if (event == HardwareCounters::CYCLES) {
+                    cycles = value;
+                } else if (event == HardwareCounters::INSTRUCTIONS) {
+                    instructions = value;
+                }
+            }
+        }
+        if (cycles > 0 && instructions > 0) {
+            LOG_INFO << "instructions per cycle: " << (double)instructions / cycles;
+        }
+    }
+}
+
+
+HardwareCounters& HardwareCounters::instance() {
+    static HardwareCounters counters;
+    return counters;
+}
+
+HardwareCounters::HardwareCounters() {
+    for (int e = 0; e < EVENTS; e++) {
+        mFd[e] = -1;
+    }
+}
+
+HardwareCounters::~HardwareCounters() {
+    for (int e = 0; e < EVENTS; e++) {
+        if (mFd[e] >= 0) {
+            close(mFd[e]);
+        }
+    }
+}
+
+bool HardwareCounters::open() {
+    static const uint64_t configs[EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    for (int e = 0; e < EVENTS; e++) {
+        if (mFd[e] >= 0) {
+            continue;
+        }
+
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[e];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1;   // and the threads started later
+
+        // this process, any CPU, no group
+        mFd[e] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (mFd[e] < 0) {
+            LOG_DEBUG << "hardware counter " << metricName((Event)e) << " not available: " << strerror(errno);
+        }
+    }
+
+    return isOpen();
+}
+
+bool HardwareCounters::isOpen() const {
+    for (int e = 0; e < EVENTS; e++) {
+        if (mFd[e] >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HardwareCounters::read(Event event, uint64_t& value) const {
+    return mFd[event] >= 0 && ::read(mFd[event], &value, sizeof(value)) == (ssize_t)sizeof(value);
+}
+
+const char* HardwareCounters::metricName(Event event) {
+    switch (event) {
+    case CYCLES:        return "tsp_cpu_cycles_total";
+    case INSTRUCTIONS:  return "tsp_instructions_total";
+    case CACHE_MISSES:  return "tsp_cache_misses_total";
+    default:            return "tsp_branch_misses_total";
+    }
+}
+
+const char* HardwareCounters::description(Event event) {
+    switch (event) {
+    case CYCLES:        return "CPU cycles";
+    case INSTRUCTIONS:  return "Instructions retired";
+    case CACHE_MISSES:  return "Last level cache misses";
+    default:            return "Branch mispredictions";
+    }
+}
+
+
+MetricsExporter::MetricsExporter(const string& filename, double interval)
+    : mFilename(filename), mInterval(interval > 0 ? interval : 1), mFailed(false), mStop(false) {
+    if (!SolverMetrics::writeTextfile(mFilename)) {
+        throw runtime_error("cannot write the metrics file " + mFilename);
+    }
+    mThread = thread(&MetricsExporter::loop, this);
+}
+
+MetricsExporter::~MetricsExporter() {
+    {
+        lock_guard<mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWake.notify_one();
+    mThread.join();
+    write();
+}
+
+void MetricsExporter::loop() {
+    unique_lock<mutex> lock(mMutex);
+    while (!mWake.wait_for(lock, mInterval, [this]() { return mStop; })) {
+        write();
+    }
+}
+
+void MetricsExporter::write() {
+    if (!SolverMetrics::writeTextfile(mFilename) && !mFailed) {
+        mFailed = true;
+        LOG_WARN << "cannot write the metrics file " << mFilename;
+    }
+}
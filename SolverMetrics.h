@@ -0,0 +1,213 @@
+/**
+ * @file SolverMetrics.h
+ * @brief Counters and timers of the solver hot paths, Prometheus textfile exposition
+ *
+ */
+
+#ifndef SOLVERMETRICS_H
+#define SOLVERMETRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+
+/**
+ * What the searches spend their time on: moves evaluated, tabu rejections,
+ * aspiration overrides, improvements, moves applied, and the time spent scanning
+ * neighbourhoods and applying moves.
+ *
+ * Counting is compiled in with SOLVER_METRICS (make METRICS=1); otherwise add()
+ * and Timer are empty inline functions and the solvers compile to the same code
+ * as without them.
+ *
+ * Every thread counts into its own block, one cache line, written only by that
+ * thread with relaxed loads and stores: no lock, no atomic read-modify-write and
+ * no false sharing between the threads of a parallel run. total() sums the
+ * blocks of the live threads and the totals of the ended ones, from any thread.
+ */
+class SolverMetrics
+{
+public:
+
+    enum Counter {
+        MOVES_EVALUATED,        // neighbours whose cost variation was computed
+        TABU_REJECTED,          // improving or not, discarded because tabu
+        ASPIRATION_ACCEPTED,    // tabu, accepted by the aspiration criterion
+        IMPROVEMENTS,           // the best value of a search improved
+        MOVES_APPLIED,
+        NEIGHBORHOOD_NS,        // nanoseconds in the neighbourhood scans
+        APPLY_NS,               // nanoseconds applying moves
+        COUNTERS
+    };
+
+    static bool enabled() {
+#ifdef SOLVER_METRICS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static inline void add(Counter counter, uint64_t n = 1) {
+#ifdef SOLVER_METRICS
+        std::atomic<uint64_t>& value = threadBlock().value[counter];
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+#else
+        (void)counter;
+        (void)n;
+#endif
+    }
+
+    /** adds the nanoseconds of its scope to a time counter */
+    class Timer
+    {
+    public:
+#ifdef SOLVER_METRICS
+        explicit Timer(Counter counter) : mCounter(counter), mStart(std::chrono::steady_clock::now()) {}
+
+        ~Timer() {
+            add(mCounter, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now() - mStart).count());
+        }
+    private:
+        Counter mCounter;
+        std::chrono::steady_clock::time_point mStart;
+#else
+        explicit Timer(Counter) {}
+#endif
+    };
+
+    /** value of a counter, summed over every thread since the program started */
+    static uint64_t total(Counter counter);
+
+    /** @param totals (output) total() of every counter */
+    static void totals(uint64_t totals[COUNTERS]);
+
+    /** Prometheus name, e.g. tsp_moves_evaluated_total */
+    static const char* metricName(Counter counter);
+
+    static const char* description(Counter counter);
+
+    /**
+     * write every counter (and the hardware counters if open) in the Prometheus
+     * text format, into a temporary file renamed over filename, so that a reader
+     * (node_exporter textfile collector) never sees a partial file
+     * @return false if the file cannot be written
+     */
+    static bool writeTextfile(const std::string& filename);
+
+    /**
+     * log the counters and their rates
+     * @param seconds wall-clock time of the runs
+     */
+    static void printSummary(double seconds);
+
+private:
+
+    struct alignas(64) ThreadBlock {
+        std::atomic<uint64_t> value[COUNTERS];
+    };
+
+    struct ThreadHolder;
+
+    static inline ThreadBlock& threadBlock() {
+        ThreadBlock* block = sThreadBlock;
+        return (block != NULL) ? *block : registerThread();
+    }
+
+    static ThreadBlock& registerThread();
+
+    static thread_local ThreadBlock* sThreadBlock;
+};
+
+
+/**
+ * CPU cycles, instructions, cache and branch misses of the program (every thread
+ * started after open()), counted by the kernel with perf_event_open. Often not
+ * available: virtual machines, containers, kernel.perf_event_paranoid.
+ */
+class HardwareCounters
+{
+public:
+
+    enum Event {
+        CYCLES,
+        INSTRUCTIONS,
+        CACHE_MISSES,
+        BRANCH_MISSES,
+        EVENTS
+    };
+
+    /** process wide, closed at exit */
+    static HardwareCounters& instance();
+
+    /**
+     * start counting; the threads already running are not counted
+     * @return false if no event could be opened (the reason is logged at debug level)
+     */
+    bool open();
+
+    bool isOpen() const;
+
+    /**
+     * @param event its value since open()
+     * @return false if the event is not counted
+     */
+    bool read(Event event, uint64_t& value) const;
+
+    static const char* metricName(Event event);
+
+    static const char* description(Event event);
+
+    ~HardwareCounters();
+
+private:
+
+    HardwareCounters();
+    HardwareCounters(const HardwareCounters&);
+    HardwareCounters& operator=(const HardwareCounters&);
+
+    int mFd[EVENTS];    // -1: not counted
+};
+
+
+/**
+ * Rewrites the Prometheus textfile of SolverMetrics every interval seconds from
+ * a background thread, and a last time when destroyed.
+ */
+class MetricsExporter
+{
+public:
+
+    /**
+     * writes the file a first time
+     * @throw std::runtime_error if it cannot be written
+     */
+    MetricsExporter(const std::string& filename, double interval);
+
+    ~MetricsExporter();
+
+private:
+
+    MetricsExporter(const MetricsExporter&);
+    MetricsExporter& operator=(const MetricsExporter&);
+
+    void loop();
+
+    void write();
+
+    std::string mFilename;
+    std::chrono::duration<double> mInterval;
+    bool mFailed;   // a write failed, logged once
+
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    bool mStop;
+    std::thread mThread;
+};
+
+#endif /* SOLVERMETRICS_H */
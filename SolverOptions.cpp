@@ -0,0 +1,222 @@
+/**
+ * @file SolverOptions.cpp
+ * @brief Command line options describing a solver and its stop criteria
+ */
+
+#include "SolverOptions.h"
+
+#include <stdexcept>
+#include <cstdlib>
+
+#include "LocalSearchSolver.h"
+#include "TabuSearchSolver.h"
+#include "IslandTabuSearchSolver.h"
+#include "VNDSolver.h"
+#include "SimulatedAnnealingSolver.h"
+
+using namespace std;
+
+const char* const SolverOptions::SHORT_OPTIONS = "lfbtvSC:ae:i:s:w:N:k:qdu:I:M:R:n:";
+
+const struct option SolverOptions::LONG_OPTIONS[] = {
+    {"ls", no_argument, NULL, 'l'},             // Local Search
+    {"ts", no_argument, NULL, 't'},             // Tabu Search
+    {"vnd", no_argument, NULL, 'v'},            // Variable Neighborhood Descent
+    {"sa", no_argument, NULL, 'S'},             // Simulated Annealing
+    {"cooling", required_argument, NULL, 'C'},  // Cooling schedule for SA: geometric or adaptive
+
+    {"fi", no_argument, NULL, 'f'},             // First Improvement
+    {"bi", no_argument, NULL, 'b'},             // Best Improvement
+
+    {"ac", no_argument, NULL, 'a'},             // Aspiration Criteria
+
+    {"maxIter", required_argument, NULL, 'i'},  // Max iteration for TS
+    {"tenure", required_argument, NULL, 'e'},   // Tenure for TS
+    {"secs", required_argument, NULL, 's'},     // CPU seconds for TS and SA (and LS, VND if given)
+    {"wall", required_argument, NULL, 'w'},     // Wall-clock seconds of every run
+    {"stagnation", required_argument, NULL, 'N'},   // Stop after this many iterations without improvement
+
+    {"cand", required_argument, NULL, 'k'},     // Candidate list scan, k neighbours
+    {"quadrant", no_argument, NULL, 'q'},       // Quadrant candidate neighbours
+    {"dlb", no_argument, NULL, 'd'},            // Don't-look bits for LS
+    {"tour", required_argument, NULL, 'u'},     // Tour for LS --dlb: array, list or auto
+
+    {"islands", required_argument, NULL, 'I'},  // Parallel TS islands (0 = all cores)
+    {"migration", required_argument, NULL, 'M'},// Iterations between two migrations of the islands
+    {"restart", required_argument, NULL, 'R'},  // Migrations without improvement before an island restarts from the elite (0 = never)
+    {"init", required_argument, NULL, 'n'},     // Initial tour: random, nn, greedy, sfc, cheapest, farthest
+    {0, 0, 0, 0}
+};
+
+SolverOptions::SolverOptions()
+    : localSearch(true), vnd(false), annealing(false), adaptiveCooling(false),
+      bestImprove(true), aspCriteria(false), dontLookBits(false), tourType(Tour::AUTO),
+      seconds(30), tenure(50), maxIterations(1000),
+      secondsGiven(false), iterationsGiven(false), wallSeconds(0), stagnation(0),
+      islands(1), migrationInterval(100), restartAfter(2),
+      initMethod(TourConstruction::RANDOM),
+      candidates(0), quadrant(false) {}
+
+bool SolverOptions::parse(int c, const char* arg) {
+    switch(c) {
+        case 'l': {
+            localSearch = true;
+            break;
+        }
+        case 't': {
+            localSearch = false;
+            break;
+        }
+        case 'v': {
+            vnd = true;
+            break;
+        }
+        case 'S': {
+            annealing = true;
+            break;
+        }
+        case 'C': {
+            string cooling(arg);
+            if (cooling == "geometric") {
+                adaptiveCooling = false;
+            } else if (cooling == "adaptive") {
+                adaptiveCooling = true;
+            } else {
+                throw runtime_error("unknown cooling '" + cooling + "' (geometric or adaptive)");
+            }
+            break;
+        }
+        case 'b': {
+            bestImprove = true;
+            break;
+        }
+        case 'f': {
+            bestImprove = false;
+            break;
+        }
+        case 'a': {
+            aspCriteria = true;
+            break;
+        }
+        case 'e': {
+            tenure = strtol(arg, NULL, 0);
+            break;
+        }
+        case 'i': {
+            maxIterations = (int)strtol(arg, NULL, 0);
+            iterationsGiven = true;
+            break;
+        }
+        case 's': {
+            seconds = (int)strtol(arg, NULL, 0);
+            secondsGiven = true;
+            break;
+        }
+        case 'w': {
+            wallSeconds = strtod(arg, NULL);
+            break;
+        }
+        case 'N': {
+            stagnation = strtol(arg, NULL, 0);
+            break;
+        }
+        case 'k': {
+            candidates = (int)strtol(arg, NULL, 0);
+            break;
+        }
+        case 'q': {
+            quadrant = true;
+            break;
+        }
+        case 'd': {
+            dontLookBits = true;
+            break;
+        }
+        case 'u': {
+            string type(arg);
+            if (type == "array") {
+                tourType = Tour::ARRAY;
+            } else if (type == "list") {
+                tourType = Tour::TWO_LEVEL;
+            } else if (type == "auto") {
+                tourType = Tour::AUTO;
+            } else {
+                throw runtime_error("unknown tour '" + type + "' (array, list or auto)");
+            }
+            break;
+        }
+        case 'I': {
+            islands = (int)strtol(arg, NULL, 0);
+            break;
+        }
+        case 'M': {
+            migrationInterval = (int)strtol(arg, NULL, 0);
+            break;
+        }
+        case 'R': {
+            restartAfter = (int)strtol(arg, NULL, 0);
+            break;
+        }
+        case 'n': {
+            initMethod = TourConstruction::parseMethod(arg);
+            break;
+        }
+        default:
+            return false;
+    }
+    return true;
+}
+
+void SolverOptions::parse(const vector<string>& args) {
+    // getopt_long wants a main-like argv
+    vector<char*> argv;
+    argv.push_back(const_cast<char*>("solver"));
+    for (size_t i = 0; i < args.size(); i++) {
+        argv.push_back(const_cast<char*>(args[i].c_str()));
+    }
+    argv.push_back(NULL);
+
+    // '+': stop at the first non option, ':' report missing arguments, 0: restart the scan
+    const string shortOptions = string("+:") + SHORT_OPTIONS;
+    opterr = 0;
+    optind = 0;
+
+    int c;
+    int option_index;
+    while ((c = getopt_long(argv.size() - 1, &argv[0], shortOptions.c_str(), LONG_OPTIONS, &option_index)) != EOF) {
+        if (c == '?' || c == ':' || !parse(c, optarg)) {
+            throw runtime_error("bad solver option '" + string(argv[optind - 1]) + "'");
+        }
+    }
+    if (optind < (int)argv.size() - 1) {
+        throw runtime_error("unexpected argument '" + string(argv[optind]) + "'");
+    }
+    opterr = 1;
+}
+
+Solver* SolverOptions::buildSolver(unsigned long seed) const {
+    Solver* solver;
+    if (annealing) {
+        CoolingSchedule* cooling = adaptiveCooling ? (CoolingSchedule*)new AdaptiveCooling() : new GeometricCooling();
+        solver = new SimulatedAnnealingSolver(seconds, cooling, seed);
+    } else if (vnd) {
+        solver = new VNDSolver(candidates > 0);
+    } else if (localSearch) {
+        solver = new LocalSearchSolver(bestImprove, candidates > 0, dontLookBits, tourType);
+    } else if (islands != 1) { // parallel tabu search
+        TabuSearchSolver island(tenure, maxIterations, aspCriteria, bestImprove, seconds, candidates > 0);
+        solver = new IslandTabuSearchSolver(islands, island, migrationInterval, restartAfter);
+    } else { // tabu search
+        solver = new TabuSearchSolver(tenure, maxIterations, aspCriteria, bestImprove, seconds, candidates > 0);
+    }
+
+    StopCriteria& stop = solver->stopCriteria();
+    stop.setTimeLimit(wallSeconds).setStagnationLimit(stagnation);
+    if (secondsGiven) {
+        stop.setCpuTimeLimit(seconds);
+    }
+    if (iterationsGiven) {
+        stop.setIterationLimit(maxIterations);
+    }
+    return solver;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file SolverOptions.h
+ * @brief Command line options describing a solver and its stop criteria
+ *
+ */
+
+#ifndef SOLVEROPTIONS_H
+#define SOLVEROPTIONS_H
+
+#include <string>
+#include <vector>
+
+#include <getopt.h>
+
+#include "solver.h"
+#include "Tour.h"
+#include "TourConstruction.h"
+
+/**
+ * The solver options of the command line (--ts, --tenure, --secs, ...), shared
+ * by main and the benchmark runner, whose configs use the same flags.
+ *
+ * A program adds SHORT_OPTIONS and LONG_OPTIONS to its own getopt_long options
+ * and hands every option to parse() first.
+ */
+class SolverOptions
+{
+public:
+
+    static const char* const SHORT_OPTIONS;
+
+    /** terminated by an all-zero entry */
+    static const struct option LONG_OPTIONS[];
+
+    // Solver    default = LocalSearch
+    bool localSearch;
+    bool vnd;
+    bool annealing;
+    bool adaptiveCooling;   // only for SimulatedAnnealing
+
+    // Solvers features     default = BI
+    bool bestImprove;
+    bool aspCriteria;       // only for TabuSearch
+    bool dontLookBits;      // only for LocalSearch
+    Tour::Type tourType;    // only for LocalSearch with don't-look bits
+
+    // Tabu options
+    int seconds;
+    int tenure;
+    int maxIterations;
+
+    // Stop criteria   -s and -i are always used by TS (and -s by SA), by the others only if given
+    bool secondsGiven;
+    bool iterationsGiven;
+    double wallSeconds;     // 0 = none
+    long stagnation;        // 0 = none
+
+    // Island TS options   default = a single search
+    int islands;
+    int migrationInterval;
+    int restartAfter;
+
+    // Initial tour     default = random permutation
+    TourConstruction::Method initMethod;
+
+    // Candidate lists     default = full neighbourhood
+    int candidates;
+    bool quadrant;
+
+    SolverOptions();
+
+    /**
+     * @param c option returned by getopt_long
+     * @param arg its argument (optarg)
+     * @return false if c is not a solver option
+     * @throw std::runtime_error on a bad argument
+     */
+    bool parse(int c, const char* arg);
+
+    /**
+     * parse a whole list of solver options, e.g. "--ts --tenure 50"
+     * @throw std::runtime_error on an unknown option or a bad argument
+     */
+    void parse(const std::vector<std::string>& args);
+
+    /**
+     * a new solver with its stop criteria (the candidate lists, if any, must be
+     * built on the instance before it solves)
+     * @param seed random generator seed of the randomized solvers (SimulatedAnnealing)
+     */
+    Solver* buildSolver(unsigned long seed = 1) const;
+};
+
+#endif /* SOLVEROPTIONS_H */
@@ -0,0 +1,126 @@
+/**
+ * @file Statistics.cpp
+ * @brief Summary statistics, confidence intervals and Welch's t-test of repeated runs
+ */
+
+#include "Statistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+// continued fraction of the regularized incomplete beta function (modified Lentz)
+double betaFraction(double a, double b, double x) {
+    const double TINY = 1e-300;
+    double c = 1;
+    double d = 1 - (a + b) * x / (a + 1);
+    d = 1 / (fabs(d) < TINY ? TINY : d);
+    double h = d;
+
+    for (int m = 1; m <= 300; m++) {
+        double m2 = 2 * m;
+        double term = m * (b - m) * x / ((a + m2 - 1) * (a + m2));
+        d = 1 + term * d;
+        c = 1 + term / c;
+        d = 1 / (fabs(d) < TINY ? TINY : d);
+        c = (fabs(c) < TINY ? TINY : c);
+        h *= d * c;
+
+        term = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1));
+        d = 1 + term * d;
+        c = 1 + term / c;
+        d = 1 / (fabs(d) < TINY ? TINY : d);
+        c = (fabs(c) < TINY ? TINY : c);
+        double delta = d * c;
+        h *= delta;
+        if (fabs(delta - 1) < 1e-14) {
+            break;
+        }
+    }
+    return h;
+}
+
+// I_x(a, b)
+double incompleteBeta(double a, double b, double x) {
+    if (x <= 0) {
+        return 0;
+    }
+    if (x >= 1) {
+        return 1;
+    }
+    double front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1 - x));
+    if (x < (a + 1) / (a + b + 2)) {
+        return front * betaFraction(a, b, x) / a;
+    }
+    return 1 - front * betaFraction(b, a, 1 - x) / b;
+}
+
+}
+
+
+Statistics::Statistics(vector<double> values) : n(values.size()), mean(0), median(0), min(0), max(0), sd(0) {
+    if (n == 0) {
+        return;
+    }
+    sort(values.begin(), values.end());
+    min = values.front();
+    max = values.back();
+    median = (values[(n - 1) / 2] + values[n / 2]) / 2;
+
+    for (int i = 0; i < n; i++) {
+        mean += values[i];
+    }
+    mean /= n;
+
+    if (n > 1) {
+        double squares = 0;
+        for (int i = 0; i < n; i++) {
+            squares += (values[i] - mean) * (values[i] - mean);
+        }
+        sd = sqrt(squares / (n - 1));
+    }
+}
+
+double Statistics::confidenceHalfWidth(double confidence) const {
+    if (n < 2) {
+        return 0;
+    }
+    return studentQuantile(1 - (1 - confidence) / 2, n - 1) * sd / sqrt((double)n);
+}
+
+double Statistics::pGreater(const Statistics& a, const Statistics& b) {
+    double va = (a.n > 0) ? a.sd * a.sd / a.n : 0;
+    double vb = (b.n > 0) ? b.sd * b.sd / b.n : 0;
+    double se = sqrt(va + vb);
+
+    if (se == 0 || a.n < 2 || b.n < 2) {
+        return (a.mean > b.mean) ? 0 : 1;
+    }
+
+    // Welch-Satterthwaite degrees of freedom
+    double df = (va + vb) * (va + vb) / (va * va / (a.n - 1) + vb * vb / (b.n - 1));
+    double t = (a.mean - b.mean) / se;
+    return 1 - studentCdf(t, df);
+}
+
+double Statistics::studentCdf(double t, double df) {
+    double tail = 0.5 * incompleteBeta(df / 2, 0.5, df / (df + t * t));
+    return (t > 0) ? 1 - tail : tail;
+}
+
+double Statistics::studentQuantile(double p, double df) {
+    // the cdf is increasing: bisection
+    double low = -1e3, high = 1e3;
+    for (int k = 0; k < 200 && high - low > 1e-10; k++) {
+        double mid = (low + high) / 2;
+        if (studentCdf(mid, df) < p) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    return (low + high) / 2;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file Statistics.h
+ * @brief Summary statistics, confidence intervals and Welch's t-test of repeated runs
+ *
+ */
+
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <vector>
+
+/**
+ * Mean, median, extremes and sample standard deviation of a sample (the values
+ * of the runs of a benchmark cell), with the Student t tools to compare two of them.
+ */
+class Statistics
+{
+public:
+
+    int n;
+    double mean;
+    double median;
+    double min;
+    double max;
+    double sd;      // sample standard deviation, 0 below 2 values
+
+    Statistics() : n(0), mean(0), median(0), min(0), max(0), sd(0) {}
+
+    explicit Statistics(std::vector<double> values);
+
+    /**
+     * half width of the confidence interval of the mean, mean +- t s / sqrt(n)
+     * @param confidence e.g. 0.95
+     */
+    double confidenceHalfWidth(double confidence = 0.95) const;
+
+    /**
+     * Welch's t-test, one-sided
+     * @return p-value of "the mean of a is greater than the mean of b"; without
+     *         variance (single or identical runs) 0 if a.mean > b.mean, else 1
+     */
+    static double pGreater(const Statistics& a, const Statistics& b);
+
+    /** P(T <= t) for Student's t with df degrees of freedom */
+    static double studentCdf(double t, double df);
+
+    /** t such that P(T <= t) = p */
+    static double studentQuantile(double p, double df);
+};
+
+#endif /* STATISTICS_H */
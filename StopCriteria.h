@@ -0,0 +1,293 @@
+/**
+ * @file StopCriteria.h
+ * @brief When a search stops: time, iterations, stagnation, target value, cancellation
+ *
+ */
+
+#ifndef STOPCRITERIA_H
+#define STOPCRITERIA_H
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+
+#include "CpuTime.h"
+#include "ConvergenceTrace.h"
+
+/**
+ * Flag shared between a controller (signal handler, another thread) and the
+ * searches it may cancel; cancel() is a single atomic store.
+ */
+class CancellationToken
+{
+public:
+
+    CancellationToken() : mCancelled(false) {}
+
+    void cancel() {
+        mCancelled.store(true, std::memory_order_relaxed);
+    }
+
+    void reset() {
+        mCancelled.store(false, std::memory_order_relaxed);
+    }
+
+    inline bool cancelled() const {
+        return mCancelled.load(std::memory_order_relaxed);
+    }
+
+private:
+
+    CancellationToken(const CancellationToken&);
+    CancellationToken& operator=(const CancellationToken&);
+
+    std::atomic<bool> mCancelled;
+};
+
+
+/**
+ * Stop criteria of a search, any combination of:
+ *
+ *  TIME_LIMIT       wall-clock seconds since start(), steady (monotonic) clock
+ *  CPU_TIME_LIMIT   CPU seconds of the calling thread since start(), right when
+ *                   other runs execute at the same time
+ *  ITERATION_LIMIT  iterations of the solver (its own unit: TS iterations, applied
+ *                   moves, SA epochs)
+ *  STAGNATION       iterations since the best value last improved
+ *  TARGET_VALUE     a tour of this value or better was found
+ *  CANCELLED        the CancellationToken was cancelled
+ *
+ * A solver calls start() once, then stop(iteration, bestValue) in its loop. The
+ * counters are compared on every call; the clocks and the token are read only
+ * every `stride` calls, the stride doubling while two readings are less than
+ * CHECK_PERIOD apart and halving when they are more than 4 CHECK_PERIOD apart, so
+ * the check costs a few compares whether an iteration takes nanoseconds or seconds.
+ *
+ * reason() tells which criterion fired; CONVERGED means none did and the search
+ * ended by itself (local optimum, frozen, no legal move).
+ *
+ * With a ConvergenceTrace (setTrace()), stop() records every improvement of the
+ * best value with its wall-clock time: a clock reading per improvement, none else.
+ */
+class StopCriteria
+{
+public:
+
+    enum Reason {
+        CONVERGED,
+        TIME_LIMIT,
+        CPU_TIME_LIMIT,
+        ITERATION_LIMIT,
+        STAGNATION,
+        TARGET_VALUE,
+        CANCELLED
+    };
+
+    static constexpr double CHECK_PERIOD = 0.001;  // seconds between two clock readings
+    static const long MAX_STRIDE = 1L << 20;
+
+    StopCriteria()
+        : mTimeLimit(HUGE_VAL), mCpuTimeLimit(HUGE_VAL), mIterationLimit(NO_LIMIT), mStagnationLimit(NO_LIMIT),
+          mTargetValue(-HUGE_VAL), mCancellation(NULL), mTrace(NULL) {
+        start();
+    }
+
+    static const char* reasonName(Reason reason) {
+        switch (reason) {
+        case TIME_LIMIT:      return "time limit";
+        case CPU_TIME_LIMIT:  return "CPU time limit";
+        case ITERATION_LIMIT: return "iteration limit";
+        case STAGNATION:      return "stagnation";
+        case TARGET_VALUE:    return "target value";
+        case CANCELLED:       return "cancelled";
+        default:              return "converged";
+        }
+    }
+
+    /** @param seconds wall-clock budget, <= 0 = none */
+    StopCriteria& setTimeLimit(double seconds) {
+        mTimeLimit = (seconds > 0) ? seconds : HUGE_VAL;
+        return *this;
+    }
+
+    /** @param seconds CPU budget of the searching thread, <= 0 = none */
+    StopCriteria& setCpuTimeLimit(double seconds) {
+        mCpuTimeLimit = (seconds > 0) ? seconds : HUGE_VAL;
+        return *this;
+    }
+
+    /** @param iterations <= 0 = none */
+    StopCriteria& setIterationLimit(long iterations) {
+        mIterationLimit = (iterations > 0) ? iterations : NO_LIMIT;
+        return *this;
+    }
+
+    /** @param iterations iterations without improvement of the best value, <= 0 = none */
+    StopCriteria& setStagnationLimit(long iterations) {
+        mStagnationLimit = (iterations > 0) ? iterations : NO_LIMIT;
+        return *this;
+    }
+
+    StopCriteria& setTargetValue(double value) {
+        mTargetValue = value;
+        return *this;
+    }
+
+    /** @param token not owned, NULL = none */
+    StopCriteria& setCancellation(const CancellationToken* token) {
+        mCancellation = token;
+        return *this;
+    }
+
+    /** @param trace not owned, NULL = none; a copy of the criteria records into the same trace */
+    StopCriteria& setTrace(ConvergenceTrace* trace) {
+        mTrace = trace;
+        return *this;
+    }
+
+    ConvergenceTrace* trace() const {
+        return mTrace;
+    }
+
+    double timeLimit() const {
+        return mTimeLimit;
+    }
+
+    double cpuTimeLimit() const {
+        return mCpuTimeLimit;
+    }
+
+    /** LONG_MAX if none */
+    long iterationLimit() const {
+        return mIterationLimit;
+    }
+
+    double targetValue() const {
+        return mTargetValue;
+    }
+
+    /** start the clocks and clear the counters and the reason */
+    void start() {
+        mReason = CONVERGED;
+        mBestValue = HUGE_VAL;
+        mLastImprovement = 0;
+        mStride = 1;
+        mCountdown = 1;
+        mStartWall = wallTime();
+        mLastCheck = mStartWall;
+        mStartCpu = threadCpuTime();
+        if (mTrace != NULL) {
+            mTrace->clear();
+        }
+    }
+
+    /**
+     * @param iteration current iteration, increasing
+     * @param bestValue best value found so far
+     * @return true if the search must stop, see reason()
+     */
+    inline bool stop(long iteration, double bestValue) {
+        if (bestValue < mBestValue) {
+            mBestValue = bestValue;
+            mLastImprovement = iteration;
+            if (mTrace != NULL) {
+                mTrace->record(wallSeconds(), iteration, bestValue);
+            }
+        }
+        if (bestValue <= mTargetValue) {
+            return stopBy(TARGET_VALUE);
+        }
+        if (iteration >= mIterationLimit) {
+            return stopBy(ITERATION_LIMIT);
+        }
+        if (iteration - mLastImprovement >= mStagnationLimit) {
+            return stopBy(STAGNATION);
+        }
+        if (--mCountdown > 0) {
+            return false;
+        }
+        return checkClocks();
+    }
+
+    /** for a check at an improvement, inside loops that call stop() less often */
+    inline bool targetReached(double bestValue) {
+        return bestValue <= mTargetValue && stopBy(TARGET_VALUE);
+    }
+
+    /** record why the search stopped, @return true */
+    bool stopBy(Reason reason) {
+        mReason = reason;
+        return true;
+    }
+
+    Reason reason() const {
+        return mReason;
+    }
+
+    const char* reasonName() const {
+        return reasonName(mReason);
+    }
+
+    /** wall-clock seconds since start() */
+    double wallSeconds() const {
+        return wallTime() - mStartWall;
+    }
+
+    /** CPU seconds since start() */
+    double cpuSeconds() const {
+        return threadCpuTime() - mStartCpu;
+    }
+
+private:
+
+    static const long NO_LIMIT = LONG_MAX;
+
+    static double wallTime() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool checkClocks() {
+        if (mCancellation != NULL && mCancellation->cancelled()) {
+            return stopBy(CANCELLED);
+        }
+
+        double now = wallTime();
+        if (now - mLastCheck < CHECK_PERIOD) {
+            mStride = (mStride < MAX_STRIDE) ? 2 * mStride : MAX_STRIDE;
+        } else if (now - mLastCheck > 4 * CHECK_PERIOD && mStride > 1) {
+            mStride /= 2;
+        }
+        mLastCheck = now;
+        mCountdown = mStride;
+
+        if (now - mStartWall >= mTimeLimit) {
+            return stopBy(TIME_LIMIT);
+        }
+        if (mCpuTimeLimit < HUGE_VAL && threadCpuTime() - mStartCpu >= mCpuTimeLimit) {
+            return stopBy(CPU_TIME_LIMIT);
+        }
+        return false;
+    }
+
+    // configuration
+    double mTimeLimit;
+    double mCpuTimeLimit;
+    long mIterationLimit;
+    long mStagnationLimit;
+    double mTargetValue;
+    const CancellationToken* mCancellation;
+    ConvergenceTrace* mTrace;
+
+    // state of the current search
+    Reason mReason;
+    double mBestValue;
+    long mLastImprovement;
+    long mStride;
+    long mCountdown;
+    double mStartWall;
+    double mLastCheck;
+    double mStartCpu;
+};
+
+#endif /* STOPCRITERIA_H */
@@ -0,0 +1,41 @@
+/**
+ * @file TSP.cpp
+ * @brief TSP data loading
+ */
+
+#include "TSP.h"
+#include "TSPBinary.h"
+#include "TSPTextParser.h"
+#include "CandidateLists.h"
+
+#include <cctype>
+
+// text matrices start with the number of nodes, TSPLIB files with a keyword
+static bool isTSPLIBFile(const char* filename) {
+    std::ifstream in(filename);
+    char c = 0;
+    while (in.get(c) && isspace((unsigned char)c)) {
+    }
+    return in && isalpha((unsigned char)c);
+}
+
+void TSP::readFromFile(const char* filename) {
+    if (TSPBinary::isBinaryFile(filename)) {
+        TSPBinary::map(filename, *this);
+    } else if (isTSPLIBFile(filename)) {
+        adoptCoordinates(std::shared_ptr<const TSPCoordinates>(TSPCoordinates::readTSPLIB(filename)));
+    } else {
+        readTextFile(filename);
+    }
+}
+
+void TSP::readTextFile(const char* filename) {
+    TSPTextParser parser(filename);
+    parser.parse(*this);
+
+    detectSymmetry();
+}
+
+void TSP::buildCandidateLists(int k, bool quadrant) {
+    mCandidates.reset(new CandidateLists(*this, k, quadrant));
+}
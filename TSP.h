@@ -12,44 +12,205 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <memory>
+
+#include "AlignedAllocator.h"
+#include "TSPCoordinates.h"
+
+class MappedFile;
+class CandidateLists;
 
 /**
  * Class that describes a TSP instance (a cost matrix, nodes are identified by integer 0 ... n-1)
+ *
+ * The matrix is stored in a single row-major buffer: row i starts at i * stride()
+ * and every row begins on a 64-byte (cache line) boundary. The buffer is either
+ * owned by the instance or a read-only mapping of a binary instance file.
+ *
+ * Coordinate instances keep no matrix at all: cost() computes the distance on
+ * demand, and code that scans whole rows goes through a RowCache.
  */
 class TSP
 {
 public:
 
-    int n;
+    static const int ALIGNMENT = 64;
 
-    std::vector< std::vector<double> > cost;
+    int n;
 
     double infinite; // infinite value (an upper bound on the value of any feasible solution
 
 
 
-    TSP() : n(0) , infinite(1e10) {}
+    TSP() : n(0) , infinite(1e10), mStride(0), mSymmetric(true), mData(NULL) {}
 
-    void readFromFile(const char* filename) {
-        std::ifstream in(filename);
+    TSP(const TSP& other)
+        : n(other.n), infinite(other.infinite), mStride(other.mStride), mSymmetric(other.mSymmetric),
+          mCost(other.mCost), mMapping(other.mMapping), mCoordinates(other.mCoordinates),
+          mCandidates(other.mCandidates) {
+        mData = other.hasMatrix() ? (mMapping ? other.mData : mCost.data()) : NULL;
+    }
 
-        in >> n;
-        std::cout << "read from file, num nodes = " << n << std::endl;
+    TSP& operator=(const TSP& right) {
+        if (this != &right) {
+            n = right.n;
+            infinite = right.infinite;
+            mStride = right.mStride;
+            mSymmetric = right.mSymmetric;
+            mCost = right.mCost;
+            mMapping = right.mMapping;
+            mCoordinates = right.mCoordinates;
+            mCandidates = right.mCandidates;
+            mData = right.hasMatrix() ? (mMapping ? right.mData : mCost.data()) : NULL;
+        }
+        return *this;
+    }
+
+    /**
+     * allocate a zero-filled n x n matrix
+     * @param nodes number of nodes
+     */
+    void resize(int nodes) {
+        n = nodes;
+
+        // pad each row up to a whole number of cache lines
+        const int perLine = ALIGNMENT / sizeof(double);
+        mStride = (n + perLine - 1) / perLine * perLine;
+
+        mMapping.reset();
+        mCoordinates.reset();
+        mCandidates.reset();
+        mCost.assign((size_t)n * mStride, 0.0);
+        mData = mCost.data();
+        mSymmetric = true;
+    }
 
-        cost.resize(n);
-        for (int i = 0; i < n; i++) {
+    /**
+     * load an instance, the format (binary, text matrix or TSPLIB coordinates) is detected from the file content
+     * @param filename instance file
+     */
+    void readFromFile(const char* filename);
+
+    /**
+     * parse a text instance: n followed by the n x n matrix
+     */
+    void readTextFile(const char* filename);
+
+    /**
+     * use a read-only mapped matrix in place (see TSPBinary)
+     */
+    void adoptMapping(const std::shared_ptr<MappedFile>& mapping, const double* data,
+                      int nodes, int stride, bool symmetric) {
+        n = nodes;
+        mStride = stride;
+        mSymmetric = symmetric;
+        mCost.clear();
+        mCoordinates.reset();
+        mCandidates.reset();
+        mMapping = mapping;
+        mData = data;
+    }
 
-            cost[i].reserve(n);
+    /**
+     * switch to a coordinate instance, distances are computed on demand
+     */
+    void adoptCoordinates(const std::shared_ptr<const TSPCoordinates>& coordinates) {
+        n = coordinates->size();
+        mStride = 0;
+        mSymmetric = true;
+        mCost.clear();
+        mCost.shrink_to_fit();
+        mMapping.reset();
+        mCandidates.reset();
+        mCoordinates = coordinates;
+        mData = NULL;
+    }
 
-            for (int j = 0; j < n; j++) {
-                double c;
-                in >> c;
-                cost[i].push_back(c);
-            }
+    /** cost of arc (i, j) */
+    inline double cost(int i, int j) const {
+        if (mData != NULL) {
+            return mData[(size_t)i * mStride + j];
         }
+        return mCoordinates->distance(i, j);
+    }
+
+    /** false for coordinate instances: there is no matrix, row() must not be used */
+    inline bool hasMatrix() const {
+        return mData != NULL;
+    }
+
+    /** NULL for matrix instances */
+    inline const TSPCoordinates* coordinates() const {
+        return mCoordinates.get();
+    }
+
+    /**
+     * build the candidate neighbour lists used by the candidate 2-opt scans (see CandidateLists)
+     * @param k number of candidates per node
+     * @param quadrant use quadrant neighbours (planar coordinate instances only)
+     */
+    void buildCandidateLists(int k, bool quadrant = false);
+
+    /** NULL until buildCandidateLists() */
+    inline const CandidateLists* candidates() const {
+        return mCandidates.get();
+    }
 
-        in.close();
+    /** only for owned (non mapped) matrices */
+    inline void setCost(int i, int j, double c) {
+        mCost[(size_t)i * mStride + j] = c;
     }
+
+    /** first element of row i (aligned), the row holds n valid entries. Only for matrix instances */
+    inline const double* row(int i) const {
+        return mData + (size_t)i * mStride;
+    }
+
+    /** only for owned (non mapped) matrices */
+    inline double* row(int i) {
+        return &mCost[(size_t)i * mStride];
+    }
+
+    /** distance, in elements, between the starts of two consecutive rows */
+    inline int stride() const {
+        return mStride;
+    }
+
+    inline bool isSymmetric() const {
+        return mSymmetric;
+    }
+
+    /** recompute the symmetry flag from the matrix content */
+    void detectSymmetry() {
+        mSymmetric = true;
+        if (!hasMatrix()) {
+            return;
+        }
+        for (int i = 0; i < n && mSymmetric; i++) {
+            for (int j = i + 1; j < n; j++) {
+                if (cost(i, j) != cost(j, i)) {
+                    mSymmetric = false;
+                    break;
+                }
+            }
+        }
+    }
+
+private:
+
+    int mStride;
+
+    bool mSymmetric;
+
+    std::vector< double, AlignedAllocator<double, ALIGNMENT> > mCost;
+
+    std::shared_ptr<MappedFile> mMapping;
+
+    std::shared_ptr<const TSPCoordinates> mCoordinates;
+
+    std::shared_ptr<const CandidateLists> mCandidates;
+
+    const double* mData;    // mCost.data(), the mapped payload or NULL for coordinates
 };
 
 #endif /* TSP_H */
@@ -0,0 +1,160 @@
+/**
+ * @file TSPBinary.cpp
+ * @brief Binary, memory-mappable TSP instance format
+ */
+
+#include "TSPBinary.h"
+
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+#include <climits>
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "TSP.h"
+#include "Logger.h"
+
+using namespace std;
+
+static const char MAGIC[8] = { 'T', 'S', 'P', 'B', 'I', 'N', 0, 0 };
+
+static_assert(sizeof(TSPBinary::Header) == TSP::ALIGNMENT, "header must fill exactly one cache line");
+
+
+MappedFile::MappedFile(const char* filename) : mData(NULL), mSize(0)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error(string("cannot open ") + filename);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        throw runtime_error(string("cannot stat ") + filename);
+    }
+    mSize = st.st_size;
+
+    void* addr = mmap(NULL, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (addr == MAP_FAILED) {
+        throw runtime_error(string("cannot mmap ") + filename);
+    }
+    mData = static_cast<unsigned char*>(addr);
+}
+
+MappedFile::~MappedFile()
+{
+    if (mData != NULL) {
+        munmap(mData, mSize);
+    }
+}
+
+
+bool TSPBinary::isBinaryFile(const char* filename) {
+    char magic[sizeof(MAGIC)];
+
+    FILE* f = fopen(filename, "rb");
+    if (f == NULL) {
+        return false;
+    }
+    size_t got = fread(magic, 1, sizeof(magic), f);
+    fclose(f);
+
+    return got == sizeof(magic) && memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+void TSPBinary::map(const char* filename, TSP& tsp) {
+    shared_ptr<MappedFile> file(new MappedFile(filename));
+
+    if (file->size() < sizeof(Header)) {
+        throw runtime_error(string(filename) + ": truncated header");
+    }
+
+    Header header;
+    memcpy(&header, file->data(), sizeof(Header));
+
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw runtime_error(string(filename) + ": not a binary TSP instance");
+    }
+    if (header.version != VERSION) {
+        throw runtime_error(string(filename) + ": unsupported format version");
+    }
+    if (header.costType != COST_FLOAT64) {
+        throw runtime_error(string(filename) + ": unsupported cost type");
+    }
+    if (header.n <= 0 || header.stride < header.n || header.stride > INT_MAX
+        || header.dataOffset < sizeof(Header) || header.dataOffset % TSP::ALIGNMENT != 0) {
+        throw runtime_error(string(filename) + ": inconsistent header");
+    }
+
+    // the sizes come from the file: no overflow before the comparison with its size
+    if ((size_t)header.n > SIZE_MAX / (size_t)header.stride) {
+        throw runtime_error(string(filename) + ": inconsistent header");
+    }
+    size_t count = (size_t)header.n * header.stride;
+    if (count > (SIZE_MAX - header.dataOffset) / sizeof(double)
+        || file->size() < header.dataOffset + count * sizeof(double)) {
+        throw runtime_error(string(filename) + ": truncated matrix");
+    }
+
+    const double* data = reinterpret_cast<const double*>(file->data() + header.dataOffset);
+
+    if (checksum(data, count) != header.checksum) {
+        throw runtime_error(string(filename) + ": checksum mismatch");
+    }
+
+    LOG_INFO << "mapped binary file, num nodes = " << header.n;
+
+    tsp.adoptMapping(file, data, header.n, header.stride, (header.flags & FLAG_SYMMETRIC) != 0);
+}
+
+void TSPBinary::write(const TSP& tsp, const char* filename) {
+    if (!tsp.hasMatrix()) {
+        throw runtime_error("only matrix instances can be written in the binary format");
+    }
+
+    size_t count = (size_t)tsp.n * tsp.stride();
+
+    Header header;
+    memset(&header, 0, sizeof(Header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.costType = COST_FLOAT64;
+    header.n = tsp.n;
+    header.stride = tsp.stride();
+    header.flags = tsp.isSymmetric() ? FLAG_SYMMETRIC : 0;
+    header.dataOffset = sizeof(Header);
+    header.checksum = checksum(tsp.row(0), count);
+
+    FILE* f = fopen(filename, "wb");
+    if (f == NULL) {
+        throw runtime_error(string("cannot create ") + filename);
+    }
+
+    bool ok = fwrite(&header, sizeof(Header), 1, f) == 1
+              && fwrite(tsp.row(0), sizeof(double), count, f) == count;
+
+    if (fclose(f) != 0 || !ok) {
+        throw runtime_error(string("error writing ") + filename);
+    }
+}
+
+uint64_t TSPBinary::checksum(const double* data, size_t count) {
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (size_t k = 0; k < count; ++k) {
+        uint64_t word;
+        memcpy(&word, &data[k], sizeof(word));
+
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file TSPBinary.h
+ * @brief Binary, memory-mappable TSP instance format
+ *
+ * Layout (native byte order, little-endian on every machine we run on):
+ *
+ *   offset  0  char[8]  magic "TSPBIN\0\0"
+ *   offset  8  uint32   format version
+ *   offset 12  uint32   cost type (COST_FLOAT64 is the only one defined)
+ *   offset 16  int64    n, number of nodes
+ *   offset 24  int64    stride, doubles between the starts of two rows
+ *   offset 32  uint32   flags (FLAG_SYMMETRIC)
+ *   offset 36  uint32   data offset in bytes (multiple of 64)
+ *   offset 40  uint64   checksum of the n * stride payload doubles
+ *   offset 48  char[16] reserved, zero
+ *
+ * The payload is the row-major matrix exactly as TSP keeps it in memory
+ * (rows padded to stride), so a mapped file is used in place.
+ */
+
+#ifndef TSPBINARY_H
+#define TSPBINARY_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+
+class TSP;
+
+/**
+ * Read-only memory mapping of a whole file, unmapped on destruction
+ */
+class MappedFile
+{
+public:
+    explicit MappedFile(const char* filename);
+    ~MappedFile();
+
+    const unsigned char* data() const { return mData; }
+    size_t size() const { return mSize; }
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    unsigned char* mData;
+    size_t mSize;
+};
+
+
+class TSPBinary
+{
+public:
+
+    static const uint32_t VERSION = 1;
+
+    static const uint32_t COST_FLOAT64 = 0;
+
+    static const uint32_t FLAG_SYMMETRIC = 1;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t costType;
+        int64_t n;
+        int64_t stride;
+        uint32_t flags;
+        uint32_t dataOffset;
+        uint64_t checksum;
+        char reserved[16];
+    };
+
+    /**
+     * check the magic number of a file
+     * @return true if filename starts like a binary instance
+     */
+    static bool isBinaryFile(const char* filename);
+
+    /**
+     * map a binary instance and make tsp use the mapped matrix in place
+     * @param filename binary instance
+     * @param tsp (output) the instance, backed by the mapping
+     * @throw std::runtime_error on a malformed or corrupted file
+     */
+    static void map(const char* filename, TSP& tsp);
+
+    /**
+     * write tsp in the binary format
+     * @throw std::runtime_error if the file cannot be written
+     */
+    static void write(const TSP& tsp, const char* filename);
+
+    /** checksum of a block of doubles (64-bit FNV-1a over whole words) */
+    static uint64_t checksum(const double* data, size_t count);
+};
+
+#endif /* TSPBINARY_H */
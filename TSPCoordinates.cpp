@@ -0,0 +1,174 @@
+/**
+ * @file TSPCoordinates.cpp
+ * @brief Coordinate based TSP instances (TSPLIB EUC_2D, GEO, ATT)
+ */
+
+#include "TSPCoordinates.h"
+
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+
+#include "Logger.h"
+
+using namespace std;
+
+static const double GEO_PI = 3.141592;
+
+// TSPLIB: DDD.MM (degrees, minutes) to radians
+static double geoRadians(double value) {
+    int deg = (int)value;
+    double min = value - deg;
+    return GEO_PI * (deg + 5.0 * min / 3.0) / 180.0;
+}
+
+static string trim(const string& s) {
+    size_t first = s.find_first_not_of(" \t\r\n");
+    if (first == string::npos) {
+        return "";
+    }
+    size_t last = s.find_last_not_of(" \t\r\n");
+    return s.substr(first, last - first + 1);
+}
+
+
+TSPCoordinates::TSPCoordinates(EdgeWeightType type, const vector<double>& x, const vector<double>& y)
+    : mType(type), mX(x), mY(y)
+{
+    if (mType == GEO) {
+        for (int i = 0; i < size(); i++) {
+            mX[i] = geoRadians(mX[i]);
+            mY[i] = geoRadians(mY[i]);
+        }
+    }
+}
+
+const char* TSPCoordinates::typeName(EdgeWeightType type) {
+    switch (type) {
+    case EUC_2D: return "EUC_2D";
+    case GEO:    return "GEO";
+    default:     return "ATT";
+    }
+}
+
+TSPCoordinates* TSPCoordinates::readTSPLIB(const char* filename) {
+    ifstream in(filename);
+    if (!in) {
+        throw runtime_error(string("cannot open ") + filename);
+    }
+
+    int dimension = -1;
+    string weightType;
+    vector<double> x, y;
+
+    string line;
+    int lineNumber = 0;
+
+    // specification part: "KEYWORD : VALUE" lines up to the data section
+    while (getline(in, line)) {
+        lineNumber++;
+        line = trim(line);
+        if (line.empty()) {
+            continue;
+        }
+
+        size_t colon = line.find(':');
+        string key = trim(line.substr(0, colon));
+        string value = (colon == string::npos) ? "" : trim(line.substr(colon + 1));
+
+        if (key == "DIMENSION") {
+            dimension = atoi(value.c_str());
+        } else if (key == "EDGE_WEIGHT_TYPE") {
+            weightType = value;
+        } else if (key == "TYPE") {
+            if (value != "TSP") {
+                throw runtime_error(string(filename) + ": unsupported problem type " + value);
+            }
+        } else if (key == "NODE_COORD_SECTION") {
+            break;
+        } else if (key == "EOF" || key == "EDGE_WEIGHT_SECTION") {
+            throw runtime_error(string(filename) + ": no NODE_COORD_SECTION");
+        }
+    }
+
+    EdgeWeightType type;
+    if (weightType == "EUC_2D") {
+        type = EUC_2D;
+    } else if (weightType == "GEO") {
+        type = GEO;
+    } else if (weightType == "ATT") {
+        type = ATT;
+    } else {
+        throw runtime_error(string(filename) + ": unsupported EDGE_WEIGHT_TYPE '" + weightType + "'");
+    }
+
+    if (dimension <= 0) {
+        throw runtime_error(string(filename) + ": missing DIMENSION");
+    }
+
+    x.resize(dimension);
+    y.resize(dimension);
+    vector<bool> seen(dimension, false);
+
+    for (int read = 0; read < dimension; ) {
+        if (!getline(in, line)) {
+            throw runtime_error(string(filename) + ": expected " + to_string(dimension) + " nodes, found " + to_string(read));
+        }
+        lineNumber++;
+        line = trim(line);
+        if (line.empty()) {
+            continue;
+        }
+
+        istringstream fields(line);
+        int id;
+        double cx, cy;
+        if (!(fields >> id >> cx >> cy) || id < 1 || id > dimension || seen[id - 1]) {
+            throw runtime_error(string(filename) + ":" + to_string(lineNumber) + ": malformed node '" + line + "'");
+        }
+
+        // TSPLIB nodes are numbered 1 ... n
+        seen[id - 1] = true;
+        x[id - 1] = cx;
+        y[id - 1] = cy;
+        read++;
+    }
+
+    LOG_INFO << "read from file, num nodes = " << dimension << " (" << weightType << ")";
+
+    return new TSPCoordinates(type, x, y);
+}
+
+void TSPCoordinates::distanceRow(int i, double* __restrict__ out) const {
+    const int n = size();
+    const double* __restrict__ xs = mX.data();
+    const double* __restrict__ ys = mY.data();
+    const double xi = xs[i];
+    const double yi = ys[i];
+
+    switch (mType) {
+    case EUC_2D:
+        for (int j = 0; j < n; j++) {
+            double dx = xi - xs[j];
+            double dy = yi - ys[j];
+            out[j] = (double)(int)(std::sqrt(dx * dx + dy * dy) + 0.5);
+        }
+        break;
+
+    case ATT:
+        for (int j = 0; j < n; j++) {
+            double dx = xi - xs[j];
+            double dy = yi - ys[j];
+            double r = std::sqrt((dx * dx + dy * dy) / 10.0);
+            double t = (double)(int)(r + 0.5);
+            out[j] = t + (t < r ? 1.0 : 0.0);
+        }
+        break;
+
+    default:
+        for (int j = 0; j < n; j++) {
+            out[j] = geoDistance(i, j);
+        }
+        break;
+    }
+}
@@ -0,0 +1,104 @@
+/**
+ * @file TSPCoordinates.h
+ * @brief Coordinate based TSP instances (TSPLIB EUC_2D, GEO, ATT)
+ *
+ */
+
+#ifndef TSPCOORDINATES_H
+#define TSPCOORDINATES_H
+
+#include <cmath>
+#include <vector>
+#include <string>
+
+/**
+ * Node coordinates with the TSPLIB distance functions, distances are computed
+ * on demand so an instance takes O(n) memory.
+ *
+ * Coordinates are kept as separate arrays (structure of arrays) so that
+ * distanceRow() runs as a branch-free loop over contiguous data.
+ */
+class TSPCoordinates
+{
+public:
+
+    enum EdgeWeightType {
+        EUC_2D,
+        GEO,
+        ATT
+    };
+
+    TSPCoordinates(EdgeWeightType type, const std::vector<double>& x, const std::vector<double>& y);
+
+    /**
+     * parse a TSPLIB file with a NODE_COORD_SECTION
+     * @throw std::runtime_error on unsupported or malformed files
+     */
+    static TSPCoordinates* readTSPLIB(const char* filename);
+
+    /** TSPLIB name of an edge weight type */
+    static const char* typeName(EdgeWeightType type);
+
+    inline int size() const {
+        return (int)mX.size();
+    }
+
+    inline EdgeWeightType type() const {
+        return mType;
+    }
+
+    inline double x(int i) const {
+        return mX[i];
+    }
+
+    inline double y(int i) const {
+        return mY[i];
+    }
+
+    /** TSPLIB distance between nodes i and j */
+    inline double distance(int i, int j) const {
+        switch (mType) {
+        case EUC_2D: {
+            double dx = mX[i] - mX[j];
+            double dy = mY[i] - mY[j];
+            return (double)(int)(std::sqrt(dx * dx + dy * dy) + 0.5);
+        }
+        case ATT: {
+            double dx = mX[i] - mX[j];
+            double dy = mY[i] - mY[j];
+            double r = std::sqrt((dx * dx + dy * dy) / 10.0);
+            double t = (double)(int)(r + 0.5);
+            return t < r ? t + 1.0 : t;
+        }
+        default:
+            return geoDistance(i, j);
+        }
+    }
+
+    /**
+     * distances from node i to every node
+     * @param out (output) n distances
+     */
+    void distanceRow(int i, double* out) const;
+
+private:
+
+    inline double geoDistance(int i, int j) const {
+        if (i == j) {
+            return 0.0;
+        }
+        const double RRR = 6378.388;
+        double q1 = std::cos(mY[i] - mY[j]);
+        double q2 = std::cos(mX[i] - mX[j]);
+        double q3 = std::cos(mX[i] + mX[j]);
+        return (double)(int)(RRR * std::acos(0.5 * ((1.0 + q1) * q2 - (1.0 - q1) * q3)) + 1.0);
+    }
+
+    EdgeWeightType mType;
+
+    // for GEO instances latitude / longitude in radians
+    std::vector<double> mX;
+    std::vector<double> mY;
+};
+
+#endif /* TSPCOORDINATES_H */
@@ -9,11 +9,38 @@
 
 #include <vector>
 #include <cmath>
+#include <cassert>
+#include <algorithm>
 
 #include "TSP.h"
+#include "Logger.h"
+
+/**
+ * Class representing a move on the sequence positions:
+ *  TWO_OPT     substring reversal of positions from ... to
+ *  OR_OPT      the `length` nodes starting at position from are moved after position to
+ *              (to is a position of the current sequence), reversed if `reversed`
+ *  NODE_SWAP   the nodes at positions from and to are exchanged
+ */
+typedef struct move {
+  enum Type { TWO_OPT, OR_OPT, NODE_SWAP };
+
+  int from;
+  int to;
+
+  Type type = TWO_OPT;
+  int length = 0;
+  bool reversed = false;
+} TSPMove;
+
 
 /**
 * TSP Solution representation: ordered sequence of nodes (path representation)
+*
+* The solution also keeps its objective value and the position of every node.
+* apply() updates both in O(1) (plus the moved positions); code that writes
+* `sequence` directly must call evaluate() before using value() or position().
+* Builds without NDEBUG check both against a full recomputation after each move.
 */
 class TSPSolution
 {
@@ -22,6 +49,7 @@ public:
 
     // utils solutions fields
     std::string solveBy;
+    std::string stopBy;     // stop criterion that ended the search, see StopCriteria
     double userTime;
     double cpuTime;
     uint iterations;
@@ -41,6 +69,8 @@ public:
         userTime = -1.0;
         cpuTime = -1.0;
         iterations = 0;
+
+        evaluate(tsp);
     }
 
     TSPSolution( const TSPSolution& tspSol ) {
@@ -51,9 +81,14 @@ public:
         }
 
         solveBy = tspSol.solveBy;
+        stopBy = tspSol.stopBy;
         userTime = tspSol.userTime;
         cpuTime = tspSol.cpuTime;
         iterations = tspSol.iterations;
+
+        mValue = tspSol.mValue;
+        mEvaluated = tspSol.mEvaluated;
+        mPosition = tspSol.mPosition;
     }
 
 
@@ -71,30 +106,190 @@ public:
             sequence[idx2] = tmp;
         }
 
-        std::cout << "###" << std::endl;
-        print(std::cout);
-        std::cout << "###" << std::endl;
+        mEvaluated = false;     // see evaluate()
+
+        LOG_TRACE << "###\n" << *this << "\n###";
     }
 
+    /** value of the sequence, always recomputed (O(n)) */
     double evaluateObjectiveFunction(const TSP& tsp ) const {
         double total = 0.0;
 
         for ( uint i = 0 ; i < sequence.size() - 1 ; ++i ) {
             int from = sequence[i]  ;
             int to   = sequence[i+1];
-            total += tsp.cost[from][to];
+            total += tsp.cost(from, to);
         }
 
         return total;
     }
 
+    /**
+     * recompute the value and the node positions after `sequence` was written directly
+     * @return the value
+     */
+    double evaluate(const TSP& tsp) {
+        mValue = evaluateObjectiveFunction(tsp);
+        mPosition.resize(sequence.size() - 1);
+        for (uint p = 0; p < sequence.size() - 1; p++) {
+            mPosition[sequence[p]] = p;
+        }
+        mEvaluated = true;
+        return mValue;
+    }
+
+    /** objective value, kept up to date by apply() */
+    inline double value() const {
+        assert(mEvaluated);
+        return mValue;
+    }
+
+    /** position of a node in the sequence (node 0 -> position 0) */
+    inline int position(int node) const {
+        assert(mEvaluated);
+        return mPosition[node];
+    }
+
+    /** position of every node, see position() */
+    inline const std::vector<int>& positions() const {
+        assert(mEvaluated);
+        return mPosition;
+    }
+
+    /**
+     * cost variation of a move, O(1)
+     */
+    double costVariation(const TSP& tsp, const TSPMove& move) const {
+        const std::vector<int>& seq = sequence;
+
+        switch (move.type) {
+        case TSPMove::TWO_OPT: {
+            int h = seq[move.from-1], i = seq[move.from];
+            int j = seq[move.to], l = seq[move.to+1];
+            return - tsp.cost(h, i) - tsp.cost(j, l) + tsp.cost(h, j) + tsp.cost(i, l);
+        }
+        case TSPMove::NODE_SWAP: {
+            int a = std::min(move.from, move.to), b = std::max(move.from, move.to);
+            int p = seq[a-1], x = seq[a], y = seq[b], q = seq[b+1];
+            if (b == a + 1) {
+                return - tsp.cost(p, x) - tsp.cost(x, y) - tsp.cost(y, q)
+                       + tsp.cost(p, y) + tsp.cost(y, x) + tsp.cost(x, q);
+            }
+            int xn = seq[a+1], yp = seq[b-1];
+            return - tsp.cost(p, x) - tsp.cost(x, xn) - tsp.cost(yp, y) - tsp.cost(y, q)
+                   + tsp.cost(p, y) + tsp.cost(y, xn) + tsp.cost(yp, x) + tsp.cost(x, q);
+        }
+        default: {
+            int p = seq[move.from-1], s1 = seq[move.from];
+            int sL = seq[move.from+move.length-1], q = seq[move.from+move.length];
+            int u = seq[move.to], v = seq[move.to+1];
+            double variation = - tsp.cost(p, s1) - tsp.cost(sL, q) + tsp.cost(p, q) - tsp.cost(u, v);
+            if (move.reversed) {
+                return variation + tsp.cost(u, sL) + tsp.cost(s1, v);
+            }
+            return variation + tsp.cost(u, s1) + tsp.cost(sL, v);
+        }
+        }
+    }
+
+    /**
+     * apply a move in place, updating the value and the positions of the moved nodes
+     * @return the cost variation of the move
+     */
+    double apply(const TSP& tsp, const TSPMove& move) {
+        assert(mEvaluated);
+
+        double variation = costVariation(tsp, move);
+        std::vector<int>& seq = sequence;
+        int first, last;    // positions that changed
+
+        switch (move.type) {
+        case TSPMove::TWO_OPT:
+            std::reverse(seq.begin() + move.from, seq.begin() + move.to + 1);
+            first = move.from;
+            last = move.to;
+            break;
+
+        case TSPMove::NODE_SWAP:
+            std::swap(seq[move.from], seq[move.to]);
+            mPosition[seq[move.from]] = move.from;
+            first = last = move.to;
+            break;
+
+        default:
+            if (move.to > move.from) {
+                // segment moves forward, ends at position to
+                std::rotate(seq.begin() + move.from, seq.begin() + move.from + move.length, seq.begin() + move.to + 1);
+                if (move.reversed) {
+                    std::reverse(seq.begin() + move.to - move.length + 1, seq.begin() + move.to + 1);
+                }
+                first = move.from;
+                last = move.to;
+            } else {
+                // segment moves backward, starts at position to + 1
+                std::rotate(seq.begin() + move.to + 1, seq.begin() + move.from, seq.begin() + move.from + move.length);
+                if (move.reversed) {
+                    std::reverse(seq.begin() + move.to + 1, seq.begin() + move.to + 1 + move.length);
+                }
+                first = move.to + 1;
+                last = move.from + move.length - 1;
+            }
+            break;
+        }
+
+        for (int p = first; p <= last; p++) {
+            mPosition[seq[p]] = p;
+        }
+        mValue += variation;
+
+        assert(isConsistent(tsp));
+        return variation;
+    }
+
+    /**
+     * the move undoing `move` once it has been applied
+     */
+    static TSPMove inverse(const TSPMove& move) {
+        TSPMove undo = move;
+        if (move.type == TSPMove::OR_OPT) {
+            if (move.to > move.from) {
+                // the segment ends at position to: move it back after from - 1
+                undo.from = move.to - move.length + 1;
+                undo.to = move.from - 1;
+            } else {
+                // the segment starts at position to + 1: move it back to end at from + length - 1
+                undo.from = move.to + 1;
+                undo.to = move.from + move.length - 1;
+            }
+        }
+        return undo;    // a reversal or an exchange undoes itself
+    }
+
+    /** value and positions match the sequence (debug checks) */
+    bool isConsistent(const TSP& tsp) const {
+        double value = evaluateObjectiveFunction(tsp);
+        if (std::fabs(value - mValue) > 1e-6 * std::max(1.0, std::fabs(value))) {
+            return false;
+        }
+        for (uint p = 0; p < sequence.size() - 1; p++) {
+            if (mPosition[sequence[p]] != (int)p) {
+                return false;
+            }
+        }
+        return sequence.front() == 0 && sequence.back() == 0;
+    }
+
 
     void print(std::ostream& out) const {
-        out << std::endl;
-        for (uint i = 0; i < sequence.size(); i++ ) {
-            out << sequence[i] << " ";
+        out << std::endl << *this << std::endl;
+    }
+
+    /** the sequence, space separated */
+    friend std::ostream& operator<<(std::ostream& out, const TSPSolution& sol) {
+        for (uint i = 0; i < sol.sequence.size(); i++ ) {
+            out << sol.sequence[i] << " ";
         }
-        out << std::endl;
+        return out;
     }
 
     TSPSolution& operator=(const TSPSolution& right) {
@@ -107,10 +302,19 @@ public:
             for (uint i = 0; i < sequence.size(); i++ ) {
                 sequence[i] = right.sequence[i];
             }
+            mValue = right.mValue;
+            mEvaluated = right.mEvaluated;
+            mPosition = right.mPosition;
         }
 
         return *this;
     }
+
+private:
+
+    double mValue;
+    bool mEvaluated;
+    std::vector<int> mPosition;     // node -> position, node 0 -> 0
 };
 
 #endif /* TSPSOLUTION_H */
@@ -0,0 +1,313 @@
+/**
+ * @file TSPTextParser.cpp
+ * @brief Multi-threaded parser for the text instance format
+ */
+
+#include "TSPTextParser.h"
+
+#include <stdexcept>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <thread>
+
+#include "TSP.h"
+#include "Logger.h"
+#include "TSPBinary.h"
+
+using namespace std;
+
+// powers of ten that are exact doubles
+static const double EXACT_POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static string tokenAt(const char* p, const char* end) {
+    const char* q = p;
+    while (q < end && !isSpace(*q) && q - p < 32) {
+        q++;
+    }
+    return string(p, q);
+}
+
+
+TSPTextParser::TSPTextParser(const char* filename, unsigned int threads)
+    : mFilename(filename), mThreads(threads)
+{
+    if (mThreads == 0) {
+        mThreads = std::thread::hardware_concurrency();
+    }
+    if (mThreads == 0) {
+        mThreads = 1;
+    }
+}
+
+const char* TSPTextParser::parseDouble(const char* begin, const char* end, double& value) {
+    const char* p = begin;
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;         // significant digits stored in mantissa
+    int exp10 = 0;
+    bool anyDigit = false;
+    bool truncated = false;
+
+    for ( ; p < end && isDigit(*p); p++) {
+        anyDigit = true;
+        if (mantissa == 0 && *p == '0') {
+            continue;
+        }
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits++;
+        } else {
+            exp10++;
+            truncated = true;
+        }
+    }
+
+    if (p < end && *p == '.') {
+        p++;
+        for ( ; p < end && isDigit(*p); p++) {
+            anyDigit = true;
+            if (mantissa == 0 && *p == '0') {
+                exp10--;
+                continue;
+            }
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits++;
+                exp10--;
+            } else {
+                truncated = true;
+            }
+        }
+    }
+
+    if (!anyDigit) {
+        return begin;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool negativeExp = false;
+        if (q < end && (*q == '-' || *q == '+')) {
+            negativeExp = (*q == '-');
+            q++;
+        }
+        if (q < end && isDigit(*q)) {
+            int e = 0;
+            for ( ; q < end && isDigit(*q); q++) {
+                if (e < 100000) {
+                    e = e * 10 + (*q - '0');
+                }
+            }
+            exp10 += negativeExp ? -e : e;
+            p = q;
+        }
+    }
+
+    // Clinger's fast path: both operands are exact, one IEEE operation rounds correctly
+    if (!truncated && mantissa < (1ULL << 53) && exp10 >= -22 && exp10 <= 22) {
+        double v = (double)mantissa;
+        v = (exp10 < 0) ? v / EXACT_POW10[-exp10] : v * EXACT_POW10[exp10];
+        value = negative ? -v : v;
+        return p;
+    }
+
+    // rare long or huge numbers: let the C library round them
+    char buffer[512];
+    size_t length = p - begin;
+    if (length >= sizeof(buffer)) {
+        return begin;
+    }
+    memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+    value = strtod(buffer, NULL);
+
+    return p;
+}
+
+void TSPTextParser::parseChunk(Chunk* chunk) {
+    const char* p = chunk->begin;
+    const char* end = chunk->end;
+    const char* lineStart = chunk->begin;
+
+    while (p < end) {
+        if (isSpace(*p)) {
+            if (*p == '\n') {
+                chunk->lines++;
+                lineStart = p + 1;
+            }
+            p++;
+            continue;
+        }
+
+        double value;
+        const char* next = parseDouble(p, end, value);
+
+        if (next == p || (next < end && !isSpace(*next))) {
+            chunk->failed = true;
+            chunk->errorLine = chunk->lines;
+            chunk->errorColumn = p - lineStart;
+            chunk->errorMessage = "invalid number '" + tokenAt(p, end) + "'";
+            return;
+        }
+
+        chunk->values.push_back(value);
+        p = next;
+    }
+}
+
+void TSPTextParser::fail(size_t line, size_t column, const string& message) const {
+    ostringstream out;
+    out << mFilename << ":" << line << ":" << column << ": " << message;
+    throw runtime_error(out.str());
+}
+
+void TSPTextParser::parse(TSP& tsp) {
+    MappedFile file(mFilename.c_str());
+
+    const char* data = reinterpret_cast<const char*>(file.data());
+    const char* end = data + file.size();
+
+    // header: number of nodes
+    const char* p = data;
+    size_t line = 1;
+    const char* lineStart = data;
+    while (p < end && isSpace(*p)) {
+        if (*p == '\n') {
+            line++;
+            lineStart = p + 1;
+        }
+        p++;
+    }
+
+    double nodes = 0;
+    const char* body = parseDouble(p, end, nodes);
+    if (body == p || (body < end && !isSpace(*body)) || nodes < 1 || nodes != (int)nodes) {
+        fail(line, p - lineStart + 1, "expected the number of nodes, found '" + tokenAt(p, end) + "'");
+    }
+
+    const int n = (int)nodes;
+    const size_t expected = (size_t)n * n;
+
+    // split the body on line boundaries, one chunk per thread
+    size_t bodyBytes = end - body;
+    size_t chunks = bodyBytes / MIN_CHUNK_BYTES;
+    if (chunks > mThreads) {
+        chunks = mThreads;
+    }
+    if (chunks == 0) {
+        chunks = 1;
+    }
+
+    vector<Chunk> parts(chunks);
+    const char* chunkBegin = body;
+    for (size_t k = 0; k < chunks; k++) {
+        const char* chunkEnd = end;
+        if (k + 1 < chunks) {
+            const char* target = body + bodyBytes * (k + 1) / chunks;
+            if (target < chunkBegin) {
+                target = chunkBegin;
+            }
+            const char* newline = static_cast<const char*>(memchr(target, '\n', end - target));
+            chunkEnd = (newline != NULL) ? newline + 1 : end;
+        }
+
+        parts[k].begin = chunkBegin;
+        parts[k].end = chunkEnd;
+        parts[k].lines = 0;
+        parts[k].failed = false;
+        parts[k].errorLine = 0;
+        parts[k].errorColumn = 0;
+        parts[k].values.reserve(expected / chunks + expected / (4 * chunks) + 16);
+
+        chunkBegin = chunkEnd;
+    }
+
+    vector<std::thread> workers;
+    for (size_t k = 1; k < chunks; k++) {
+        workers.push_back(std::thread(parseChunk, &parts[k]));
+    }
+    parseChunk(&parts[0]);
+    for (size_t k = 0; k < workers.size(); k++) {
+        workers[k].join();
+    }
+
+    // report the first error in file order, chunk 0 starts in the middle of the header line
+    size_t firstLine = line;
+    size_t total = 0;
+    for (size_t k = 0; k < chunks; k++) {
+        if (parts[k].failed) {
+            size_t column = parts[k].errorColumn + 1;
+            if (k == 0 && parts[k].errorLine == 0) {
+                column += body - lineStart;
+            }
+            fail(firstLine + parts[k].errorLine, column, parts[k].errorMessage);
+        }
+        firstLine += parts[k].lines;
+        total += parts[k].values.size();
+    }
+
+    if (total != expected) {
+        ostringstream message;
+        message << "expected " << expected << " costs (" << n << " x " << n << "), found " << total;
+
+        // point at the first extra value, or at the end of the file when values are missing
+        size_t errorLine = line;
+        const char* errorLineStart = lineStart;
+        const char* errorAt = end;
+        size_t count = 0;
+        for (const char* q = body; q < end; ) {
+            if (isSpace(*q)) {
+                if (*q == '\n') {
+                    errorLine++;
+                    errorLineStart = q + 1;
+                }
+                q++;
+                continue;
+            }
+            if (count++ == expected) {
+                errorAt = q;
+                break;
+            }
+            while (q < end && !isSpace(*q)) {
+                q++;
+            }
+        }
+        fail(errorLine, errorAt - errorLineStart + 1, message.str());
+    }
+
+    LOG_INFO << "read from file, num nodes = " << n;
+
+    tsp.resize(n);
+
+    size_t k = 0;
+    size_t offset = 0;
+    for (int i = 0; i < n; i++) {
+        double* r = tsp.row(i);
+        for (int j = 0; j < n; j++) {
+            while (offset == parts[k].values.size()) {
+                k++;
+                offset = 0;
+            }
+            r[j] = parts[k].values[offset++];
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ * @file TSPTextParser.h
+ * @brief Multi-threaded parser for the text instance format
+ *
+ */
+
+#ifndef TSPTEXTPARSER_H
+#define TSPTEXTPARSER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class TSP;
+
+/**
+ * Parser for text instances: the number of nodes n followed by the n x n
+ * cost matrix, values separated by any whitespace.
+ *
+ * The file is mapped, split on line boundaries into one chunk per core and
+ * every chunk is tokenized and converted on its own thread. Malformed input
+ * is reported as "file:line:column: message" through std::runtime_error.
+ */
+class TSPTextParser
+{
+public:
+
+    /** chunks smaller than this are not worth a thread */
+    static const size_t MIN_CHUNK_BYTES = 64 * 1024;
+
+    explicit TSPTextParser(const char* filename, unsigned int threads = 0);
+
+    /**
+     * parse the whole file into tsp
+     * @throw std::runtime_error on malformed input
+     */
+    void parse(TSP& tsp);
+
+    /**
+     * convert one number in [begin, end), locale independent
+     * @return pointer past the number, begin if no number could be read
+     */
+    static const char* parseDouble(const char* begin, const char* end, double& value);
+
+private:
+
+    struct Chunk {
+        const char* begin;
+        const char* end;
+
+        std::vector<double> values;
+        size_t lines;       // newlines inside the chunk
+
+        // first malformed token, relative to the chunk start
+        bool failed;
+        size_t errorLine;
+        size_t errorColumn;
+        std::string errorMessage;
+    };
+
+    static void parseChunk(Chunk* chunk);
+
+    void fail(size_t line, size_t column, const std::string& message) const;
+
+    std::string mFilename;
+    unsigned int mThreads;
+};
+
+#endif /* TSPTEXTPARSER_H */
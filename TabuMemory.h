@@ -0,0 +1,156 @@
+/**
+ * @file TabuMemory.h
+ * @brief Tabu list of 2-opt moves with iteration stamps
+ *
+ */
+
+#ifndef TABUMEMORY_H
+#define TABUMEMORY_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+/**
+ * Remembers the moves (from, to) of the last `tenure` iterations.
+ *
+ * Every move made tabu has a slot in a hash table holding the last iteration at
+ * which it is still tabu, so a check is a probe or two and nothing has to be
+ * removed when a move expires: the expired moves are purged when the table is
+ * a quarter full. The recent moves are also kept in a ring buffer of `tenure`
+ * entries, from which the scans build their masks.
+ *
+ * Memory is O(tenure) whatever the number of nodes (at most about 400 tenure
+ * bytes), allocated by reset(); every island of a parallel search has its own.
+ */
+class TabuMemory
+{
+public:
+
+    TabuMemory() : mTenure(0), mUsed(0), mNext(0), mCount(0) {}
+
+    /**
+     * forget every move
+     * @param tenure number of iterations a move stays tabu
+     */
+    void reset(int tenure) {
+        mTenure = tenure;
+        mNext = mCount = 0;
+        mRing.assign(tenure, Entry());
+
+        // at most about tenure moves are tabu at once: the table stays at most a quarter full
+        size_t slots = 16;
+        while (slots < 8 * (size_t)tenure) {
+            slots *= 2;
+        }
+        mTable.assign(slots, Entry());
+        mSpare.assign(slots, Entry());
+        mUsed = 0;
+    }
+
+    /**
+     * make a move tabu for the iterations iter + 1 ... iter + tenure
+     * @param from 1 <= from < to
+     */
+    inline void add(int from, int to, int iter) {
+        if (mTenure == 0) {
+            return;
+        }
+        Entry& entry = mRing[mNext];
+        entry.from = from;
+        entry.to = to;
+        entry.expiry = iter + mTenure;
+        mNext = (mNext + 1) % mTenure;
+        mCount = std::min(mCount + 1, mTenure);
+
+        size_t s = find(mTable, from, to);
+        if (mTable[s].from == 0) {
+            if (4 * (mUsed + 1) > mTable.size()) {
+                purge(iter);
+                s = find(mTable, from, to);
+            }
+            mTable[s].from = from;
+            mTable[s].to = to;
+            mUsed++;
+        }
+        mTable[s].expiry = entry.expiry;
+    }
+
+    /** true if the move is tabu at iteration iter */
+    inline bool isTabu(int from, int to, int iter) const {
+        if (mTable.empty()) {
+            return false;
+        }
+        const Entry& slot = mTable[find(mTable, from, to)];
+        return slot.from != 0 && slot.expiry >= iter;
+    }
+
+    /**
+     * the moves tabu at iteration iter, sorted
+     * @param moves (output) pairs (from, to)
+     */
+    void collect(int iter, std::vector< std::pair<int, int> >& moves) const {
+        moves.clear();
+        moves.reserve(mTenure);     // sized once, not while the ring fills up
+        for (int k = 0; k < mCount; k++) {
+            if (mRing[k].expiry >= iter) {
+                moves.push_back(std::make_pair(mRing[k].from, mRing[k].to));
+            }
+        }
+        std::sort(moves.begin(), moves.end());
+        moves.erase(std::unique(moves.begin(), moves.end()), moves.end());
+    }
+
+private:
+
+    struct Entry {
+        int from, to;       // from = 0: free table slot
+        int expiry;
+        Entry() : from(0), to(0), expiry(0) {}
+    };
+
+    /** the slot of the move in table, or the free slot where it goes (linear probing) */
+    static inline size_t find(const std::vector<Entry>& table, int from, int to) {
+        const size_t mask = table.size() - 1;
+        unsigned h = (unsigned)from * 0x9E3779B1u ^ (unsigned)to * 0x85EBCA77u;
+        size_t s = (h ^ (h >> 16)) & mask;
+        while (table[s].from != 0 && (table[s].from != from || table[s].to != to)) {
+            s = (s + 1) & mask;
+        }
+        return s;
+    }
+
+    /** keep the moves still tabu at iter, in a table twice larger if they fill an eighth of it */
+    void purge(int iter) {
+        size_t alive = 0;
+        for (size_t s = 0; s < mTable.size(); s++) {
+            alive += (mTable[s].from != 0 && mTable[s].expiry >= iter);
+        }
+        if (8 * alive > mTable.size()) {
+            mSpare.assign(2 * mTable.size(), Entry());      // several moves per iteration
+        } else {
+            std::fill(mSpare.begin(), mSpare.end(), Entry());
+        }
+        for (size_t s = 0; s < mTable.size(); s++) {
+            if (mTable[s].from != 0 && mTable[s].expiry >= iter) {
+                mSpare[find(mSpare, mTable[s].from, mTable[s].to)] = mTable[s];
+            }
+        }
+        mTable.swap(mSpare);
+        if (mSpare.size() != mTable.size()) {
+            mSpare.assign(mTable.size(), Entry());
+        }
+        mUsed = alive;
+    }
+
+    int mTenure;
+
+    std::vector<Entry> mTable;      // moves made tabu, last tabu iteration; power of 2 slots
+    std::vector<Entry> mSpare;      // same size, the purge rebuilds the table into it
+    size_t mUsed;                   // used table slots
+    std::vector<Entry> mRing;       // moves of the last tenure iterations
+    int mNext;                      // ring slot of the next move
+    int mCount;                     // used ring slots
+};
+
+#endif /* TABUMEMORY_H */
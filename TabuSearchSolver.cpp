@@ -4,13 +4,16 @@
  */
 
 #include "TabuSearchSolver.h"
-#include <iostream>
 #include <sstream>
 #include <string>
 #include <stdio.h>
 #include <ctime>
 #include <sys/time.h>
 
+#include "AllocationCounter.h"
+#include "SolverMetrics.h"
+#include "Logger.h"
+
 using namespace std;
 
 
@@ -19,6 +22,9 @@ std::string TabuSearchSolver::getSolverName() const {
     sprintf(buffer, "\tTenure: %d, MaxIter: %d", mTabuLength, mMaxIteration);
 
     std::string tmp = std::string(buffer);
+    if (CandidateScan) {
+        tmp += ", candidates";
+    }
 
     if (ACmode) {
         if (BestImprovement) {
@@ -37,12 +43,10 @@ std::string TabuSearchSolver::getSolverName() const {
 
 bool TabuSearchSolver::solve(const TSP& tsp, const TSPSolution& initSol, TSPSolution& bestSol) {
 
-    // clear previous use
-    //mTabuList.clear();
-    mTabuSet.clear();
-    mAdvTabuList.clear();
-
     try {
+        // clear previous use
+        mTabu.reset(mTabuLength);
+
         bool stop = false;
         int  iter = 0;
 
@@ -52,18 +56,30 @@ bool TabuSearchSolver::solve(const TSP& tsp, const TSPSolution& initSol, TSPSolu
         TSPSolution currSol(initSol);
         double bestValue, currValue;
 
-        bestValue = currValue = currSol.evaluateObjectiveFunction(tsp);
+        bestValue = currValue = currSol.evaluate(tsp);
         TSPMove move;
 
-        clock_t currTime = clock();
+        mJournal.reset(currSol);
+
+        // island mode: islands are quiet, their driver prints a summary
+        const bool verbose = (mElite == NULL);
+        double lastMigrationValue = bestValue;
+        int stagnant = 0;
+        mPublished = mRestarts = 0;
+
+        // maxIter and maxSeconds (CPU time of this thread) are in the stop criteria
+        mStop.start();
+
+        // the first iteration sizes the buffers, the next ones should not allocate
+        unsigned long allocations = 0;
 
         while (!stop) {
             iter++;
+            mIter = iter;
 
             // for small instance of problem print the current solution
-            if (tsp.n < 20) {
-                currSol.print(std::cout);
-                std::cout << " (" << iter << ") value " << currValue << "\t(" << bestValue << ")";
+            if (tsp.n < 20 && verbose) {
+                LOG_TRACE << currSol << "\n (" << iter << ") value " << currValue << "\t(" << bestValue << ")";
             }
 
             //mAspiration = bestValue - currValue;
@@ -78,99 +94,98 @@ bool TabuSearchSolver::solve(const TSP& tsp, const TSPSolution& initSol, TSPSolu
             double bestNeighValue = currValue + findBestNeighbor(tsp, currSol, move); // costVar;
 
             if (bestNeighValue >= tsp.infinite) {
-                cout << "\tmove: NO legal neighbour" << endl;
+                if (verbose) {
+                    LOG_DEBUG << "\tmove: NO legal neighbour";
+                }
                 stop = true;
             }
             else {
-                // insertTabu(move);
-                if (mTabuLength != 0) {
-
-                    // use only List
-                    /*if (mTabuList.size() < mTabuLength) {
-                        mTabuList.push_back(move);
-                    } else {
-                        mTabuList.pop_front();  // remove old elements
-                        mTabuList.push_back(move);
-                    }*/
-
-                    // use only List + Set
-                    if (mTabuSet.size() < mTabuLength) {
-                        // get key from TSPMove
-                        char buffer[50];
-                        sprintf(buffer, "%u%u", move.from, move.to);
-                        string moveKey = string(buffer);
-
-                        mAdvTabuList.push_back(moveKey);
-                        mTabuSet.insert(moveKey);
-
-                    } else {
-                        // get key from TSPMove
-                        char buffer[50];
-                        sprintf(buffer, "%u%u", move.from, move.to);
-                        string moveKey = string(buffer);
-
-                        //cout << "\tNew tabu move: " << moveKey << "\t" << mTabuSet.size() << endl;
-
-                        // remove old key
-                        string oldTabuKey = mAdvTabuList.front();
-
-                        mAdvTabuList.pop_front();
-                        mTabuSet.erase(oldTabuKey);
-
-                        // add new key
-                        mAdvTabuList.push_back(moveKey);
-                        mTabuSet.insert(moveKey);
-                    }
+                // insertTabu(move): tabu for the next mTabuLength iterations
+                mTabu.add(move.from, move.to, iter);
 
+                {
+                    SolverMetrics::Timer timer(SolverMetrics::APPLY_NS);
+                    currSol.apply(tsp, move);
+                    mJournal.record(tsp, move);
                 }
-
-                currSol = swap(currSol,move);
+                SolverMetrics::add(SolverMetrics::MOVES_APPLIED);
                 currValue = bestNeighValue;
 
                 if (currValue < bestValue - 0.01) { // TS: update incumbent (if better -with tolerance- solution found)
                     bestValue = currValue;
-                    bestSol = currSol;
+                    mJournal.markBest(currSol);
+                    SolverMetrics::add(SolverMetrics::IMPROVEMENTS);
+
+                    if (verbose) {
+                        LOG_DEBUG << " (" << iter << ") value " << currValue
+                                  << "\tmove: " << move.from << " , " << move.to
+                                  << "\tbetter solution";
+                    }
+                }
+
+                // island: share the best tour, restart from the elite one after a stagnation
+                if (mElite != NULL && iter % mMigrationInterval == 0) {
+                    if (bestValue < mElite->value() && mElite->offer(mJournal.best(tsp), bestValue)) {
+                        mPublished++;
+                    }
 
-                    cout << " (" << iter << ") value " << currValue
-                         << "\tmove: " << move.from << " , " << move.to
-                         << "\tbetter solution" << std::endl;
+                    stagnant = (bestValue < lastMigrationValue) ? 0 : stagnant + 1;
+                    lastMigrationValue = bestValue;
+
+                    if (mRestartAfter > 0 && stagnant >= mRestartAfter && mElite->value() < bestValue - 0.01) {
+                        mElite->read(currSol);
+                        bestValue = currValue = lastMigrationValue = currSol.evaluate(tsp);
+                        mJournal.reset(currSol);
+                        mTabu.reset(mTabuLength);
+                        stagnant = 0;
+                        mRestarts++;
+                    }
                 }
 
                 // stopping criteria
-                /*if (iter > mMaxIteration) {
-                    stop = true;
-                } else*/ if ((double)(clock() - currTime) / CLOCKS_PER_SEC > mMaxTime) {
+                if (mStop.stop(iter, bestValue)) {
+                    // islands: publish a tour reaching the target at once, the others stop on it
+                    if (mStop.reason() == StopCriteria::TARGET_VALUE && mElite != NULL
+                        && bestValue < mElite->value() && mElite->offer(mJournal.best(tsp), bestValue)) {
+                        mPublished++;
+                    }
                     stop = true;
+                } else if (mElite != NULL && mElite->value() <= mStop.targetValue()) {
+                    stop = mStop.stopBy(StopCriteria::TARGET_VALUE);
                 }
 
                 //std::cout << "\tmove: " << move.from << " , " << move.to;
                 //std::cout << std::endl;
             }
+
+            if (iter == 1) {
+                allocations = AllocationCounter::count();
+            }
         }
 
+        if (AllocationCounter::enabled() && verbose) {
+            LOG_INFO << "heap allocations after the first iteration: " << AllocationCounter::count() - allocations;
+        }
+
+        bestSol = mJournal.best(tsp);
         bestSol.iterations = iter;
 
         return true;
     }
     catch(std::exception& e) {
-        std::cout << ">>>EXCEPTION: " << e.what() << std::endl;
+        LOG_ERROR << ">>>EXCEPTION: " << e.what();
         return false;
     }
 }
 
-TSPSolution& TabuSearchSolver::swap(TSPSolution& tspSol, const TSPMove& move) {
-
-    TSPSolution tmpSol(tspSol);
-
-    for ( int i = move.from ; i <= move.to ; ++i ) {
-        tspSol.sequence[i] = tmpSol.sequence[move.to-(i-move.from)];
+double TabuSearchSolver::findFirstBestNeighbor(const TSP& tsp , const TSPSolution& currSol, TSPMove& move) {
+    SolverMetrics::Timer timer(SolverMetrics::NEIGHBORHOOD_NS);
+    if (CandidateScan) {
+        return findFirstBestCandidateNeighbor(tsp, currSol, move);
     }
 
-    return tspSol;
-}
-
-double TabuSearchSolver::findFirstBestNeighbor(const TSP& tsp , const TSPSolution& currSol, TSPMove& move) {
     double bestCostVariation = tsp.infinite;
+    ScanCounts counts;
 
     // N.B. intial and final position are fixed (initial/final node remains 0)
 
@@ -182,6 +197,9 @@ double TabuSearchSolver::findFirstBestNeighbor(const TSP& tsp , const TSPSolutio
         // choose a starting node
         int i = currSol.sequence[a];
 
+        const double* costH = mRows.row(tsp, h);
+        const double* costI = mRows.row(tsp, i);
+
         for (uint b = a + 1 ; b < currSol.sequence.size() - 1 ; b++) {
 
             int j = currSol.sequence[b];        // choose a finishing node
@@ -191,15 +209,18 @@ double TabuSearchSolver::findFirstBestNeighbor(const TSP& tsp , const TSPSolutio
             /*if ( ( (currIter - tabuList[i] <= tabuLength) &&
                     (currIter - tabuList[j] <= tabuLength)) ) continue */
 
-            double neighCostVariation = - tsp.cost[h][i] - tsp.cost[j][l]
-                                        + tsp.cost[h][j] + tsp.cost[i][l];
+            double neighCostVariation = - costH[i] - tsp.cost(j, l)
+                                        + costH[j] + costI[l];
+            counts.evaluated++;
 
-
-            if (isTabuMove(a, b) && !satisfiedAspirationCriteria(neighCostVariation)) {
+            bool tabu = isTabuMove(a, b);
+            if (tabu && !satisfiedAspirationCriteria(neighCostVariation)) {
                 // DEBUG
                 //std::cout << "\t" << "discard move: " << a << ", " << b << "\t";
+                counts.tabuRejected++;
             }
             else {
+                counts.aspirationAccepted += tabu;
 
                 // DEBUG
                 /*if (isTabuMove(a, b) && satisfiedAspirationCriteria(neighCostVariation)) {
@@ -211,10 +232,11 @@ double TabuSearchSolver::findFirstBestNeighbor(const TSP& tsp , const TSPSolutio
                     move.from = a;
                     move.to = b;
 
-                    double currentBestValueFound = currSol.evaluateObjectiveFunction(tsp);
+                    double currentBestValueFound = currSol.value();
 
                     // on first improvement exit
                     if (currentBestValueFound + bestCostVariation < currentBestValueFound) {
+                        counts.add();
                         return bestCostVariation;
                     }
 
@@ -227,70 +249,79 @@ double TabuSearchSolver::findFirstBestNeighbor(const TSP& tsp , const TSPSolutio
         }
     }
 
+    counts.add();
     return bestCostVariation;
 }
 
 
 double TabuSearchSolver::findBestNeighbor( const TSP& tsp , const TSPSolution& currSol, TSPMove& move ) {
-    // Determine the NON-TABU *move* yielding the best 2-opt neigbor solution
-    double bestCostVariation = tsp.infinite;
-
-    // N.B. intial and final position are fixed (initial/final node remains 0)
-
-    // Slice all the current solution vector
-    for (uint a = 1 ; a < currSol.sequence.size() - 2; a++) {
-
-        // prev node
-        int h = currSol.sequence[a-1];
-        // choose a starting node
-        int i = currSol.sequence[a];
-
-        for (uint b = a + 1 ; b < currSol.sequence.size() - 1 ; b++) {
-
-            int j = currSol.sequence[b];        // choose a finishing node
-            int l = currSol.sequence[b+1];      // prev node
+    SolverMetrics::Timer timer(SolverMetrics::NEIGHBORHOOD_NS);
+    if (CandidateScan) {
+        return findBestCandidateNeighbor(tsp, currSol, move);
+    }
 
-            // prof. implementation it discards other moves
-            /*if ( ( (currIter - tabuList[i] <= tabuLength) &&
-                    (currIter - tabuList[j] <= tabuLength)) ) continue */
+    // Determine the NON-TABU *move* yielding the best 2-opt neigbor solution
+    // (intial and final position are fixed, see TwoOptScanner)
+    collectTabuMoves();
 
-            double neighCostVariation = - tsp.cost[h][i] - tsp.cost[j][l]
-                                        + tsp.cost[h][j] + tsp.cost[i][l];
+    // the kernel evaluates every move, then masks the tabu ones out
+    const uint64_t last = currSol.sequence.size() - 1;
+    SolverMetrics::add(SolverMetrics::MOVES_EVALUATED, (last - 2) * (last - 1) / 2);
+    SolverMetrics::add(SolverMetrics::TABU_REJECTED, mTabuMoves.size());
 
+    return mScanner.findBest(tsp, currSol, &mTabuMoves, move);
+}
 
-            if (!isTabuMove(a, b) /*|| satisfiedAspirationCriteria(neighCostVariation)*/) {
-                if (neighCostVariation < bestCostVariation) {
-                    bestCostVariation = neighCostVariation;
-                    move.from = a;
-                    move.to = b;
-                }
-            }
+double TabuSearchSolver::findFirstBestCandidateNeighbor(const TSP& tsp, const TSPSolution& currSol, TSPMove& move) {
+    const CandidateLists& cand = requireCandidates(tsp);
 
-            /*if (isTabuMove(a, b) && !satisfiedAspirationCriteria(neighCostVariation)) {
-                // DEBUG
-                //std::cout << "\t" << "discard move: " << a << ", " << b << "\t";
-            }
-            else {
+    double bestCostVariation = tsp.infinite;
+    double currentBestValueFound = currSol.value();
+    ScanCounts counts;
+
+    forEachCandidateMove(tsp, cand, currSol, [&](int a, int b, double neighCostVariation) {
+        counts.evaluated++;
+        bool tabu = isTabuMove(a, b);
+        if (tabu && !satisfiedAspirationCriteria(neighCostVariation)) {
+            counts.tabuRejected++;
+            return false;
+        }
+        counts.aspirationAccepted += tabu;
+        if (neighCostVariation < bestCostVariation) {
+            bestCostVariation = neighCostVariation;
+            move.from = a;
+            move.to = b;
+
+            // on first improvement exit
+            return currentBestValueFound + bestCostVariation < currentBestValueFound;
+        }
+        return false;
+    });
 
-                // DEBUG
-                if (isTabuMove(a, b) && satisfiedAspirationCriteria(neighCostVariation)) {
-                    std::cout << "\t" << "in tabu but satisfied AC: " << a << ", " << b << "\t";
-                }
+    counts.add();
+    return bestCostVariation;
+}
 
-                if (neighCostVariation < bestCostVariation) {
-                    bestCostVariation = neighCostVariation;
-                    move.from = a;
-                    move.to = b;
+double TabuSearchSolver::findBestCandidateNeighbor(const TSP& tsp, const TSPSolution& currSol, TSPMove& move) {
+    // Determine the NON-TABU *move* adding a candidate edge that yields the best 2-opt neigbor solution
+    const CandidateLists& cand = requireCandidates(tsp);
 
-                    //std::cout << "\t" << "better move: " << a << ", " << b << "\t";
-                }
-                else {
-                    //std::cout << "\t" << "no better move: " << a << ", " << b << "\t";
-                }
-            }*/
+    double bestCostVariation = tsp.infinite;
+    ScanCounts counts;
+
+    forEachCandidateMove(tsp, cand, currSol, [&](int a, int b, double neighCostVariation) {
+        counts.evaluated++;
+        if (isTabuMove(a, b)) {
+            counts.tabuRejected++;
+        } else if (neighCostVariation < bestCostVariation) {
+            bestCostVariation = neighCostVariation;
+            move.from = a;
+            move.to = b;
         }
-    }
+        return false;
+    });
 
+    counts.add();
     return bestCostVariation;
 }
 
@@ -306,22 +337,9 @@ bool TabuSearchSolver::satisfiedAspirationCriteria(double neighbourCostVariation
 
 
 bool TabuSearchSolver::isTabuMove(int from, int to) {
-    /*std::list<TSPMove>::const_iterator it = mTabuList.begin();
-
-    while (it != mTabuList.end()) {
-        if ((*it).from == from && (*it).to == to)
-            return true;
-        it++;
-    }*/
-
-
-    char buffer[50];
-    sprintf(buffer, "%u%u", from, to);
-    string moveKey = string(buffer);
-
-    if (mTabuSet.find(moveKey) != mTabuSet.end()) {
-        return true;
-    }
+    return mTabu.isTabu(from, to, mIter);
+}
 
-    return false;
+void TabuSearchSolver::collectTabuMoves() {
+    mTabu.collect(mIter, mTabuMoves);
 }
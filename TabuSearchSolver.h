@@ -10,16 +10,18 @@
 #include <vector>
 #include <list>
 #include <iostream>
-#include <set>
 
 #include "solver.h"
+#include "RowCache.h"
+#include "neighborimprovement.h"
+#include "TwoOptScanner.h"
+#include "TabuMemory.h"
+#include "MoveJournal.h"
+#include "EliteSlot.h"
+#include "SolverMetrics.h"
 
 using namespace std;
 
-class TSStopCriteria {
-
-};
-
 /**
  * Class that solves a TSP problem by neighbourdood search and 2-opt moves
  */
@@ -33,27 +35,42 @@ public:
 
     list<TSPMove> mTabuList;
 
-    // Advance Tabu
-    list<string> mAdvTabuList;
-    set<string> mTabuSet;
+    // Advance Tabu: moves (from, to) of the last mTabuLength iterations
+    TabuMemory mTabu;
+    int mIter;
 
     double mAspiration;
 
     // config variable
     bool ACmode;
     bool BestImprovement;
+    bool CandidateScan;     // only moves adding a candidate edge
 
-    char mBuffer[50];
+    RowCache mRows;
 
+    TwoOptScanner mScanner;
 
-    //TSStopCriteria StopCriteria;
+    vector< pair<int, int> > mTabuMoves;    // (a, b) of the tabu moves, sorted
 
+    MoveJournal mJournal;   // moves since the last copy: the best solution is rebuilt at the end
 
+    // Island mode (see IslandTabuSearchSolver): NULL for a single search
+    EliteSlot* mElite;
+    int mMigrationInterval;     // iterations between two visits of the elite slot
+    int mRestartAfter;          // migrations without improvement before restarting from the elite, 0 = never
+    int mPublished;             // tours stored in the elite slot by this search
+    int mRestarts;
 
-    TabuSearchSolver() {}
 
-    TabuSearchSolver(int tabuLength, int maxIter, bool aspCriteria = false, bool bestImprovement = true, double maxSeconds = 1e10)
-        : mTabuLength(tabuLength), mMaxIteration(maxIter), mMaxTime(maxSeconds), ACmode(aspCriteria), BestImprovement(bestImprovement) {}
+    TabuSearchSolver() : mIter(0), CandidateScan(false), mElite(NULL), mMigrationInterval(0), mRestartAfter(0),
+                         mPublished(0), mRestarts(0) {}
+
+    TabuSearchSolver(int tabuLength, int maxIter, bool aspCriteria = false, bool bestImprovement = true, double maxSeconds = 1e10,
+                     bool candidateScan = false)
+        : mTabuLength(tabuLength), mMaxIteration(maxIter), mMaxTime(maxSeconds), mIter(0), ACmode(aspCriteria), BestImprovement(bestImprovement),
+          CandidateScan(candidateScan), mElite(NULL), mMigrationInterval(0), mRestartAfter(0), mPublished(0), mRestarts(0) {
+        mStop.setCpuTimeLimit(maxSeconds).setIterationLimit(maxIter);
+    }
 
     // Factory methods
     static TabuSearchSolver* buildTS_BI(int tabuLenght, int maxIter, double maxSeconds = 1e10) {
@@ -75,8 +92,26 @@ public:
 
     std::string getSolverName() const;
 
+    Solver* clone() const {
+        TabuSearchSolver* solver = new TabuSearchSolver(mTabuLength, mMaxIteration, ACmode, BestImprovement, mMaxTime, CandidateScan);
+        solver->mStop = mStop;
+        return solver;
+    }
+
     bool solve(const TSP &tsp, const TSPSolution &initSol, TSPSolution &bestSol);
 
+    /**
+     * run as an island: every migrationInterval iterations the best tour found is
+     * offered to the shared slot and, after restartAfter visits without improvement,
+     * the search restarts from the slot tour if it is better (tabu memory cleared).
+     * Islands print nothing while they search.
+     */
+    void joinIsland(EliteSlot* elite, int migrationInterval, int restartAfter) {
+        mElite = elite;
+        mMigrationInterval = migrationInterval > 0 ? migrationInterval : 1;
+        mRestartAfter = restartAfter;
+    }
+
     bool satisfiedAspirationCriteria(double neighbourCostVariation) const;
 
 
@@ -85,10 +120,28 @@ public:
     double findBestNeighbor(const TSP& tsp , const TSPSolution& currSol , TSPMove& move );
     double findFirstBestNeighbor(const TSP &tsp, const TSPSolution &currSol, TSPMove &move);
 
-    TSPSolution& swap(TSPSolution& tspSol , const TSPMove& move );
+    double findBestCandidateNeighbor(const TSP& tsp, const TSPSolution& currSol, TSPMove& move);
+    double findFirstBestCandidateNeighbor(const TSP& tsp, const TSPSolution& currSol, TSPMove& move);
 
     bool isTabuMove(int from, int to);
 
+    void collectTabuMoves();
+
+    // counted in locals during a scan, added to SolverMetrics once at its end
+    struct ScanCounts {
+        uint64_t evaluated;
+        uint64_t tabuRejected;
+        uint64_t aspirationAccepted;
+
+        ScanCounts() : evaluated(0), tabuRejected(0), aspirationAccepted(0) {}
+
+        void add() const {
+            SolverMetrics::add(SolverMetrics::MOVES_EVALUATED, evaluated);
+            SolverMetrics::add(SolverMetrics::TABU_REJECTED, tabuRejected);
+            SolverMetrics::add(SolverMetrics::ASPIRATION_ACCEPTED, aspirationAccepted);
+        }
+    };
+
 };
 
 #endif /* TSPSOLVER_H */
@@ -0,0 +1,104 @@
+/**
+ * @file ThreadPool.cpp
+ * @brief Persistent pool of worker threads
+ */
+
+#include "ThreadPool.h"
+
+using namespace std;
+
+ThreadPool::ThreadPool(int threads)
+    : mTask(NULL), mCount(0), mNext(0), mRunning(0), mGeneration(0), mStop(false)
+{
+    for (int t = 1; t < threads; t++) {
+        mWorkers.push_back(thread(&ThreadPool::workerLoop, this));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWake.notify_all();
+    for (size_t t = 0; t < mWorkers.size(); t++) {
+        mWorkers[t].join();
+    }
+}
+
+int ThreadPool::defaultThreads() {
+    int threads = (int)thread::hardware_concurrency();
+    return threads > 0 ? threads : 1;
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::run(int count, const function<void(int)>& task) {
+    unique_lock<mutex> busy(mRunMutex, try_to_lock);
+
+    if (mWorkers.empty() || count <= 1 || !busy.owns_lock()) {
+        for (int k = 0; k < count; k++) {
+            task(k);
+        }
+        return;
+    }
+
+    unique_lock<mutex> lock(mMutex);
+    mTask = &task;
+    mCount = count;
+    mNext = 0;
+    mRunning = 0;
+    mError = exception_ptr();
+    mGeneration++;
+    mWake.notify_all();
+
+    drain(lock);
+    mDone.wait(lock, [this] { return mNext == mCount && mRunning == 0; });
+
+    mTask = NULL;
+    if (mError) {
+        rethrow_exception(mError);
+    }
+}
+
+void ThreadPool::drain(unique_lock<mutex>& lock) {
+    while (mTask != NULL && mNext < mCount) {
+        int k = mNext++;
+        mRunning++;
+        const function<void(int)>& task = *mTask;
+
+        lock.unlock();
+        try {
+            task(k);
+        }
+        catch (...) {
+            lock.lock();
+            if (!mError) {
+                mError = current_exception();
+            }
+            lock.unlock();
+        }
+        lock.lock();
+
+        if (--mRunning == 0 && mNext == mCount) {
+            mDone.notify_all();
+        }
+    }
+}
+
+void ThreadPool::workerLoop() {
+    unsigned long seen = 0;
+
+    unique_lock<mutex> lock(mMutex);
+    while (true) {
+        mWake.wait(lock, [&] { return mStop || mGeneration != seen; });
+        if (mStop) {
+            return;
+        }
+        seen = mGeneration;
+        drain(lock);
+    }
+}
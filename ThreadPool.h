@@ -0,0 +1,81 @@
+/**
+ * @file ThreadPool.h
+ * @brief Persistent pool of worker threads
+ *
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+/**
+ * Fixed set of threads started once and reused for every parallel loop, so a
+ * neighbourhood scan does not pay thread creation at each iteration.
+ *
+ * run() hands the tasks 0 ... count-1 out to the workers and to the calling
+ * thread, and returns when all of them are done. A single loop runs at a time:
+ * if the pool is already busy (another thread is inside run()) the tasks are
+ * executed by the caller alone.
+ */
+class ThreadPool
+{
+public:
+
+    /**
+     * @param threads threads taking part in a loop, the calling thread included
+     */
+    explicit ThreadPool(int threads = defaultThreads());
+
+    ~ThreadPool();
+
+    /** threads taking part in a loop, the calling thread included */
+    inline int size() const {
+        return (int)mWorkers.size() + 1;
+    }
+
+    /**
+     * run task(0) ... task(count-1) in parallel
+     * @throw the first exception thrown by a task, after all tasks ended
+     */
+    void run(int count, const std::function<void(int)>& task);
+
+    /** hardware threads of the machine */
+    static int defaultThreads();
+
+    /** process wide pool with defaultThreads() threads, started on first use */
+    static ThreadPool& shared();
+
+private:
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    void workerLoop();
+
+    // take and run tasks of the current loop until there are none left
+    void drain(std::unique_lock<std::mutex>& lock);
+
+    std::vector<std::thread> mWorkers;
+
+    std::mutex mRunMutex;           // held by the thread inside run()
+
+    std::mutex mMutex;              // guards everything below
+    std::condition_variable mWake;
+    std::condition_variable mDone;
+
+    const std::function<void(int)>* mTask;
+    int mCount;
+    int mNext;                      // next task to hand out
+    int mRunning;                   // tasks handed out and not finished
+    unsigned long mGeneration;      // incremented at each loop
+    bool mStop;
+    std::exception_ptr mError;
+};
+
+#endif /* THREADPOOL_H */
@@ -0,0 +1,26 @@
+/**
+ * @file Tour.cpp
+ * @brief Tour representations for city driven local search
+ */
+
+#include "Tour.h"
+#include "ArrayTour.h"
+#include "TwoLevelListTour.h"
+
+Tour* Tour::create(Type type, int n) {
+    if (type == AUTO) {
+        type = (n >= TWO_LEVEL_MIN_NODES) ? TWO_LEVEL : ARRAY;
+    }
+    if (type == TWO_LEVEL) {
+        return new TwoLevelListTour(n);
+    }
+    return new ArrayTour(n);
+}
+
+const char* Tour::typeName(Type type) {
+    switch (type) {
+    case ARRAY:     return "array";
+    case TWO_LEVEL: return "two-level list";
+    default:        return "auto";
+    }
+}
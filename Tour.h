@@ -0,0 +1,70 @@
+/**
+ * @file Tour.h
+ * @brief Tour representations for city driven local search
+ *
+ */
+
+#ifndef TOUR_H
+#define TOUR_H
+
+#include <vector>
+
+/**
+ * Cyclic tour over the nodes 0 ... n-1, seen through the operations of 2-opt
+ * based search: successor, predecessor, order test and flip.
+ *
+ * Implementations:
+ *  ArrayTour         node array + position index: next / prev O(1), flip O(n) (at most n / 2 nodes)
+ *  TwoLevelListTour  doubly-linked segments of about sqrt(n) nodes: next / prev O(1), flip O(sqrt(n))
+ *
+ * Tour::create() picks the representation, AUTO uses the array below
+ * TWO_LEVEL_MIN_NODES nodes.
+ */
+class Tour
+{
+public:
+
+    enum Type {
+        ARRAY,
+        TWO_LEVEL,
+        AUTO
+    };
+
+    static const int TWO_LEVEL_MIN_NODES = 5000;
+
+    /**
+     * new tour of n nodes (owned by the caller)
+     */
+    static Tour* create(Type type, int n);
+
+    static const char* typeName(Type type);
+
+    virtual ~Tour() {}
+
+    virtual int size() const = 0;
+
+    /**
+     * set the tour from a TSPSolution sequence (node 0 first and last)
+     */
+    virtual void load(const std::vector<int>& sequence) = 0;
+
+    /**
+     * write the tour as a TSPSolution sequence: from node 0, n + 1 entries
+     */
+    virtual void toSequence(std::vector<int>& sequence) const = 0;
+
+    virtual int next(int a) const = 0;
+
+    virtual int prev(int a) const = 0;
+
+    /** true if b is on the path going forward from a to c (a and c included) */
+    virtual bool between(int a, int b, int c) const = 0;
+
+    /**
+     * 2-opt move: with b = next(a) and d = next(c) replace the edges (a, b) and (c, d)
+     * by (a, c) and (b, d), reversing one of the two paths b ... c or d ... a
+     */
+    virtual void flip(int a, int b, int c, int d) = 0;
+};
+
+#endif /* TOUR_H */
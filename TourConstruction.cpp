@@ -0,0 +1,498 @@
+/**
+ * @file TourConstruction.cpp
+ * @brief Constructive heuristics for initial tours
+ */
+
+#include "TourConstruction.h"
+
+#include <algorithm>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <stdint.h>
+
+#include "CandidateLists.h"
+
+using namespace std;
+
+namespace {
+
+// partial tour as a doubly-linked cycle, for the insertion heuristics
+struct LinkedTour {
+    vector<int> next, prev;
+    vector<bool> inserted;
+    int size;
+
+    // the cycle holding node first alone
+    LinkedTour(int n, int first) : next(n, -1), prev(n, -1), inserted(n, false), size(1) {
+        next[first] = prev[first] = first;
+        inserted[first] = true;
+    }
+
+    // x between a and b = next[a]
+    void insert(int x, int a) {
+        int b = next[a];
+        next[a] = x;
+        prev[x] = a;
+        next[x] = b;
+        prev[b] = x;
+        inserted[x] = true;
+        size++;
+    }
+
+    void toOrder(int first, vector<int>& tour) const {
+        tour.clear();
+        int a = first;
+        do {
+            tour.push_back(a);
+            a = next[a];
+        } while (a != first);
+    }
+};
+
+inline double insertionCost(const TSP& tsp, int a, int x, int b) {
+    return tsp.cost(a, x) + tsp.cost(x, b) - tsp.cost(a, b);
+}
+
+// cheapest insertion of x next to its inserted candidates
+// @return false if none of them is in the tour
+bool candidateInsertion(const TSP& tsp, const CandidateLists& cand, const LinkedTour& t, int x,
+                        double& bestCost, int& bestA) {
+    bestA = -1;
+    for (const int* it = cand.begin(x); it != cand.end(x); ++it) {
+        int y = *it;
+        if (!t.inserted[y]) {
+            continue;
+        }
+        // edges (prev y, y) and (y, next y)
+        double before = insertionCost(tsp, t.prev[y], x, y);
+        if (bestA < 0 || before < bestCost) {
+            bestCost = before;
+            bestA = t.prev[y];
+        }
+        double after = insertionCost(tsp, y, x, t.next[y]);
+        if (after < bestCost) {
+            bestCost = after;
+            bestA = y;
+        }
+    }
+    return bestA >= 0;
+}
+
+// cheapest insertion of x on the whole tour, O(tour)
+void fullInsertion(const TSP& tsp, const LinkedTour& t, int x, int first, double& bestCost, int& bestA) {
+    bestA = -1;
+    int a = first;
+    do {
+        double cost = insertionCost(tsp, a, x, t.next[a]);
+        if (bestA < 0 || cost < bestCost) {
+            bestCost = cost;
+            bestA = a;
+        }
+        a = t.next[a];
+    } while (a != first);
+}
+
+// Hilbert curve index of (x, y) in a 2^16 x 2^16 grid
+uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+    const uint32_t side = 1u << 16;
+    uint64_t d = 0;
+    for (uint32_t s = side / 2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        d += (uint64_t)s * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = side - 1 - x;
+                y = side - 1 - y;
+            }
+            swap(x, y);
+        }
+    }
+    return d;
+}
+
+}
+
+
+const char* TourConstruction::methodName(Method method) {
+    switch (method) {
+    case NEAREST_NEIGHBOR:    return "nn";
+    case GREEDY:              return "greedy";
+    case SPACE_FILLING_CURVE: return "sfc";
+    case CHEAPEST_INSERTION:  return "cheapest";
+    case FARTHEST_INSERTION:  return "farthest";
+    default:                  return "random";
+    }
+}
+
+TourConstruction::Method TourConstruction::parseMethod(const string& name) {
+    const Method methods[] = { RANDOM, NEAREST_NEIGHBOR, GREEDY, SPACE_FILLING_CURVE, CHEAPEST_INSERTION, FARTHEST_INSERTION };
+    for (size_t k = 0; k < sizeof(methods) / sizeof(methods[0]); k++) {
+        if (name == methodName(methods[k])) {
+            return methods[k];
+        }
+    }
+    throw runtime_error("unknown initial tour '" + name + "' (random, nn, greedy, sfc, cheapest or farthest)");
+}
+
+void TourConstruction::build(const TSP& tsp, Method method, TSPSolution& sol, int seed) {
+    if (method == RANDOM) {
+        sol.initRandom(seed);
+        sol.evaluate(tsp);
+        return;
+    }
+    if (method == SPACE_FILLING_CURVE && tsp.coordinates() == NULL) {
+        throw runtime_error("the space-filling curve tour needs node coordinates");
+    }
+
+    const int n = tsp.n;
+    vector<int> tour;
+
+    if (n <= 3) {
+        for (int i = 0; i < n; i++) {
+            tour.push_back(i);
+        }
+    } else if (method == SPACE_FILLING_CURVE) {
+        spaceFillingCurve(tsp, tour);
+    } else {
+        const CandidateLists* cand = tsp.candidates();
+        unique_ptr<CandidateLists> own;
+        if (cand == NULL) {
+            own.reset(new CandidateLists(tsp, DEFAULT_K));
+            cand = own.get();
+        }
+
+        switch (method) {
+        case NEAREST_NEIGHBOR:   nearestNeighbor(tsp, *cand, tour); break;
+        case GREEDY:             greedy(tsp, *cand, tour); break;
+        case CHEAPEST_INSERTION: cheapestInsertion(tsp, *cand, tour); break;
+        default:                 farthestInsertion(tsp, *cand, tour); break;
+        }
+    }
+
+    // TSPSolution order: from node 0, back to node 0
+    int start = find(tour.begin(), tour.end(), 0) - tour.begin();
+    sol.sequence.resize(n + 1);
+    for (int k = 0; k < n; k++) {
+        sol.sequence[k] = tour[(start + k) % n];
+    }
+    sol.sequence[n] = 0;
+    sol.evaluate(tsp);
+}
+
+void TourConstruction::nearestNeighbor(const TSP& tsp, const CandidateLists& cand, vector<int>& tour) {
+    const int n = tsp.n;
+
+    // unvisited nodes, removed by swapping with the last one
+    vector<int> rest(n), where(n);
+    for (int i = 0; i < n; i++) {
+        rest[i] = where[i] = i;
+    }
+    int remaining = n;
+
+    tour.clear();
+    int c = 0;
+    for (;;) {
+        tour.push_back(c);
+        int last = rest[--remaining];
+        rest[where[c]] = last;
+        where[last] = where[c];
+        where[c] = -1;
+
+        if (remaining == 0) {
+            break;
+        }
+
+        // candidates are sorted: the first unvisited one is the nearest
+        int next = -1;
+        for (const int* it = cand.begin(c); it != cand.end(c); ++it) {
+            if (where[*it] >= 0) {
+                next = *it;
+                break;
+            }
+        }
+        if (next < 0) {
+            double best = 0;
+            for (int k = 0; k < remaining; k++) {
+                double cost = tsp.cost(c, rest[k]);
+                if (next < 0 || cost < best) {
+                    best = cost;
+                    next = rest[k];
+                }
+            }
+        }
+        c = next;
+    }
+}
+
+void TourConstruction::greedy(const TSP& tsp, const CandidateLists& cand, vector<int>& tour) {
+    const int n = tsp.n;
+
+    struct Edge {
+        double cost;
+        int i, j;
+        bool operator<(const Edge& other) const {
+            if (cost != other.cost) {
+                return cost < other.cost;
+            }
+            return i < other.i || (i == other.i && j < other.j);
+        }
+        bool operator==(const Edge& other) const {
+            return i == other.i && j == other.j;
+        }
+    };
+
+    vector<Edge> edges;
+    edges.reserve((size_t)n * cand.k());
+    for (int i = 0; i < n; i++) {
+        for (const int* it = cand.begin(i); it != cand.end(i); ++it) {
+            Edge e;
+            e.i = min(i, *it);
+            e.j = max(i, *it);
+            e.cost = tsp.cost(e.i, e.j);
+            edges.push_back(e);
+        }
+    }
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+    // fragments: degree <= 2, no cycle (union-find)
+    vector<int> degree(n, 0), parent(n), adjacent(2 * n, -1);
+    for (int i = 0; i < n; i++) {
+        parent[i] = i;
+    }
+    for (size_t e = 0; e < edges.size(); e++) {
+        int i = edges[e].i, j = edges[e].j;
+        if (degree[i] == 2 || degree[j] == 2) {
+            continue;
+        }
+        int ri = i, rj = j;
+        while (parent[ri] != ri) {
+            ri = parent[ri] = parent[parent[ri]];
+        }
+        while (parent[rj] != rj) {
+            rj = parent[rj] = parent[parent[rj]];
+        }
+        if (ri == rj) {
+            continue;
+        }
+        parent[ri] = rj;
+        adjacent[2 * i + degree[i]++] = j;
+        adjacent[2 * j + degree[j]++] = i;
+    }
+
+    // fragments as paths: order[fragBegin[f] ... fragBegin[f+1])
+    vector<int> order, fragBegin;
+    vector<bool> seen(n, false);
+    order.reserve(n);
+    for (int s = 0; s < n; s++) {
+        if (seen[s] || degree[s] == 2) {
+            continue;
+        }
+        fragBegin.push_back(order.size());
+        int prev = -1, a = s;
+        while (a >= 0) {
+            seen[a] = true;
+            order.push_back(a);
+            int next = (adjacent[2 * a] != prev) ? adjacent[2 * a] : adjacent[2 * a + 1];
+            if (degree[a] == 1 && prev >= 0) {
+                next = -1;      // other end of the path
+            }
+            prev = a;
+            a = next;
+        }
+    }
+    const int fragments = fragBegin.size();
+    fragBegin.push_back(order.size());
+
+    // join the fragments: from the current end, the nearest end of another fragment
+    vector<bool> used(fragments, false);
+    tour.clear();
+    int f = 0;
+    for (int joined = 0; joined < fragments; joined++) {
+        used[f] = true;
+        const int first = fragBegin[f], last = fragBegin[f + 1] - 1;
+        bool reversed = false;
+        if (!tour.empty()) {
+            int end = tour.back();
+            reversed = tsp.cost(end, order[last]) < tsp.cost(end, order[first]);
+        }
+        if (reversed) {
+            for (int k = last; k >= first; k--) {
+                tour.push_back(order[k]);
+            }
+        } else {
+            for (int k = first; k <= last; k++) {
+                tour.push_back(order[k]);
+            }
+        }
+
+        int end = tour.back();
+        int nextF = -1;
+        double best = 0;
+        for (int g = 0; g < fragments; g++) {
+            if (used[g]) {
+                continue;
+            }
+            double cost = min(tsp.cost(end, order[fragBegin[g]]), tsp.cost(end, order[fragBegin[g + 1] - 1]));
+            if (nextF < 0 || cost < best) {
+                best = cost;
+                nextF = g;
+            }
+        }
+        f = nextF;
+    }
+}
+
+void TourConstruction::spaceFillingCurve(const TSP& tsp, vector<int>& tour) {
+    const TSPCoordinates& coords = *tsp.coordinates();
+    const int n = tsp.n;
+
+    double minX = coords.x(0), maxX = coords.x(0);
+    double minY = coords.y(0), maxY = coords.y(0);
+    for (int i = 1; i < n; i++) {
+        minX = min(minX, coords.x(i));
+        maxX = max(maxX, coords.x(i));
+        minY = min(minY, coords.y(i));
+        maxY = max(maxY, coords.y(i));
+    }
+    // same scale on both axes
+    const double scale = 65535.0 / max(max(maxX - minX, maxY - minY), 1e-9);
+
+    vector< pair<uint64_t, int> > keys(n);
+    for (int i = 0; i < n; i++) {
+        uint32_t x = (uint32_t)((coords.x(i) - minX) * scale);
+        uint32_t y = (uint32_t)((coords.y(i) - minY) * scale);
+        keys[i] = make_pair(hilbertIndex(x, y), i);
+    }
+    sort(keys.begin(), keys.end());
+
+    tour.resize(n);
+    for (int i = 0; i < n; i++) {
+        tour[i] = keys[i].second;
+    }
+}
+
+void TourConstruction::cheapestInsertion(const TSP& tsp, const CandidateLists& cand, vector<int>& tour) {
+    const int n = tsp.n;
+
+    // reverse lists: the nodes having y as a candidate
+    vector<int> revBegin(n + 1, 0), revNodes;
+    for (int x = 0; x < n; x++) {
+        for (const int* it = cand.begin(x); it != cand.end(x); ++it) {
+            revBegin[*it + 1]++;
+        }
+    }
+    for (int y = 0; y < n; y++) {
+        revBegin[y + 1] += revBegin[y];
+    }
+    revNodes.resize(revBegin[n]);
+    vector<int> fill(revBegin.begin(), revBegin.end() - 1);
+    for (int x = 0; x < n; x++) {
+        for (const int* it = cand.begin(x); it != cand.end(x); ++it) {
+            revNodes[fill[*it]++] = x;
+        }
+    }
+
+    // insertion of x after a, valid while next[a] is still b
+    struct Insertion {
+        double cost;
+        int x, a, b;
+        bool operator<(const Insertion& other) const {    // reversed: cheapest on top
+            return cost > other.cost || (cost == other.cost && x > other.x);
+        }
+    };
+    priority_queue<Insertion> queue;
+
+    LinkedTour t(n, 0);
+    int scan = 0;     // no node below is left out of the tour
+
+    int x = 0;
+    for (;;) {
+        // x has just been inserted: the nodes having it as a candidate may now go next to it
+        for (int k = revBegin[x]; k < revBegin[x + 1]; k++) {
+            Insertion ins;
+            ins.x = revNodes[k];
+            if (!t.inserted[ins.x] && candidateInsertion(tsp, cand, t, ins.x, ins.cost, ins.a)) {
+                ins.b = t.next[ins.a];
+                queue.push(ins);
+            }
+        }
+        if (t.size == n) {
+            break;
+        }
+
+        for (;;) {
+            if (queue.empty()) {
+                // no candidate of the remaining nodes in the tour: any node, anywhere
+                while (t.inserted[scan]) {
+                    scan++;
+                }
+                Insertion ins;
+                ins.x = scan;
+                fullInsertion(tsp, t, ins.x, 0, ins.cost, ins.a);
+                ins.b = t.next[ins.a];
+                queue.push(ins);
+            }
+
+            Insertion ins = queue.top();
+            queue.pop();
+            if (t.inserted[ins.x]) {
+                continue;
+            }
+            if (t.next[ins.a] != ins.b) {
+                // the edge is gone: look again
+                if (candidateInsertion(tsp, cand, t, ins.x, ins.cost, ins.a)) {
+                    ins.b = t.next[ins.a];
+                    queue.push(ins);
+                }
+                continue;
+            }
+            t.insert(ins.x, ins.a);
+            x = ins.x;
+            break;
+        }
+    }
+
+    t.toOrder(0, tour);
+}
+
+void TourConstruction::farthestInsertion(const TSP& tsp, const CandidateLists& cand, vector<int>& tour) {
+    const int n = tsp.n;
+
+    LinkedTour t(n, 0);
+
+    // distance of the remaining nodes to the tour
+    vector<int> rest;
+    vector<double> distance(n);
+    for (int i = 1; i < n; i++) {
+        rest.push_back(i);
+        distance[i] = tsp.cost(0, i);
+    }
+
+    while (!rest.empty()) {
+        size_t far = 0;
+        for (size_t k = 1; k < rest.size(); k++) {
+            if (distance[rest[k]] > distance[rest[far]]) {
+                far = k;
+            }
+        }
+        int x = rest[far];
+        rest[far] = rest.back();
+        rest.pop_back();
+
+        double cost;
+        int a;
+        if (!candidateInsertion(tsp, cand, t, x, cost, a)) {
+            fullInsertion(tsp, t, x, 0, cost, a);
+        }
+        t.insert(x, a);
+
+        for (size_t k = 0; k < rest.size(); k++) {
+            distance[rest[k]] = min(distance[rest[k]], tsp.cost(x, rest[k]));
+        }
+    }
+
+    t.toOrder(0, tour);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file TourConstruction.h
+ * @brief Constructive heuristics for initial tours
+ *
+ */
+
+#ifndef TOURCONSTRUCTION_H
+#define TOURCONSTRUCTION_H
+
+#include <vector>
+#include <string>
+
+#include "TSP.h"
+#include "TSPSolution.h"
+
+class CandidateLists;
+
+/**
+ * Initial tours better than a random permutation, so that the solvers start
+ * from a tour a few percent to a few tens of percent above the optimum.
+ *
+ *  NEAREST_NEIGHBOR     from node 0, go to the nearest unvisited candidate; a full
+ *                       scan only when every candidate was visited. About O(n k)
+ *  GREEDY               candidate edges by increasing cost, kept if both ends have
+ *                       degree < 2 and no cycle closes; the fragments are then
+ *                       joined nearest end first. O(n k log(n k)) + O(f^2) for f fragments
+ *  SPACE_FILLING_CURVE  nodes in Hilbert curve order, O(n log n). Coordinate instances only
+ *  CHEAPEST_INSERTION   insert the node with the cheapest insertion, looked up next to
+ *                       its candidates (priority queue). About O(n k log n)
+ *  FARTHEST_INSERTION   insert the node farthest from the tour at its cheapest place
+ *                       next to its candidates. O(n^2) for the selection
+ *
+ * Candidate lists are those of the instance (TSP::buildCandidateLists) or, if
+ * there are none, DEFAULT_K nearest neighbours built for the construction.
+ */
+class TourConstruction
+{
+public:
+
+    enum Method {
+        RANDOM,
+        NEAREST_NEIGHBOR,
+        GREEDY,
+        SPACE_FILLING_CURVE,
+        CHEAPEST_INSERTION,
+        FARTHEST_INSERTION
+    };
+
+    static const int DEFAULT_K = 10;
+
+    /** command line name: random, nn, greedy, sfc, cheapest, farthest */
+    static const char* methodName(Method method);
+
+    /**
+     * @throw std::runtime_error for an unknown name
+     */
+    static Method parseMethod(const std::string& name);
+
+    /**
+     * set sol to the tour built by method (node 0 first and last) and evaluate it
+     * @param seed only for RANDOM
+     * @throw std::runtime_error for SPACE_FILLING_CURVE on a matrix instance
+     */
+    static void build(const TSP& tsp, Method method, TSPSolution& sol, int seed = 42);
+
+private:
+
+    // tours as n nodes in tour order, any first node
+    static void nearestNeighbor(const TSP& tsp, const CandidateLists& cand, std::vector<int>& tour);
+    static void greedy(const TSP& tsp, const CandidateLists& cand, std::vector<int>& tour);
+    static void spaceFillingCurve(const TSP& tsp, std::vector<int>& tour);
+    static void cheapestInsertion(const TSP& tsp, const CandidateLists& cand, std::vector<int>& tour);
+    static void farthestInsertion(const TSP& tsp, const CandidateLists& cand, std::vector<int>& tour);
+};
+
+#endif /* TOURCONSTRUCTION_H */
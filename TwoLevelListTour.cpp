@@ -0,0 +1,247 @@
+/**
+ * @file TwoLevelListTour.cpp
+ * @brief Tour stored as a two-level doubly-linked list
+ */
+
+#include "TwoLevelListTour.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+TwoLevelListTour::TwoLevelListTour(int n)
+    : mN(n), mGroupSize(max(8, (int)sqrt((double)n))), mMaxSegments(0),
+      mNext(n), mPrev(n), mRank(n), mSeg(n)
+{
+    vector<int> order(n);
+    for (int i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    layout(&order[0]);
+}
+
+void TwoLevelListTour::load(const vector<int>& sequence) {
+    layout(&sequence[0]);
+}
+
+void TwoLevelListTour::toSequence(vector<int>& sequence) const {
+    sequence.resize(mN + 1);
+    int a = 0;
+    for (int k = 0; k < mN; k++) {
+        sequence[k] = a;
+        a = next(a);
+    }
+    sequence[mN] = 0;
+}
+
+void TwoLevelListTour::layout(const int* order) {
+    const int segments = (mN + mGroupSize - 1) / mGroupSize;
+
+    mSegments.assign(segments, Segment());
+    mMaxSegments = 2 * segments;
+
+    for (int s = 0; s < segments; s++) {
+        Segment& segment = mSegments[s];
+        int begin = s * mGroupSize;
+        int end = min(mN, begin + mGroupSize);
+
+        segment.first = order[begin];
+        segment.last = order[end - 1];
+        segment.size = end - begin;
+        segment.reversed = false;
+        segment.rank = s;
+        segment.prev = (s == 0) ? segments - 1 : s - 1;
+        segment.next = (s == segments - 1) ? 0 : s + 1;
+
+        for (int k = begin; k < end; k++) {
+            int a = order[k];
+            mPrev[a] = (k == begin) ? -1 : order[k - 1];
+            mNext[a] = (k == end - 1) ? -1 : order[k + 1];
+            mRank[a] = k - begin;
+            mSeg[a] = s;
+        }
+    }
+}
+
+void TwoLevelListTour::flip(int a, int b, int c, int d) {
+    if (a == c || b == d) {
+        return;
+    }
+
+    // a path inside a single segment is relinked in place
+    if (mSeg[b] == mSeg[c] && before(b, c)) {
+        reverseInside(b, c);
+        return;
+    }
+    if (mSeg[d] == mSeg[a] && before(d, a)) {
+        reverseInside(d, a);
+        return;
+    }
+
+    // otherwise reverse the path spanning fewer segments
+    if (pathSegments(d, a) < pathSegments(b, c)) {
+        reverseSegments(d, a);
+    } else {
+        reverseSegments(b, c);
+    }
+
+    if (mSegments.size() > mMaxSegments) {
+        mBuffer.resize(mN);
+        int x = head(0);
+        for (int k = 0; k < mN; k++) {
+            mBuffer[k] = x;
+            x = next(x);
+        }
+        layout(&mBuffer[0]);
+    }
+}
+
+int TwoLevelListTour::pathSegments(int x, int y) const {
+    const int segments = mSegments.size();
+    int sx = mSegments[mSeg[x]].rank;
+    int sy = mSegments[mSeg[y]].rank;
+    if (sx == sy && !before(x, y)) {
+        return segments + 1;    // wraps around the whole tour
+    }
+    return (sy - sx + segments) % segments + 1;
+}
+
+void TwoLevelListTour::reverseInside(int x, int y) {
+    Segment& segment = mSegments[mSeg[x]];
+
+    // p ... q in link order
+    int p = segment.reversed ? y : x;
+    int q = segment.reversed ? x : y;
+
+    mBuffer.clear();
+    for (int a = p; ; a = mNext[a]) {
+        mBuffer.push_back(a);
+        if (a == q) {
+            break;
+        }
+    }
+
+    const int m = mBuffer.size();
+    const int before = mPrev[p];
+    const int after = mNext[q];
+    const int rank = mRank[p];
+
+    for (int k = 0; k < m; k++) {
+        int a = mBuffer[m - 1 - k];
+        mRank[a] = rank + k;
+        mPrev[a] = (k == 0) ? before : mBuffer[m - k];
+        mNext[a] = (k == m - 1) ? after : mBuffer[m - 2 - k];
+    }
+
+    if (before >= 0) {
+        mNext[before] = q;
+    } else {
+        segment.first = q;
+    }
+    if (after >= 0) {
+        mPrev[after] = p;
+    } else {
+        segment.last = p;
+    }
+}
+
+void TwoLevelListTour::splitBefore(int x) {
+    const int s = mSeg[x];
+    if (x == head(s)) {
+        return;
+    }
+
+    // cut between u and v, consecutive in link order
+    int u, v;
+    if (!mSegments[s].reversed) {
+        u = mPrev[x];
+        v = x;
+    } else {
+        u = x;
+        v = mNext[x];
+    }
+
+    const int sizeA = mRank[v] - mRank[mSegments[s].first];     // first ... u
+    const int sizeB = mSegments[s].size - sizeA;                 // v ... last
+    const bool moveA = sizeA <= sizeB;
+
+    // the moved part becomes a new segment, before s if it comes first in tour order
+    const bool insertBefore = (moveA != mSegments[s].reversed);
+
+    Segment moved;
+    moved.reversed = mSegments[s].reversed;
+    moved.rank = mSegments[s].rank;
+    if (moveA) {
+        moved.first = mSegments[s].first;
+        moved.last = u;
+        moved.size = sizeA;
+        mSegments[s].first = v;
+        mSegments[s].size = sizeB;
+    } else {
+        moved.first = v;
+        moved.last = mSegments[s].last;
+        moved.size = sizeB;
+        mSegments[s].last = u;
+        mSegments[s].size = sizeA;
+    }
+    mNext[u] = -1;
+    mPrev[v] = -1;
+
+    const int t = mSegments.size();
+    if (insertBefore) {
+        moved.prev = mSegments[s].prev;
+        moved.next = s;
+    } else {
+        moved.prev = s;
+        moved.next = mSegments[s].next;
+    }
+    mSegments.push_back(moved);
+    mSegments[mSegments[t].prev].next = t;
+    mSegments[mSegments[t].next].prev = t;
+
+    for (int a = moved.first; a >= 0; a = mNext[a]) {
+        mSeg[a] = t;
+    }
+}
+
+void TwoLevelListTour::reverseSegments(int x, int y) {
+    // y is followed by a node outside the path: cut there and before x
+    int afterY = next(y);
+    splitBefore(x);
+    splitBefore(afterY);
+
+    const int first = mSeg[x];
+    const int last = mSeg[y];
+    const int before = mSegments[first].prev;
+    const int after = mSegments[last].next;
+
+    mBuffer.clear();
+    for (int s = first; ; s = mSegments[s].next) {
+        mBuffer.push_back(s);
+        if (s == last) {
+            break;
+        }
+    }
+
+    // new order: before, last ... first, after
+    const int k = mBuffer.size();
+    for (int i = 0; i < k; i++) {
+        Segment& segment = mSegments[mBuffer[i]];
+        segment.reversed = !segment.reversed;
+        segment.next = (i == 0) ? after : mBuffer[i - 1];
+        segment.prev = (i == k - 1) ? before : mBuffer[i + 1];
+    }
+    mSegments[before].next = last;
+    mSegments[after].prev = first;
+
+    renumberSegments();
+}
+
+void TwoLevelListTour::renumberSegments() {
+    int s = 0;
+    for (size_t rank = 0; rank < mSegments.size(); rank++) {
+        mSegments[s].rank = rank;
+        s = mSegments[s].next;
+    }
+}
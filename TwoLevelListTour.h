@@ -0,0 +1,126 @@
+/**
+ * @file TwoLevelListTour.h
+ * @brief Tour stored as a two-level doubly-linked list
+ *
+ */
+
+#ifndef TWOLEVELLISTTOUR_H
+#define TWOLEVELLISTTOUR_H
+
+#include <vector>
+#include <cstddef>
+
+#include "Tour.h"
+
+/**
+ * The tour is cut into segments of about sqrt(n) nodes. Nodes are doubly linked
+ * inside their segment and numbered in link order; segments form a doubly-linked
+ * ring, are numbered in tour order and carry a reversed bit telling in which
+ * direction the tour runs through them.
+ *
+ * A flip reverses the shorter of the two paths. A path inside one segment is
+ * relinked node by node; otherwise the segments at its two ends are split so
+ * that the path is made of whole segments, which are then reversed by toggling
+ * their bits and relinking the ring. Both cost O(sqrt(n)). Splits add segments:
+ * when there are twice as many as after the last layout, the list is rebuilt.
+ */
+class TwoLevelListTour final : public Tour
+{
+public:
+
+    explicit TwoLevelListTour(int n);
+
+    int size() const {
+        return mN;
+    }
+
+    void load(const std::vector<int>& sequence);
+
+    void toSequence(std::vector<int>& sequence) const;
+
+    inline int next(int a) const {
+        const Segment& s = mSegments[mSeg[a]];
+        if (!s.reversed) {
+            return a == s.last ? head(s.next) : mNext[a];
+        }
+        return a == s.first ? head(s.next) : mPrev[a];
+    }
+
+    inline int prev(int a) const {
+        const Segment& s = mSegments[mSeg[a]];
+        if (!s.reversed) {
+            return a == s.first ? tail(s.prev) : mPrev[a];
+        }
+        return a == s.last ? tail(s.prev) : mNext[a];
+    }
+
+    inline bool between(int a, int b, int c) const {
+        if (!before(a, c)) {
+            return before(a, b) || before(b, c);
+        }
+        return before(a, b) && before(b, c);
+    }
+
+    void flip(int a, int b, int c, int d);
+
+private:
+
+    struct Segment {
+        int first, last;    // end nodes in link order
+        int size;
+        bool reversed;      // the tour runs from last to first
+        int rank;           // position of the segment in the tour
+        int prev, next;     // neighbouring segments in tour order
+    };
+
+    // first and last node of segment s in tour order
+    inline int head(int s) const {
+        return mSegments[s].reversed ? mSegments[s].last : mSegments[s].first;
+    }
+
+    inline int tail(int s) const {
+        return mSegments[s].reversed ? mSegments[s].first : mSegments[s].last;
+    }
+
+    // a is not after b, in tour order from the segment of rank 0
+    inline bool before(int a, int b) const {
+        const Segment& sa = mSegments[mSeg[a]];
+        const Segment& sb = mSegments[mSeg[b]];
+        if (sa.rank != sb.rank) {
+            return sa.rank < sb.rank;
+        }
+        return sa.reversed ? mRank[a] >= mRank[b] : mRank[a] <= mRank[b];
+    }
+
+    // segments (as counted by rank) on the path from x forward to y
+    int pathSegments(int x, int y) const;
+
+    // reverse the path x ... y, inside a single segment
+    void reverseInside(int x, int y);
+
+    // cut the segment of x so that x is its first node in tour order
+    void splitBefore(int x);
+
+    // reverse the path x ... y, made of whole segments
+    void reverseSegments(int x, int y);
+
+    void renumberSegments();
+
+    // segments of about sqrt(n) nodes following the tour order
+    void layout(const int* order);
+
+    int mN;
+    int mGroupSize;
+    size_t mMaxSegments;            // rebuild above
+
+    std::vector<int> mNext;         // link order inside the segment, -1 at the ends
+    std::vector<int> mPrev;
+    std::vector<int> mRank;         // increasing in link order
+    std::vector<int> mSeg;
+
+    std::vector<Segment> mSegments;
+
+    std::vector<int> mBuffer;
+};
+
+#endif /* TWOLEVELLISTTOUR_H */
@@ -0,0 +1,180 @@
+/**
+ * @file TwoOptKernel.cpp
+ * @brief Vectorized 2-opt delta evaluation
+ */
+
+#include "TwoOptKernel.h"
+
+#include <cmath>
+#include <cstring>
+#include <immintrin.h>
+
+using namespace std;
+
+namespace {
+
+// the scalar loop over b in [from, last), also the tail of the vector versions
+double scanTail(const int* seq, const double* edge, int last, int a,
+                  const double* costH, const double* costI,
+                  const unsigned char* mask, int& bestB, int from, double best) {
+    const double costHI = costH[seq[a]];
+    for (int b = from; b < last; b++) {
+        if (mask != NULL && mask[b]) {
+            continue;
+        }
+        double delta = - costHI - edge[b] + costH[seq[b]] + costI[seq[b + 1]];
+        if (delta < best) {
+            best = delta;
+            bestB = b;
+        }
+    }
+    return best;
+}
+
+double scanScalar(const int* seq, const double* edge, int last, int a,
+                  const double* costH, const double* costI,
+                  const unsigned char* mask, int& bestB) {
+    bestB = -1;
+    return scanTail(seq, edge, last, a, costH, costI, mask, bestB, a + 1, HUGE_VAL);
+}
+
+// smallest value of the lanes, the first b among equal values
+inline double reduceLanes(const double* value, const double* index, int lanes, int& bestB) {
+    double best = HUGE_VAL;
+    bestB = -1;
+    for (int k = 0; k < lanes; k++) {
+        if (value[k] < best || (value[k] == best && index[k] < bestB)) {
+            best = value[k];
+            bestB = (int)index[k];
+        }
+    }
+    return best;
+}
+
+__attribute__((target("avx2")))
+double scanAVX2(const int* seq, const double* edge, int last, int a,
+                const double* costH, const double* costI,
+                const unsigned char* mask, int& bestB) {
+    const __m256d negHI = _mm256_set1_pd(-costH[seq[a]]);
+    const __m256d inf = _mm256_set1_pd(HUGE_VAL);
+    const __m256d step = _mm256_set1_pd(4.0);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+    // per lane running minimum and its position
+    __m256d best = inf;
+    __m256d bestIndex = _mm256_set1_pd(-1.0);
+    __m256d index = _mm256_setr_pd(a + 1, a + 2, a + 3, a + 4);
+
+    int b = a + 1;
+    for (; b + 4 <= last; b += 4) {
+        __m128i j = _mm_loadu_si128((const __m128i*)(seq + b));
+        __m128i l = _mm_loadu_si128((const __m128i*)(seq + b + 1));
+
+        __m256d delta = _mm256_sub_pd(negHI, _mm256_loadu_pd(edge + b));
+        delta = _mm256_add_pd(delta, _mm256_mask_i32gather_pd(zero, costH, j, all, 8));
+        delta = _mm256_add_pd(delta, _mm256_mask_i32gather_pd(zero, costI, l, all, 8));
+
+        if (mask != NULL) {
+            int m;
+            memcpy(&m, mask + b, sizeof(m));
+            if (m != 0) {
+                __m256i allowed = _mm256_cmpeq_epi64(_mm256_cvtepu8_epi64(_mm_cvtsi32_si128(m)),
+                                                     _mm256_setzero_si256());
+                delta = _mm256_blendv_pd(inf, delta, _mm256_castsi256_pd(allowed));
+            }
+        }
+
+        __m256d better = _mm256_cmp_pd(delta, best, _CMP_LT_OQ);
+        best = _mm256_blendv_pd(best, delta, better);
+        bestIndex = _mm256_blendv_pd(bestIndex, index, better);
+        index = _mm256_add_pd(index, step);
+    }
+
+    double value[4], position[4];
+    _mm256_storeu_pd(value, best);
+    _mm256_storeu_pd(position, bestIndex);
+
+    double result = reduceLanes(value, position, 4, bestB);
+    return scanTail(seq, edge, last, a, costH, costI, mask, bestB, b, result);
+}
+
+__attribute__((target("avx512f")))
+double scanAVX512(const int* seq, const double* edge, int last, int a,
+                  const double* costH, const double* costI,
+                  const unsigned char* mask, int& bestB) {
+    const __m512d negHI = _mm512_set1_pd(-costH[seq[a]]);
+    const __m512d step = _mm512_set1_pd(8.0);
+    const __m512d zero = _mm512_setzero_pd();
+
+    __m512d best = _mm512_set1_pd(HUGE_VAL);
+    __m512d bestIndex = _mm512_set1_pd(-1.0);
+    __m512d index = _mm512_setr_pd(a + 1, a + 2, a + 3, a + 4, a + 5, a + 6, a + 7, a + 8);
+
+    int b = a + 1;
+    for (; b + 8 <= last; b += 8) {
+        __m256i j = _mm256_loadu_si256((const __m256i*)(seq + b));
+        __m256i l = _mm256_loadu_si256((const __m256i*)(seq + b + 1));
+
+        __m512d delta = _mm512_sub_pd(negHI, _mm512_loadu_pd(edge + b));
+        delta = _mm512_add_pd(delta, _mm512_mask_i32gather_pd(zero, 0xFF, j, costH, 8));
+        delta = _mm512_add_pd(delta, _mm512_mask_i32gather_pd(zero, 0xFF, l, costI, 8));
+
+        __mmask8 better = _mm512_cmp_pd_mask(delta, best, _CMP_LT_OQ);
+        if (mask != NULL) {
+            __m512i m = _mm512_maskz_cvtepu8_epi64(0xFF, _mm_loadl_epi64((const __m128i*)(mask + b)));
+            better &= ~_mm512_test_epi64_mask(m, m);
+        }
+
+        best = _mm512_mask_mov_pd(best, better, delta);
+        bestIndex = _mm512_mask_mov_pd(bestIndex, better, index);
+        index = _mm512_add_pd(index, step);
+    }
+
+    double value[8], position[8];
+    _mm512_storeu_pd(value, best);
+    _mm512_storeu_pd(position, bestIndex);
+
+    double result = reduceLanes(value, position, 8, bestB);
+    return scanTail(seq, edge, last, a, costH, costI, mask, bestB, b, result);
+}
+
+}
+
+
+TwoOptKernel::Isa TwoOptKernel::detect() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return AVX2;
+    }
+    return SCALAR;
+}
+
+const char* TwoOptKernel::isaName(Isa isa) {
+    switch (isa) {
+    case AVX512: return "AVX-512";
+    case AVX2:   return "AVX2";
+    default:     return "scalar";
+    }
+}
+
+TwoOptKernel::TwoOptKernel(Isa isa) : mIsa(isa), mSeq(NULL), mLast(0) {
+    switch (mIsa) {
+    case AVX512: mScan = scanAVX512; break;
+    case AVX2:   mScan = scanAVX2; break;
+    default:     mScan = scanScalar; break;
+    }
+}
+
+void TwoOptKernel::load(const TSP& tsp, const TSPSolution& sol) {
+    mSeq = &sol.sequence[0];
+    mLast = (int)sol.sequence.size() - 1;
+
+    mEdge.resize(mLast);
+    for (int b = 0; b < mLast; b++) {
+        mEdge[b] = tsp.cost(mSeq[b], mSeq[b + 1]);
+    }
+}
@@ -0,0 +1,84 @@
+/**
+ * @file TwoOptKernel.h
+ * @brief Vectorized 2-opt delta evaluation
+ *
+ */
+
+#ifndef TWOOPTKERNEL_H
+#define TWOOPTKERNEL_H
+
+#include <vector>
+
+#include "TSP.h"
+#include "TSPSolution.h"
+
+/**
+ * Evaluates the 2-opt moves (a, b) of a tour for a fixed a and all b at once.
+ *
+ * The delta -c(h,i) - c(j,l) + c(h,j) + c(i,l) is computed 4 (AVX2) or 8
+ * (AVX-512) positions b per instruction: c(h,j) and c(i,l) are gathered from
+ * the rows of h and i through the tour, c(j,l) comes from a per-position
+ * array of tour edge costs built by load(). The operations are the ones of the
+ * scalar loop, in the same order and without FMA, so every delta is bit for
+ * bit the scalar one and scan() returns the move the scalar loop would pick:
+ * the smallest delta, the first b on ties.
+ *
+ * The instruction set is chosen at run time, the scalar version is used on
+ * CPUs without AVX2.
+ */
+class TwoOptKernel
+{
+public:
+
+    enum Isa {
+        SCALAR,
+        AVX2,
+        AVX512
+    };
+
+    /** best instruction set supported by the running CPU */
+    static Isa detect();
+
+    static const char* isaName(Isa isa);
+
+    explicit TwoOptKernel(Isa isa = detect());
+
+    inline Isa isa() const {
+        return mIsa;
+    }
+
+    /**
+     * prepare the scans of a tour: keeps the tour and the cost of each of its edges
+     * @param tsp TSP data
+     * @param sol tour to scan, must not change until the next load()
+     */
+    void load(const TSP& tsp, const TSPSolution& sol);
+
+    /**
+     * best move (a, b) over b in [a + 1, sequence.size() - 1)
+     * @param a first position of the reversed segment (1 ... sequence.size() - 3)
+     * @param costH row of h = sequence[a-1]
+     * @param costI row of i = sequence[a]
+     * @param mask NULL or one byte per position b, nonzero if the move (a, b) is forbidden
+     * @param bestB (output) selected b, -1 if every move is forbidden
+     * @return the cost variation of the selected move, +inf if there is none
+     */
+    double scan(int a, const double* costH, const double* costI, const unsigned char* mask, int& bestB) const {
+        return mScan(mSeq, &mEdge[0], mLast, a, costH, costI, mask, bestB);
+    }
+
+private:
+
+    typedef double (*ScanFunction)(const int* seq, const double* edge, int last, int a,
+                                   const double* costH, const double* costI,
+                                   const unsigned char* mask, int& bestB);
+
+    Isa mIsa;
+    ScanFunction mScan;
+
+    const int* mSeq;
+    int mLast;                      // sequence.size() - 1, b < mLast
+    std::vector<double> mEdge;      // mEdge[b] = c(sequence[b], sequence[b+1])
+};
+
+#endif /* TWOOPTKERNEL_H */
@@ -0,0 +1,110 @@
+/**
+ * @file TwoOptScanner.cpp
+ * @brief Best improvement 2-opt scan, parallel on large instances
+ */
+
+#include "TwoOptScanner.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+TwoOptScanner::TwoOptScanner(ThreadPool& pool) : mPool(pool) {}
+
+double TwoOptScanner::findBest(const TSP& tsp, const TSPSolution& sol,
+                               const vector< pair<int, int> >* tabuMoves, TSPMove& move) {
+    // moves (a, b): 1 <= a < last - 1, a < b < last
+    const int last = (int)sol.sequence.size() - 1;
+    const long moves = (long)(last - 2) * (last - 1) / 2;
+
+    mKernel.load(tsp, sol);
+
+    int parts = 1;
+    if (moves >= PARALLEL_MIN_MOVES) {
+        parts = min(mPool.size(), last - 2);
+    }
+    if ((int)mRanges.size() < parts) {
+        mRanges.resize(parts);
+    }
+
+    // position a has last - 1 - a moves: cut at equal shares of the total
+    int a = 1;
+    long done = 0;
+    for (int p = 0; p < parts; p++) {
+        Range& range = mRanges[p];
+        range.begin = a;
+        long target = moves * (p + 1) / parts;
+        while (a < last - 1 && (done < target || p == parts - 1)) {
+            done += last - 1 - a;
+            a++;
+        }
+        range.end = a;
+    }
+
+    if (parts == 1) {
+        scanRange(tsp, sol, tabuMoves, mRanges[0]);
+    } else {
+        // two pointers: the closure fits in std::function without a heap allocation
+        ScanArgs args = { &tsp, &sol, tabuMoves };
+        mPool.run(parts, [this, &args](int p) {
+            scanRange(*args.tsp, *args.sol, args.tabuMoves, mRanges[p]);
+        });
+    }
+
+    // ranges in scan order, strict comparison: the first best move wins
+    double bestCostVariation = tsp.infinite;
+    for (int p = 0; p < parts; p++) {
+        if (mRanges[p].best < bestCostVariation) {
+            bestCostVariation = mRanges[p].best;
+            move.from = mRanges[p].bestA;
+            move.to = mRanges[p].bestB;
+        }
+    }
+
+    return bestCostVariation;
+}
+
+void TwoOptScanner::scanRange(const TSP& tsp, const TSPSolution& sol,
+                              const vector< pair<int, int> >* tabuMoves, Range& range) {
+    const int last = (int)sol.sequence.size() - 1;
+
+    range.best = HUGE_VAL;
+    range.bestA = range.bestB = -1;
+
+    vector< pair<int, int> >::const_iterator tabu, tabuEnd;
+    if (tabuMoves != NULL) {
+        tabu = lower_bound(tabuMoves->begin(), tabuMoves->end(), make_pair(range.begin, 0));
+        tabuEnd = tabuMoves->end();
+        range.mask.assign(last, 0);
+    }
+
+    for (int a = range.begin; a < range.end; a++) {
+        const double* costH = range.rows.row(tsp, sol.sequence[a - 1]);
+        const double* costI = range.rows.row(tsp, sol.sequence[a]);
+
+        const unsigned char* mask = NULL;
+        vector< pair<int, int> >::const_iterator first = tabu;
+        if (tabuMoves != NULL) {
+            for ( ; tabu != tabuEnd && tabu->first == a; ++tabu) {
+                range.mask[tabu->second] = 1;
+            }
+            if (first != tabu) {
+                mask = &range.mask[0];
+            }
+        }
+
+        int b;
+        double neighCostVariation = mKernel.scan(a, costH, costI, mask, b);
+
+        for ( ; mask != NULL && first != tabu; ++first) {
+            range.mask[first->second] = 0;
+        }
+
+        if (neighCostVariation < range.best) {
+            range.best = neighCostVariation;
+            range.bestA = a;
+            range.bestB = b;
+        }
+    }
+}
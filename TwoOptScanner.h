@@ -0,0 +1,76 @@
+/**
+ * @file TwoOptScanner.h
+ * @brief Best improvement 2-opt scan, parallel on large instances
+ *
+ */
+
+#ifndef TWOOPTSCANNER_H
+#define TWOOPTSCANNER_H
+
+#include <vector>
+#include <utility>
+
+#include "TSP.h"
+#include "TSPSolution.h"
+#include "solver.h"
+#include "RowCache.h"
+#include "ThreadPool.h"
+#include "TwoOptKernel.h"
+
+/**
+ * Finds the best 2-opt move of a tour, evaluating the moves of each position a
+ * with the TwoOptKernel.
+ *
+ * Above PARALLEL_MIN_MOVES moves the positions a are split in one range per pool
+ * thread. The number of moves of a position decreases linearly with a, so the
+ * ranges are cut at equal shares of the triangular total rather than at equal
+ * lengths. Each range keeps its first best move and the ranges are reduced in
+ * order, which selects the move of the serial scan: the smallest delta, the
+ * first (a, b) on ties.
+ */
+class TwoOptScanner
+{
+public:
+
+    /** smallest neighbourhood scanned in parallel */
+    static const long PARALLEL_MIN_MOVES = 1L << 17;
+
+    explicit TwoOptScanner(ThreadPool& pool = ThreadPool::shared());
+
+    /**
+     * best move of sol
+     * @param tabuMoves NULL or the forbidden moves (a, b), sorted
+     * @param move (output) the best move, unchanged if no move costs less than tsp.infinite
+     * @return the cost variation of the best move, tsp.infinite if there is none
+     */
+    double findBest(const TSP& tsp, const TSPSolution& sol,
+                    const std::vector< std::pair<int, int> >* tabuMoves, TSPMove& move);
+
+private:
+
+    TwoOptScanner(const TwoOptScanner&);
+    TwoOptScanner& operator=(const TwoOptScanner&);
+
+    struct Range {
+        int begin, end;                     // positions a
+        RowCache rows;
+        std::vector<unsigned char> mask;    // forbidden b of the current a
+        double best;
+        int bestA, bestB;
+    };
+
+    struct ScanArgs {
+        const TSP* tsp;
+        const TSPSolution* sol;
+        const std::vector< std::pair<int, int> >* tabuMoves;
+    };
+
+    void scanRange(const TSP& tsp, const TSPSolution& sol,
+                   const std::vector< std::pair<int, int> >* tabuMoves, Range& range);
+
+    ThreadPool& mPool;
+    TwoOptKernel mKernel;
+    std::vector<Range> mRanges;
+};
+
+#endif /* TWOOPTSCANNER_H */
@@ -0,0 +1,66 @@
+/**
+ * @file VNDSolver.cpp
+ * @brief TSP solver (variable neighborhood descent)
+ */
+
+#include "VNDSolver.h"
+#include "Logger.h"
+
+VNDSolver::~VNDSolver() {
+    for (size_t k = 0; k < mNeighborhoods.size(); ++k) {
+        delete mNeighborhoods[k];
+    }
+}
+
+std::string VNDSolver::getSolverName() const {
+    std::string name = "VND";
+    for (size_t k = 0; k < mNeighborhoods.size(); ++k) {
+        name += (k == 0 ? " (" : ", ") + mNeighborhoods[k]->getName();
+    }
+    return name + ")";
+}
+
+bool VNDSolver::solve(const TSP& tsp, const TSPSolution& initSol, TSPSolution& bestSol) {
+
+    try {
+        int iter = 0;
+        mStop.start();
+
+        TSPSolution currSol(initSol);
+        double currValue = currSol.evaluate(tsp);
+        TSPMove move;
+
+        size_t k = 0;
+        while (k < mNeighborhoods.size()) {
+            double bestNeighValue = currValue + mNeighborhoods[k]->execute(tsp, currSol, move);
+
+            if (bestNeighValue < currValue - 1e-9) {
+                currSol.apply(tsp, move);
+                currValue = bestNeighValue;
+                ++iter;
+
+                LOG_DEBUG << " (" << iter << ") value " << currValue
+                          << "\t" << mNeighborhoods[k]->getName()
+                          << " move: " << move.from << " , " << move.to;
+
+                k = 0;      // back to the cheapest neighbourhood
+
+                if (mStop.stop(iter, currValue)) {
+                    break;
+                }
+            }
+            else {
+                ++k;
+            }
+        }
+
+        bestSol = currSol;
+        bestSol.iterations = iter;
+    }
+    catch (std::exception& e) {
+        LOG_ERROR << ">>>EXCEPTION: " << e.what();
+        return false;
+    }
+
+    return true;
+}
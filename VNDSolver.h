@@ -0,0 +1,62 @@
+/**
+ * @file VNDSolver.h
+ * @brief TSP solver (variable neighborhood descent)
+ *
+ */
+
+#ifndef VNDSOLVER_H
+#define VNDSOLVER_H
+
+#include <vector>
+
+#include "solver.h"
+#include "neighborimprovement.h"
+
+/**
+ * Class that solves a TSP problem by variable neighbourhood descent: the neighbourhoods
+ * are explored cheapest first (2-opt, node swap, Or-opt), an improving move sends the
+ * search back to the first neighbourhood, a local optimum of all of them stops it.
+ */
+class VNDSolver : public Solver
+{
+public:
+
+    std::vector<NeigthborImprovement*> mNeighborhoods;
+
+    bool mCandidateScan;
+
+    /**
+     * @param candidateScan 2-opt restricted to candidate edges (needs TSP::buildCandidateLists)
+     */
+    VNDSolver(bool candidateScan = false) : mCandidateScan(candidateScan) {
+        if (candidateScan) {
+            mNeighborhoods.push_back(new CandidateBestImprovement());
+        } else {
+            mNeighborhoods.push_back(new BestImprovement());
+        }
+        mNeighborhoods.push_back(new NodeSwapImprovement());
+        mNeighborhoods.push_back(new OrOptImprovement());
+    }
+
+    ~VNDSolver();
+
+    Solver* clone() const {
+        VNDSolver* solver = new VNDSolver(mCandidateScan);
+        solver->mStop = mStop;
+        return solver;
+    }
+
+    std::string getSolverName() const;
+
+    /**
+     * search for a good tour by variable neighbourhood descent, until a local optimum
+     * of every neighbourhood or a stop criterion (an iteration is an applied move)
+     * @param TSP TSP data
+     * @param initSol initial solution
+     * @param bestSol best found solution (output)
+     * @return true id everything OK, false otherwise
+     */
+    bool solve(const TSP& tsp, const TSPSolution& initSol, TSPSolution& bestSol);
+};
+
+#endif /* VNDSOLVER_H */
@@ -0,0 +1,85 @@
+/**
+ * @file WorkStealingScheduler.cpp
+ * @brief Runs independent tasks of very different lengths on several threads
+ */
+
+#include "WorkStealingScheduler.h"
+
+#include <thread>
+#include <exception>
+
+using namespace std;
+
+WorkStealingScheduler::WorkStealingScheduler(int threads) : mThreads(threads < 1 ? 1 : threads) {}
+
+void WorkStealingScheduler::run(int count, const function<void(int)>& task) {
+    const int threads = min(mThreads, count);
+
+    if (threads <= 1) {
+        for (int k = 0; k < count; k++) {
+            task(k);
+        }
+        return;
+    }
+
+    vector<Queue> queues(threads);
+    for (int k = 0; k < count; k++) {
+        queues[k % threads].tasks.push_back(k);
+    }
+
+    mutex errorMutex;
+    exception_ptr error;
+
+    function<void(int)> worker = [&](int t) {
+        for (int k = take(queues, t); k >= 0; k = take(queues, t)) {
+            try {
+                task(k);
+            }
+            catch (...) {
+                lock_guard<mutex> lock(errorMutex);
+                if (!error) {
+                    error = current_exception();
+                }
+            }
+        }
+    };
+
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++) {
+        pool.push_back(thread(worker, t));
+    }
+    worker(0);
+
+    for (size_t t = 0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+
+    if (error) {
+        rethrow_exception(error);
+    }
+}
+
+int WorkStealingScheduler::take(vector<Queue>& queues, int t) {
+    {
+        lock_guard<mutex> lock(queues[t].mutex);
+        if (!queues[t].tasks.empty()) {
+            int k = queues[t].tasks.front();
+            queues[t].tasks.pop_front();
+            return k;
+        }
+    }
+
+    // tasks are never added: once every queue was seen empty there is nothing left
+    const int n = (int)queues.size();
+    for (int v = 1; v < n; v++) {
+        Queue& victim = queues[(t + v) % n];
+        lock_guard<mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            int k = victim.tasks.back();
+            victim.tasks.pop_back();
+            return k;
+        }
+    }
+
+    return -1;
+}
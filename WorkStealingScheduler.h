@@ -0,0 +1,54 @@
+/**
+ * @file WorkStealingScheduler.h
+ * @brief Runs independent tasks of very different lengths on several threads
+ *
+ */
+
+#ifndef WORKSTEALINGSCHEDULER_H
+#define WORKSTEALINGSCHEDULER_H
+
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <functional>
+
+/**
+ * Each thread owns a queue of task indices, dealt round robin at the start. A
+ * thread takes its own tasks from the front; when its queue is empty it steals
+ * from the back of the other queues, so a thread that drew short tasks (local
+ * searches) helps the ones stuck with long ones (tabu searches) instead of
+ * idling as with a static split.
+ */
+class WorkStealingScheduler
+{
+public:
+
+    /**
+     * @param threads threads running the tasks, the calling thread included
+     */
+    explicit WorkStealingScheduler(int threads);
+
+    inline int threads() const {
+        return mThreads;
+    }
+
+    /**
+     * run task(0) ... task(count-1) and wait for all of them
+     * @throw the first exception thrown by a task, after all threads stopped
+     */
+    void run(int count, const std::function<void(int)>& task);
+
+private:
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<int> tasks;
+    };
+
+    // next task for thread t: its own first, else stolen; -1 when there is no task left
+    int take(std::vector<Queue>& queues, int t);
+
+    int mThreads;
+};
+
+#endif /* WORKSTEALINGSCHEDULER_H */
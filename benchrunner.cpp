@@ -0,0 +1,102 @@
+/**
+ * @file benchrunner.cpp
+ * @brief run a benchmark config, write its results and compare them with a baseline
+ */
+
+#include <stdexcept>
+#include <string>
+#include <cstdlib>
+
+#include <getopt.h>
+
+#include "BenchmarkRunner.h"
+#include "Logger.h"
+
+using namespace std;
+
+static struct option long_options[] = {
+    {"output", required_argument, NULL, 'o'},           // Results file (CSV)
+    {"baseline", required_argument, NULL, 'b'},         // Results file to compare with, regressions fail the run
+    {"quality-tolerance", required_argument, NULL, 'q'},// Mean value increase tolerated (%)
+    {"speed-tolerance", required_argument, NULL, 's'},  // Mean throughput decrease tolerated (%)
+    {"alpha", required_argument, NULL, 'a'},            // Significance level of the regression tests
+    {"log", required_argument, NULL, 'L'},              // Console log level: error, warn, info, debug or trace
+    {0, 0, 0, 0}
+};
+
+// exit status: 0 ok, 1 error, 2 regressions against the baseline
+int main (int argc, char *argv[]) {
+    try {
+
+        string output = "benchmark-results.csv";
+        string baseline;
+        double qualityTolerance = 0.5;  // percent
+        double speedTolerance = 10;     // percent
+        double alpha = 0.05;
+
+        int c;
+        int option_index;
+
+        while ((c = getopt_long(argc, argv, "o:b:q:s:a:L:", long_options, &option_index)) != EOF) {
+            switch (c) {
+                case 'o': {
+                    output = optarg;
+                    break;
+                }
+                case 'b': {
+                    baseline = optarg;
+                    break;
+                }
+                case 'q': {
+                    qualityTolerance = strtod(optarg, NULL);
+                    break;
+                }
+                case 's': {
+                    speedTolerance = strtod(optarg, NULL);
+                    break;
+                }
+                case 'a': {
+                    alpha = strtod(optarg, NULL);
+                    break;
+                }
+                case 'L': {
+                    Logger::setLevel(Logger::parseLevel(optarg));
+                    break;
+                }
+                default:
+                    throw runtime_error("usage: ./benchrunner <config> [--output results.csv] [--baseline results.csv] "
+                                        "[--quality-tolerance %] [--speed-tolerance %] [--alpha a] [--log level]");
+            }
+        }
+
+        if (optind != argc - 1) {
+            throw runtime_error("usage: ./benchrunner <config> [--output results.csv] [--baseline results.csv] "
+                                "[--quality-tolerance %] [--speed-tolerance %] [--alpha a] [--log level]");
+        }
+
+        BenchmarkRunner runner;
+        runner.readConfig(argv[optind]);
+
+        // read first: a bad baseline fails before the runs
+        vector<BenchmarkRunner::Cell> base;
+        if (!baseline.empty()) {
+            base = BenchmarkRunner::readResults(baseline);
+        }
+
+        runner.run();
+        runner.writeResults(output);
+
+        if (!baseline.empty() && runner.compare(base, qualityTolerance / 100, speedTolerance / 100, alpha) > 0) {
+            Logger::instance().flush();
+            return 2;
+        }
+    }
+    catch (std::exception& e) {
+        LOG_ERROR << ">>>EXCEPTION: " << e.what();
+        Logger::instance().flush();
+        return 1;
+    }
+
+    Logger::instance().flush();
+    return 0;
+}
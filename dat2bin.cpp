@@ -0,0 +1,53 @@
+/**
+ * @file dat2bin.cpp
+ * @brief convert a text instance (.dat) into the binary, memory-mappable format
+ */
+
+#include <stdexcept>
+#include <string>
+
+#include "TSP.h"
+#include "TSPBinary.h"
+#include "Logger.h"
+
+using namespace std;
+
+int main (int argc, char *argv[]) {
+    try {
+
+        if (argc < 2 || argc > 3) {
+            throw std::runtime_error("usage: ./dat2bin <filename>.dat [<output>.bin]");
+        }
+
+        string output;
+        if (argc == 3) {
+            output = argv[2];
+        } else {
+            output = argv[1];
+            size_t dot = output.rfind('.');
+            if (dot != string::npos && output.find('/', dot) == string::npos) {
+                output.erase(dot);
+            }
+            output += ".bin";
+        }
+
+        TSP tsp;
+        tsp.readTextFile(argv[1]);
+        TSPBinary::write(tsp, output.c_str());
+
+        // read back, so a bad conversion never goes unnoticed
+        TSP check;
+        TSPBinary::map(output.c_str(), check);
+
+        LOG_INFO << argv[1] << " -> " << output
+                 << (check.isSymmetric() ? " (symmetric)" : " (asymmetric)");
+    }
+    catch (std::exception& e) {
+        LOG_ERROR << ">>>EXCEPTION: " << e.what();
+        Logger::instance().flush();
+        return 1;
+    }
+
+    Logger::instance().flush();
+    return 0;
+}
@@ -6,17 +6,23 @@
 
 #include <stdexcept>
 #include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
 
 #include <getopt.h>
 #include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <signal.h>
 
 #include "solver.h"
-#include "LocalSearchSolver.h"
+#include "SolverOptions.h"
 #include "TabuSearchSolver.h"
 #include "solversexecutor.h"
+#include "Logger.h"
+#include "SolverMetrics.h"
 
 // error status and messagge buffer
 int status;
@@ -24,94 +30,162 @@ char errmsg[255];
 
 using namespace std;
 
-/** Struct containing the long options */
-static struct option long_options[] = {
-    {"ls", no_argument, NULL, 'l'},             // Local Search
-    {"ts", no_argument, NULL, 't'},             // Tabu Search
-
-    {"fi", no_argument, NULL, 'f'},             // First Improvement
-    {"bi", no_argument, NULL, 'b'},             // Best Improvement
-
-    {"ac", no_argument, NULL, 'a'},             // Aspiration Criteria
-
-    {"maxIter", required_argument, NULL, 'i'},  // Max iteration for TS
-    {"tenure", required_argument, NULL, 'e'},   // Tenure for TS
-    {"secs", required_argument, NULL, 's'},     // Seconds for TS
+/** Struct containing the long options, after SolverOptions::LONG_OPTIONS */
+static struct option main_options[] = {
+    {"jobs", required_argument, NULL, 'j'},     // Runs executed in parallel (0 = all cores)
+    {"bound", no_argument, NULL, 'B'},          // Held-Karp lower bound, the results report their gap
+    {"gap", required_argument, NULL, 'g'},      // Stop the runs within this gap (%) of the lower bound
+    {"log", required_argument, NULL, 'L'},      // Console log level: error, warn, info, debug or trace
+    {"trace", required_argument, NULL, 'T'},    // Write the convergence traces of the runs (CSV) and print the time to target
+    {"ttt", required_argument, NULL, 'G'},      // Time-to-target gaps (%), comma separated
+    {"metrics", required_argument, NULL, 'P'},  // Rewrite the solver counters into this Prometheus textfile while running
+    {"metrics-interval", required_argument, NULL, 'Q'},  // Seconds between two rewrites (default 1)
+    {"perf", no_argument, NULL, 'H'},           // Hardware counters (perf_event_open) in the metrics
 
     {"bm", required_argument, NULL, 'm'},       // Benchmark
     {0, 0, 0, 0}
 };
 
+// Ctrl-C stops the runs, which report their best tour; a second one kills the program
+static CancellationToken* interruptToken = NULL;
+
+static void onInterrupt(int) {
+    if (interruptToken != NULL) {
+        interruptToken->cancel();
+    }
+    signal(SIGINT, SIG_DFL);
+}
+
 
 int main (int argc, char *argv[]) {
     try {
 
         if (argc < 2) {
-            throw std::runtime_error("usage: ./main <filename>.dat");
+            throw std::runtime_error("usage: ./main <filename>.dat|.bin|.tsp");
         }
 
-        SolversExecutor solversExe(argv[1]);
+        const char* filename = argv[1];    // getopt_long permutes argv
 
         bool benchmark = false;
 
-        // Solver option    default = LocalSearch
-        bool localSearch = true;
+        // Solver, its features and its stop criteria
+        SolverOptions options;
+
+        // Lower bound     default = none
+        bool lowerBound = false;
+        double targetGap = -1;  // percent
+
+        int jobs = 1;
 
-        // Solvers features     default = BI
-        bool bestImprove = true;
-        bool aspCriteria = false;   // only for TabuSearch
+        // Convergence trace     default = none
+        string traceFile;
+        vector<double> tttGaps = {0.05, 0.02, 0.01, 0.005, 0};
 
-        // Tabu options
-        int seconds = 30;
-        int tenure = 50;
-        int maxIterations = 1000;
+        // Metrics     default = summary only if compiled in (make METRICS=1)
+        string metricsFile;
+        double metricsInterval = 1;
+        bool hardwareCounters = false;
+
+        vector<struct option> long_options;
+        for (const struct option* o = SolverOptions::LONG_OPTIONS; o->name != NULL; o++) {
+            long_options.push_back(*o);
+        }
+        for (const struct option* o = main_options; ; o++) {
+            long_options.push_back(*o);
+            if (o->name == NULL) {
+                break;
+            }
+        }
+        const string short_options = string(SolverOptions::SHORT_OPTIONS) + "mj:Bg:L:T:G:P:Q:H";
 
         int c;
         int option_index;
 
-        while((c = getopt_long(argc, argv, "lfbtae:i:s:m", long_options, &option_index)) != EOF) {
+        while((c = getopt_long(argc, argv, short_options.c_str(), &long_options[0], &option_index)) != EOF) {
+            if (options.parse(c, optarg)) {
+                if (c == 'a') {
+                    LOG_INFO << "\nAspCriteria: " << options.aspCriteria;
+                } else if (c == 'e') {
+                    LOG_INFO << "\nTenure: " << options.tenure << "\n";
+                }
+                continue;
+            }
             switch(c) {
-                case 'l': {
-                    localSearch = true;
+                case 'm': {
+                    benchmark = true;
                     break;
                 }
-                case 't': {
-                    localSearch = false;
+                case 'j': {
+                    jobs = (int)strtol(optarg, NULL, 0);
                     break;
                 }
-                case 'b': {
-                    bestImprove = true;
+                case 'B': {
+                    lowerBound = true;
                     break;
                 }
-                case 'f': {
-                    bestImprove = false;
+                case 'g': {
+                    targetGap = strtod(optarg, NULL);
+                    if (targetGap < 0) {
+                        throw runtime_error("the target gap must be >= 0 (%)");
+                    }
                     break;
                 }
-                case 'a': {
-                    aspCriteria = true;
-                    cout << endl << "AspCriteria: " << aspCriteria << endl;
+                case 'L': {
+                    Logger::setLevel(Logger::parseLevel(optarg));
                     break;
                 }
-                case 'e': {
-                    tenure = strtol(optarg, NULL, 0);
-                    cout << endl << "Tenure: " << tenure << endl << endl;
+                case 'T': {
+                    traceFile = optarg;
                     break;
                 }
-                case 'i': {
-                    maxIterations = (int)strtol(optarg, NULL, 0);
+                case 'G': {
+                    tttGaps.clear();
+                    char* next = optarg;
+                    while (*next != '\0') {
+                        char* end;
+                        double gap = strtod(next, &end);
+                        if (end == next || gap < 0) {
+                            throw runtime_error(string("bad time-to-target gaps '") + optarg + "' (percents, comma separated)");
+                        }
+                        tttGaps.push_back(gap / 100);
+                        next = (*end == ',') ? end + 1 : end;
+                    }
                     break;
                 }
-                case 's': {
-                    seconds = (int)strtol(optarg, NULL, 0);
+                case 'P': {
+                    metricsFile = optarg;
                     break;
                 }
-                case 'm': {
-                    benchmark = true;
+                case 'Q': {
+                    metricsInterval = strtod(optarg, NULL);
+                    if (metricsInterval <= 0) {
+                        throw runtime_error("the metrics interval must be > 0 (seconds)");
+                    }
+                    break;
+                }
+                case 'H': {
+                    hardwareCounters = true;
                     break;
                 }
             }
         }
 
+        // before any solver thread starts: only the threads started later are counted
+        if (hardwareCounters && !HardwareCounters::instance().open()) {
+            LOG_WARN << "hardware counters not available (perf_event_open, see kernel.perf_event_paranoid)";
+        }
+        if (!metricsFile.empty() && !SolverMetrics::enabled()) {
+            LOG_WARN << "solver counters not compiled in (make METRICS=1), " << metricsFile << " reports them as 0";
+        }
+
+        // after the options: --log applies to the loading messages too
+        SolversExecutor solversExe(filename);
+        solversExe.setJobs(jobs);
+
+        if (options.candidates > 0) {
+            solversExe.buildCandidateLists(options.candidates, options.quadrant);
+        }
+
         if (benchmark) {
 
             // Test initial solutions
@@ -144,24 +218,60 @@ int main (int argc, char *argv[]) {
 
         } else {
             // Command line program
-            solversExe.addRandomInitSolution();
-
-            if (localSearch) {
-                solversExe.addSolver(new LocalSearchSolver(bestImprove));
-            } else { // tabu search
-                solversExe.addSolver(new TabuSearchSolver(tenure, maxIterations, aspCriteria, bestImprove, seconds));
+            if (options.initMethod == TourConstruction::RANDOM) {
+                solversExe.addRandomInitSolution();
+            } else {
+                solversExe.addConstructedInitSolution(options.initMethod);
             }
+
+            solversExe.addSolver(options.buildSolver());
         }
 
+        if (lowerBound || targetGap >= 0) {
+            solversExe.computeLowerBound();
+        }
+        if (targetGap >= 0) {
+            solversExe.setTargetGap(targetGap / 100);
+        }
+
+        if (!traceFile.empty()) {
+            solversExe.enableTrace();
+        }
+
+        unique_ptr<MetricsExporter> exporter;
+        if (!metricsFile.empty()) {
+            exporter.reset(new MetricsExporter(metricsFile, metricsInterval));
+        }
+
+        interruptToken = &solversExe.cancellation();
+        signal(SIGINT, onInterrupt);
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
         solversExe.execute();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        signal(SIGINT, SIG_DFL);
+        interruptToken = NULL;
+
+        exporter.reset();   // last rewrite, with the final counts
 
         solversExe.printInitSolutions();
         solversExe.printResults();
 
+        if (SolverMetrics::enabled() || HardwareCounters::instance().isOpen()) {
+            SolverMetrics::printSummary(seconds);
+        }
+
+        if (!traceFile.empty()) {
+            solversExe.printTimeToTarget(tttGaps);
+            solversExe.writeTrace(traceFile);
+        }
+
     }
     catch (std::exception& e) {
-        std::cout << ">>>EXCEPTION: " << e.what() << std::endl;
+        LOG_ERROR << ">>>EXCEPTION: " << e.what();
     }
 
+    Logger::instance().flush();
     return 0;
 }
@@ -0,0 +1,323 @@
+/**
+ * @file microbench.cpp
+ * @brief micro-benchmarks of the neighbourhood kernels and of the move application
+ *
+ * Every kernel runs on the nearest neighbour tour of each instance: a warmup,
+ * then repetitions of a batch of calls sized to last --rep-time seconds. The
+ * table reports the time per unit of work (a move evaluated, a tabu check, a
+ * move applied, an edge of the tour) over the repetitions, the units per second
+ * of the median, and the heap allocations per call.
+ *
+ * Instances: instance files, or synthetic uniform random points
+ *   mat:<n>   full cost matrix
+ *   euc:<n>   coordinates, distances computed on demand
+ */
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <iomanip>
+
+#include <getopt.h>
+
+#include "TSP.h"
+#include "TSPSolution.h"
+#include "TSPCoordinates.h"
+#include "TourConstruction.h"
+#include "neighborimprovement.h"
+#include "TabuSearchSolver.h"
+#include "AllocationCounter.h"
+#include "Logger.h"
+
+using namespace std;
+
+namespace {
+
+typedef chrono::steady_clock Clock;
+
+// results of the kernels land here, so that the calls are not optimized away
+volatile double sink;
+
+struct Options {
+    int repetitions;
+    double repetitionTime;  // seconds
+    double warmupTime;      // seconds
+};
+
+double elapsed(Clock::time_point since) {
+    return chrono::duration<double>(Clock::now() - since).count();
+}
+
+/**
+ * time a kernel and print its line
+ * @param call one call of the kernel, returns the units of work it did
+ */
+template <typename Kernel>
+void measure(const string& name, const char* unit, Kernel call, const Options& options) {
+    // warmup, and the batch size: calls doubled until a batch lasts a repetition
+    long batch = 1;
+    Clock::time_point warmupStart = Clock::now();
+    for (;;) {
+        Clock::time_point start = Clock::now();
+        for (long c = 0; c < batch; c++) {
+            call();
+        }
+        double seconds = elapsed(start);
+        if (seconds >= options.repetitionTime && elapsed(warmupStart) >= options.warmupTime) {
+            break;
+        }
+        if (seconds < options.repetitionTime) {
+            batch *= 2;
+        }
+    }
+
+    vector<double> nsPerUnit;
+    nsPerUnit.reserve(options.repetitions);
+    unsigned long allocations = AllocationCounter::count();
+
+    for (int r = 0; r < options.repetitions; r++) {
+        double units = 0;
+        Clock::time_point start = Clock::now();
+        for (long c = 0; c < batch; c++) {
+            units += call();
+        }
+        nsPerUnit.push_back(elapsed(start) * 1e9 / units);
+    }
+
+    allocations = AllocationCounter::count() - allocations;
+
+    sort(nsPerUnit.begin(), nsPerUnit.end());
+    const size_t reps = nsPerUnit.size();
+    double median = (nsPerUnit[(reps - 1) / 2] + nsPerUnit[reps / 2]) / 2;
+    double mean = 0;
+    for (size_t r = 0; r < reps; r++) {
+        mean += nsPerUnit[r];
+    }
+    mean /= reps;
+    double variance = 0;
+    for (size_t r = 0; r < reps; r++) {
+        variance += (nsPerUnit[r] - mean) * (nsPerUnit[r] - mean);
+    }
+    double cv = (reps > 1 && mean > 0) ? 100 * sqrt(variance / (reps - 1)) / mean : 0;
+
+    ostringstream allocationsPerCall;
+    if (AllocationCounter::enabled()) {
+        allocationsPerCall << (double)allocations / ((double)batch * reps);
+    } else {
+        allocationsPerCall << "-";
+    }
+
+    LOG_INFO << "  " << left << setw(42) << name << setw(7) << unit << right << fixed << setprecision(3)
+             << setw(12) << median << setw(12) << nsPerUnit.front() << setw(12) << nsPerUnit.back()
+             << setprecision(1) << setw(8) << cv
+             << scientific << setprecision(3) << setw(13) << 1e9 / median
+             << setw(12) << allocationsPerCall.str();
+}
+
+/**
+ * @param spec instance file, mat:<n> or euc:<n>
+ */
+void loadInstance(const string& spec, TSP& tsp) {
+    bool matrix = spec.compare(0, 4, "mat:") == 0;
+    if (!matrix && spec.compare(0, 4, "euc:") != 0) {
+        tsp.readFromFile(spec.c_str());
+        return;
+    }
+
+    int n = (int)strtol(spec.c_str() + 4, NULL, 0);
+    if (n < 5) {
+        throw runtime_error("bad synthetic instance '" + spec + "' (at least 5 nodes)");
+    }
+
+    // the same points for a given n
+    minstd_rand random(n);
+    uniform_real_distribution<double> coordinate(0, 10000);
+    vector<double> x(n), y(n);
+    for (int i = 0; i < n; i++) {
+        x[i] = coordinate(random);
+        y[i] = coordinate(random);
+    }
+    shared_ptr<const TSPCoordinates> points(new TSPCoordinates(TSPCoordinates::EUC_2D, x, y));
+
+    if (!matrix) {
+        tsp.adoptCoordinates(points);
+        return;
+    }
+    tsp.resize(n);
+    for (int i = 0; i < n; i++) {
+        points->distanceRow(i, tsp.row(i));
+    }
+}
+
+void benchInstance(const string& spec, const Options& options) {
+    TSP tsp;
+    loadInstance(spec, tsp);
+
+    TSPSolution tour(tsp);
+    TourConstruction::build(tsp, TourConstruction::NEAREST_NEIGHBOR, tour);
+
+    const int last = tour.sequence.size() - 1;  // position of the closing node 0
+    const double moves = (double)(last - 2) * (last - 1) / 2;     // 2-opt moves 1 <= a < b < last
+
+    LOG_INFO << "\n" << spec << "\t(n = " << tsp.n << (tsp.hasMatrix() ? ", matrix" : ", coordinates")
+             << ", nearest neighbour tour " << tour.value() << ")";
+    LOG_INFO << "  " << left << setw(42) << "kernel" << setw(7) << "unit" << right
+             << setw(12) << "ns/unit" << setw(12) << "min" << setw(12) << "max" << setw(8) << "cv %"
+             << setw(13) << "units/s" << setw(12) << "allocs/call";
+
+    TSPMove move;
+
+    BestImprovement best;
+    measure("BestImprovement::execute", "move", [&]() {
+        sink = best.execute(tsp, tour, move);
+        return moves;
+    }, options);
+
+    FirstImprovement first;
+    measure("FirstImprovement::execute", "move", [&]() {
+        double variation = first.execute(tsp, tour, move);
+        sink = variation;
+        if (tour.value() + variation >= tour.value()) {
+            return moves;   // no improving move: the whole neighbourhood
+        }
+        // moves of the positions before a, then up to b
+        double a = move.from;
+        return (a - 1) * (last - 1) - a * (a - 1) / 2 + (move.to - move.from);
+    }, options);
+
+    // tabu search in its steady state: a full tabu list
+    const int tenure = 50;
+    TabuSearchSolver tabu(tenure, 1);
+    tabu.mTabu.reset(tenure);
+    minstd_rand random(7);
+    for (int k = 1; k <= tenure; k++) {
+        int a = 1 + random() % (last - 2);
+        int b = a + 1 + random() % (last - 1 - a);
+        tabu.mTabu.add(a, b, k);
+    }
+    tabu.mIter = tenure;
+
+    measure("TabuSearchSolver::findBestNeighbor", "move", [&]() {
+        sink = tabu.findBestNeighbor(tsp, tour, move);
+        return moves;
+    }, options);
+
+    const int PAIRS = 4096;
+    vector< pair<int, int> > pairs;
+    for (int k = 0; k < PAIRS; k++) {
+        int a = 1 + random() % (last - 2);
+        pairs.push_back(make_pair(a, a + 1 + (int)(random() % (last - 1 - a))));
+    }
+    measure("TabuSearchSolver::isTabuMove", "check", [&]() {
+        int tabuMoves = 0;
+        for (int k = 0; k < PAIRS; k++) {
+            tabuMoves += tabu.isTabuMove(pairs[k].first, pairs[k].second);
+        }
+        sink = tabuMoves;
+        return (double)PAIRS;
+    }, options);
+
+    // random moves, applied in turn to a copy of the tour
+    const int MOVES = 1024;
+    vector<TSPMove> reversals(MOVES), swaps(MOVES);
+    for (int k = 0; k < MOVES; k++) {
+        int a = 1 + random() % (last - 2);
+        int b = a + 1 + random() % (last - 1 - a);
+        reversals[k].type = TSPMove::TWO_OPT;
+        reversals[k].from = a;
+        reversals[k].to = b;
+        swaps[k].type = TSPMove::NODE_SWAP;
+        swaps[k].from = a;
+        swaps[k].to = b;
+    }
+
+    TSPSolution work(tour);
+    int next = 0;
+    measure("TSPSolution::apply (2-opt)", "move", [&]() {
+        sink = work.apply(tsp, reversals[next]);
+        next = (next + 1) % MOVES;
+        return 1.0;
+    }, options);
+
+    next = 0;
+    measure("TSPSolution::apply (node swap)", "move", [&]() {
+        sink = work.apply(tsp, swaps[next]);
+        next = (next + 1) % MOVES;
+        return 1.0;
+    }, options);
+
+    measure("TSPSolution::evaluateObjectiveFunction", "edge", [&]() {
+        sink = tour.evaluateObjectiveFunction(tsp);
+        return (double)last;
+    }, options);
+}
+
+}
+
+static struct option long_options[] = {
+    {"reps", required_argument, NULL, 'r'},     // Timed repetitions of every kernel
+    {"rep-time", required_argument, NULL, 't'}, // Seconds of one repetition
+    {"warmup", required_argument, NULL, 'w'},   // Seconds of warmup
+    {0, 0, 0, 0}
+};
+
+int main (int argc, char *argv[]) {
+    try {
+
+        Options options;
+        options.repetitions = 10;
+        options.repetitionTime = 0.02;
+        options.warmupTime = 0.05;
+
+        int c;
+        int option_index;
+
+        while ((c = getopt_long(argc, argv, "r:t:w:", long_options, &option_index)) != EOF) {
+            switch (c) {
+                case 'r': {
+                    options.repetitions = (int)strtol(optarg, NULL, 0);
+                    if (options.repetitions < 1) {
+                        throw runtime_error("at least 1 repetition");
+                    }
+                    break;
+                }
+                case 't': {
+                    options.repetitionTime = strtod(optarg, NULL);
+                    break;
+                }
+                case 'w': {
+                    options.warmupTime = strtod(optarg, NULL);
+                    break;
+                }
+                default:
+                    throw runtime_error("usage: ./microbench [--reps r] [--rep-time s] [--warmup s] <instance>|mat:<n>|euc:<n> ...");
+            }
+        }
+
+        if (optind == argc) {
+            throw runtime_error("usage: ./microbench [--reps r] [--rep-time s] [--warmup s] <instance>|mat:<n>|euc:<n> ...");
+        }
+
+        LOG_INFO << options.repetitions << " repetitions of " << options.repetitionTime << " s, warmup "
+                 << options.warmupTime << " s; ns/unit is the median, min and max of the repetitions";
+
+        for (int i = optind; i < argc; i++) {
+            benchInstance(argv[i], options);
+        }
+    }
+    catch (std::exception& e) {
+        LOG_ERROR << ">>>EXCEPTION: " << e.what();
+        Logger::instance().flush();
+        return 1;
+    }
+
+    Logger::instance().flush();
+    return 0;
+}
@@ -2,13 +2,78 @@
 #define NEIGHBORIMPROVEMENT
 
 #include <iostream>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
 
 #include "TSP.h"
 #include "TSPSolution.h"
 #include "solver.h"
+#include "RowCache.h"
+#include "CandidateLists.h"
+#include "TwoOptScanner.h"
+#include "SolverMetrics.h"
 
 using namespace std;
 
+/**
+ * visit the 2-opt moves (a, b) that add at least one candidate edge: (h, j) with
+ * j a candidate of h, or (i, l) with l a candidate of i, where h i ... j l are the
+ * nodes at positions a-1, a, b, b+1. A move may be visited twice.
+ * @param visit called as visit(a, b, costVariation), returns true to stop the scan
+ */
+template <typename Visitor>
+inline void forEachCandidateMove(const TSP& tsp, const CandidateLists& cand,
+                                 const TSPSolution& sol, Visitor visit) {
+    const std::vector<int>& seq = sol.sequence;
+    const std::vector<int>& pos = sol.positions();
+    const int last = seq.size() - 1;    // position of the closing node 0
+
+    for (int a = 1; a < last - 1; a++) {
+        int h = seq[a-1];
+        int i = seq[a];
+
+        double costHI = tsp.cost(h, i);
+
+        // new edge (h, j)
+        for (const int* c = cand.begin(h); c != cand.end(h); ++c) {
+            int b = pos[*c];
+            if (b > a && b < last) {
+                int j = *c;
+                int l = seq[b+1];
+
+                double neighCostVariation = - costHI - tsp.cost(j, l)
+                                            + tsp.cost(h, j) + tsp.cost(i, l);
+                if (visit(a, b, neighCostVariation)) {
+                    return;
+                }
+            }
+        }
+
+        // new edge (i, l)
+        for (const int* c = cand.begin(i); c != cand.end(i); ++c) {
+            int l = *c;
+            int b = (l == seq[0] ? last : pos[l]) - 1;
+            if (b > a && b < last) {
+                int j = seq[b];
+
+                double neighCostVariation = - costHI - tsp.cost(j, l)
+                                            + tsp.cost(h, j) + tsp.cost(i, l);
+                if (visit(a, b, neighCostVariation)) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+inline const CandidateLists& requireCandidates(const TSP& tsp) {
+    if (tsp.candidates() == NULL) {
+        throw std::runtime_error("candidate lists not built (TSP::buildCandidateLists)");
+    }
+    return *tsp.candidates();
+}
+
 class NeigthborImprovement
 {
 public:
@@ -22,6 +87,8 @@ public:
     virtual double execute(const TSP& tsp, const TSPSolution& currSol, TSPMove& move) = 0;
 
     virtual const string getName() const = 0;
+
+    virtual ~NeigthborImprovement() {}
 };
 
 
@@ -31,22 +98,28 @@ public:
 
     double execute(const TSP& tsp , const TSPSolution& currSol, TSPMove& move) {
         //cout << endl << endl << "-------------- find neighbor --------------";
-
+        SolverMetrics::Timer timer(SolverMetrics::NEIGHBORHOOD_NS);
 
         double bestCostVariation = tsp.infinite;
+        move.type = TSPMove::TWO_OPT;
+        uint64_t evaluated = 0;
 
         for ( uint a = 1 ; a < currSol.sequence.size() - 2 ; a++ ) {
 
             int h = currSol.sequence[a-1];
             int i = currSol.sequence[a];
 
+            const double* costH = mRows.row(tsp, h);
+            const double* costI = mRows.row(tsp, i);
+
             for ( uint b = a + 1 ; b < currSol.sequence.size() - 1 ; b++ ) {
                 int j = currSol.sequence[b];
                 int l = currSol.sequence[b+1];
 
                 // incremental evaluation --> bestCostVariation (instead of best cost)
-                double neighCostVariation = - tsp.cost[h][i] - tsp.cost[j][l]
-                                            + tsp.cost[h][j] + tsp.cost[i][l];
+                double neighCostVariation = - costH[i] - tsp.cost(j, l)
+                                            + costH[j] + costI[l];
+                evaluated++;
 
                 if (neighCostVariation < bestCostVariation ) {
                     // neighbor better of precedent neighbors
@@ -54,7 +127,7 @@ public:
                     move.from = a;
                     move.to = b;
 
-                    double currentBestValueFound = currSol.evaluateObjectiveFunction(tsp);
+                    double currentBestValueFound = currSol.value();
 
                     // on first improvement exit
                     //cout << endl << "Move from " << a << " to " << b;
@@ -62,6 +135,7 @@ public:
                     if (currentBestValueFound + bestCostVariation < currentBestValueFound) {
                         //cout << "\tIt's an improvement, chose it!" << endl;
                         //cout << "------------------------" << endl;
+                        SolverMetrics::add(SolverMetrics::MOVES_EVALUATED, evaluated);
                         return bestCostVariation;
                     }
                 }
@@ -69,12 +143,16 @@ public:
         }
 
         //cout << endl << "------------------------------" << endl;
+        SolverMetrics::add(SolverMetrics::MOVES_EVALUATED, evaluated);
         return bestCostVariation;
     }
 
     const string getName() const {
         return "First Improvement";
     }
+
+private:
+    RowCache mRows;
 };
 
 
@@ -82,31 +160,218 @@ class BestImprovement : public NeigthborImprovement
 {
 public:
     double execute(const TSP &tsp, const TSPSolution &currSol, TSPMove &move) {
-        //cout << endl << endl << "------------- find neighbor --------------";
-
         // Determine the *move* yielding the best 2-opt neigbor solution
+        // (initial and final position are fixed, see TwoOptScanner)
+        SolverMetrics::Timer timer(SolverMetrics::NEIGHBORHOOD_NS);
+        const uint64_t last = currSol.sequence.size() - 1;
+        SolverMetrics::add(SolverMetrics::MOVES_EVALUATED, (last - 2) * (last - 1) / 2);
+
+        move.type = TSPMove::TWO_OPT;
+        return mScanner.findBest(tsp, currSol, NULL, move);
+    }
+
+    const string getName() const {
+        return "Best Improvement";
+    }
+
+private:
+    TwoOptScanner mScanner;
+};
+
+
+/**
+ * Best improvement over the moves that add a candidate edge (near linear scan)
+ */
+class CandidateBestImprovement : public NeigthborImprovement
+{
+public:
+    double execute(const TSP &tsp, const TSPSolution &currSol, TSPMove &move) {
+        SolverMetrics::Timer timer(SolverMetrics::NEIGHBORHOOD_NS);
+        const CandidateLists& cand = requireCandidates(tsp);
+
         double bestCostVariation = tsp.infinite;
+        move.type = TSPMove::TWO_OPT;
+        uint64_t evaluated = 0;
+
+        forEachCandidateMove(tsp, cand, currSol, [&](int a, int b, double neighCostVariation) {
+            evaluated++;
+            if (neighCostVariation < bestCostVariation) {
+                bestCostVariation = neighCostVariation;
+                move.from = a;
+                move.to = b;
+            }
+            return false;
+        });
 
-        // initial and final position are fixed (initial/final node remains 0)
-        for ( uint a = 1 ; a < currSol.sequence.size() - 2 ; a++ ) {
+        SolverMetrics::add(SolverMetrics::MOVES_EVALUATED, evaluated);
+        return bestCostVariation;
+    }
 
-            int h = currSol.sequence[a-1];
-            int i = currSol.sequence[a];
+    const string getName() const {
+        return "Best Improvement (candidates)";
+    }
+};
 
-            for ( uint b = a + 1 ; b < currSol.sequence.size() - 1 ; b++ ) {
-                int j = currSol.sequence[b];
-                int l = currSol.sequence[b+1];
 
-                // incremental evaluation --> bestCostVariation (instead of best cost)
-                double neighCostVariation = - tsp.cost[h][i] - tsp.cost[j][l]
-                                            + tsp.cost[h][j] + tsp.cost[i][l];
+/**
+ * First improvement over the moves that add a candidate edge
+ */
+class CandidateFirstImprovement : public NeigthborImprovement
+{
+public:
+    double execute(const TSP &tsp, const TSPSolution &currSol, TSPMove &move) {
+        SolverMetrics::Timer timer(SolverMetrics::NEIGHBORHOOD_NS);
+        const CandidateLists& cand = requireCandidates(tsp);
+
+        double bestCostVariation = tsp.infinite;
+        move.type = TSPMove::TWO_OPT;
+        double currValue = currSol.value();
+        uint64_t evaluated = 0;
+
+        forEachCandidateMove(tsp, cand, currSol, [&](int a, int b, double neighCostVariation) {
+            evaluated++;
+            if (neighCostVariation < bestCostVariation) {
+                bestCostVariation = neighCostVariation;
+                move.from = a;
+                move.to = b;
+
+                // on first improvement exit
+                return currValue + bestCostVariation < currValue;
+            }
+            return false;
+        });
+
+        SolverMetrics::add(SolverMetrics::MOVES_EVALUATED, evaluated);
+        return bestCostVariation;
+    }
+
+    const string getName() const {
+        return "First Improvement (candidates)";
+    }
+};
 
-                //cout << endl << "Move from " << a << " to " << b;
-                //cout << "\tNeighbor Variation = " << neighCostVariation << " - BestCostVariation = " << bestCostVariation;
 
-                if ( neighCostVariation < bestCostVariation ) {
-                    //cout << "\tSave! Best neighbor found until now";
+/**
+ * Or-opt: move a segment of 1 ... 3 nodes elsewhere in the tour, in either orientation
+ * (best improvement, O(1) evaluation per move)
+ */
+class OrOptImprovement : public NeigthborImprovement
+{
+public:
+    static const int MAX_SEGMENT = 3;
+
+    double execute(const TSP &tsp, const TSPSolution &currSol, TSPMove &move) {
+        SolverMetrics::Timer timer(SolverMetrics::NEIGHBORHOOD_NS);
+        const std::vector<int>& seq = currSol.sequence;
+        const int last = seq.size() - 1;    // position of the closing node 0
+
+        double bestCostVariation = tsp.infinite;
+        uint64_t evaluated = 0;
+
+        for (int length = 1; length <= MAX_SEGMENT; length++) {
+            // segment at positions i ... i+length-1, between p and q
+            for (int i = 1; i + length - 1 <= last - 1; i++) {
+                int p  = seq[i-1];
+                int s1 = seq[i];
+                int sL = seq[i+length-1];
+                int q  = seq[i+length];
+
+                double removeVariation = - tsp.cost(p, s1) - tsp.cost(sL, q) + tsp.cost(p, q);
+
+                // reinsert between positions j and j+1 outside the segment
+                for (int j = 0; j < last; j++) {
+                    if (j >= i - 1 && j <= i + length - 1) {
+                        continue;
+                    }
+                    int u = seq[j];
+                    int v = seq[j+1];
+
+                    double insertVariation = removeVariation - tsp.cost(u, v);
+                    evaluated += (length > 1) ? 2 : 1;
+
+                    double neighCostVariation = insertVariation + tsp.cost(u, s1) + tsp.cost(sL, v);
+                    if (neighCostVariation < bestCostVariation) {
+                        bestCostVariation = neighCostVariation;
+                        setMove(move, i, j, length, false);
+                    }
+
+                    if (length > 1) {
+                        neighCostVariation = insertVariation + tsp.cost(u, sL) + tsp.cost(s1, v);
+                        if (neighCostVariation < bestCostVariation) {
+                            bestCostVariation = neighCostVariation;
+                            setMove(move, i, j, length, true);
+                        }
+                    }
+                }
+            }
+        }
+
+        SolverMetrics::add(SolverMetrics::MOVES_EVALUATED, evaluated);
+        return bestCostVariation;
+    }
 
+    const string getName() const {
+        return "Or-opt";
+    }
+
+private:
+    static void setMove(TSPMove& move, int from, int to, int length, bool reversed) {
+        move.type = TSPMove::OR_OPT;
+        move.from = from;
+        move.to = to;
+        move.length = length;
+        move.reversed = reversed;
+    }
+};
+
+
+/**
+ * Node swap: exchange two nodes of the tour (best improvement, O(1) evaluation per move)
+ */
+class NodeSwapImprovement : public NeigthborImprovement
+{
+public:
+    double execute(const TSP &tsp, const TSPSolution &currSol, TSPMove &move) {
+        const std::vector<int>& seq = currSol.sequence;
+        const int last = seq.size() - 1;    // position of the closing node 0
+
+        SolverMetrics::Timer timer(SolverMetrics::NEIGHBORHOOD_NS);
+        double bestCostVariation = tsp.infinite;
+        move.type = TSPMove::NODE_SWAP;
+
+        // pairs 1 <= a < b < last
+        SolverMetrics::add(SolverMetrics::MOVES_EVALUATED, (uint64_t)(last - 1) * (last - 2) / 2);
+
+        for (int a = 1; a < last - 1; a++) {
+            int p  = seq[a-1];
+            int x  = seq[a];
+            int xn = seq[a+1];
+
+            // adjacent nodes: p x y q -> p y x q
+            {
+                int y = xn;
+                int q = seq[a+2];
+
+                double neighCostVariation = - tsp.cost(p, x) - tsp.cost(x, y) - tsp.cost(y, q)
+                                            + tsp.cost(p, y) + tsp.cost(y, x) + tsp.cost(x, q);
+                if (neighCostVariation < bestCostVariation) {
+                    bestCostVariation = neighCostVariation;
+                    move.from = a;
+                    move.to = a + 1;
+                }
+            }
+
+            double removeX = - tsp.cost(p, x) - tsp.cost(x, xn);
+
+            for (int b = a + 2; b < last; b++) {
+                int yp = seq[b-1];
+                int y  = seq[b];
+                int q  = seq[b+1];
+
+                double neighCostVariation = removeX - tsp.cost(yp, y) - tsp.cost(y, q)
+                                            + tsp.cost(p, y) + tsp.cost(y, xn)
+                                            + tsp.cost(yp, x) + tsp.cost(x, q);
+                if (neighCostVariation < bestCostVariation) {
                     bestCostVariation = neighCostVariation;
                     move.from = a;
                     move.to = b;
@@ -114,12 +379,11 @@ public:
             }
         }
 
-        //cout << endl << "-----------------------------" << endl;
         return bestCostVariation;
     }
 
     const string getName() const {
-        return "Best Improvement";
+        return "Node Swap";
     }
 };
 
@@ -5,23 +5,48 @@
 
 #include "TSP.h"
 #include "TSPSolution.h"
-
-/**
- * Class representing substring reversal move
- */
-typedef struct move {
-  int from;
-  int to;
-} TSPMove;
-
+#include "StopCriteria.h"
 
 class Solver {
 public:
 
+    virtual ~Solver() {}
+
     virtual std::string getSolverName() const = 0;
 
+    /**
+     * a new solver with the same configuration (stop criteria included) and no
+     * search state, so that runs executed at the same time do not share anything
+     */
+    virtual Solver* clone() const = 0;
+
     virtual bool solve(const TSP& tsp, const TSPSolution& initSol, TSPSolution& bestSol) = 0;
 
+    /**
+     * CPU seconds of the threads the last solve() started (the islands), to add
+     * to the CPU time of the calling thread; 0 for a solver that runs on the
+     * calling thread only
+     */
+    virtual double workerCpuTime() const {
+        return 0;
+    }
+
+    /**
+     * when solve() stops (see StopCriteria); after solve(), reason() tells which
+     * criterion fired
+     */
+    StopCriteria& stopCriteria() {
+        return mStop;
+    }
+
+    const StopCriteria& stopCriteria() const {
+        return mStop;
+    }
+
+protected:
+
+    StopCriteria mStop;
+
 };
 
 #endif // SOLVER
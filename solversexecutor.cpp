@@ -1,9 +1,18 @@
 #include "solversexecutor.h"
 
-#include <fstream>
 #include <ctime>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
 #include <sys/time.h>
 #include <typeinfo>
+#include <memory>
+
+#include "CpuTime.h"
+#include "ThreadPool.h"
+#include "WorkStealingScheduler.h"
+#include "HeldKarpBound.h"
+#include "Logger.h"
 
 #include "TSPSolution.h"
 #include "TabuSearchSolver.h"
@@ -11,14 +20,46 @@
 
 using namespace std;
 
-SolversExecutor::SolversExecutor(const char* filename) : mFilename(filename)
+namespace {
+
+// CSV field: quoted, the solver names contain commas
+string csvField(const string& text) {
+    string field = "\"";
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '"') {
+            field += '"';
+        }
+        field += text[i];
+    }
+    return field + "\"";
+}
+
+// console records of the calling thread kept in buffer until the end of the scope, NULL = written
+class CaptureScope {
+public:
+    explicit CaptureScope(string* buffer) {
+        Logger::capture(buffer);
+    }
+    ~CaptureScope() {
+        Logger::capture(NULL);
+    }
+};
+
+}
+
+SolversExecutor::SolversExecutor(const char* filename) : mFilename(filename), mJobs(1), mLowerBound(0), mTargetGap(-1), mTraceCapacity(0)
 {
     mTspInstance.readFromFile(filename);
 }
 
+void SolversExecutor::buildCandidateLists(int k, bool quadrant) {
+    mTspInstance.buildCandidateLists(k, quadrant);
+}
+
 void SolversExecutor::addRandomSeedInitSolution(int seed) {
     TSPSolution* initSol = new TSPSolution(mTspInstance);
     initSol->initRandom(seed);
+    initSol->evaluate(mTspInstance);
 
     mInitSolutions.push_back(initSol);
 }
@@ -27,10 +68,77 @@ void SolversExecutor::addRandomInitSolution() {
     addRandomSeedInitSolution(time(NULL));
 }
 
+void SolversExecutor::addConstructedInitSolution(TourConstruction::Method method) {
+    // owned here until the construction succeeded
+    unique_ptr<TSPSolution> initSol(new TSPSolution(mTspInstance));
+
+    double startClock = threadCpuTime();
+    timeval tv1, tv2;
+    gettimeofday(&tv1, NULL);
+
+    TourConstruction::build(mTspInstance, method, *initSol);
+
+    gettimeofday(&tv2, NULL);
+    initSol->cpuTime = threadCpuTime() - startClock;
+    initSol->userTime = (double)(tv2.tv_sec+tv2.tv_usec*1e-6 - (tv1.tv_sec+tv1.tv_usec*1e-6));
+    initSol->solveBy = string("Initial tour: ") + TourConstruction::methodName(method);
+
+    mInitSolutions.push_back(initSol.get());
+    initSol.release();
+}
+
 void SolversExecutor::addSolver(Solver *solver) {
     mSolvers.push_back(solver);
 }
 
+void SolversExecutor::computeLowerBound() {
+    double upperBound = mTspInstance.infinite;
+    for (size_t i = 0; i < mInitSolutions.size(); i++) {
+        upperBound = min(upperBound, mInitSolutions[i]->value());
+    }
+
+    double startClock = threadCpuTime();
+
+    // the step sizes scale with upperBound - L: a random initial tour, several
+    // times the optimum, would make the steps overshoot and the bound depend on
+    // the init method. The constructed tours cost O(n k log(n k)) next to the
+    // O(n^2) iterations of the bound
+    TSPSolution constructed(mTspInstance);
+    TourConstruction::build(mTspInstance, TourConstruction::NEAREST_NEIGHBOR, constructed);
+    upperBound = min(upperBound, constructed.value());
+    TourConstruction::build(mTspInstance, TourConstruction::GREEDY, constructed);
+    upperBound = min(upperBound, constructed.value());
+
+    HeldKarpBound bound;
+    mLowerBound = bound.compute(mTspInstance, upperBound);
+
+    LOG_INFO << "Held-Karp lower bound " << mLowerBound << "\t(" << bound.iterations() << " iterations, "
+             << threadCpuTime() - startClock << " sec. CPU time" << (bound.optimal() ? ", optimal tour" : "") << ")";
+}
+
+void SolversExecutor::setTargetGap(double gap) {
+    mTargetGap = gap;
+}
+
+void SolversExecutor::printGap(Logger::Channel channel, double value) const {
+    if (mLowerBound <= 0) {
+        return;
+    }
+    if (channel == Logger::CONSOLE) {
+        LOG_INFO << "gap to lower bound " << 100 * HeldKarpBound::gap(value, mLowerBound) << " %";
+    } else {
+        LOG_FILE(channel) << "gap to lower bound " << 100 * HeldKarpBound::gap(value, mLowerBound) << " %";
+    }
+}
+
+void SolversExecutor::setJobs(int jobs) {
+    mJobs = jobs > 0 ? jobs : ThreadPool::defaultThreads();
+}
+
+void SolversExecutor::enableTrace(size_t capacity) {
+    mTraceCapacity = capacity;
+}
+
 void SolversExecutor::execute() {
 
     // name log file with actual date
@@ -47,18 +155,69 @@ void SolversExecutor::execute() {
     string fileNameStr = string(mFilename);
     fileNameStr.erase(0, 5);
 
-    ofstream outputLog("Log/" + fileNameStr + "-outputLog-" + nowTime + ".txt");
-    ofstream latexLog("Log/" + fileNameStr + "-latexLog-" + nowTime + ".txt");
+    Logger& logger = Logger::instance();
+    logger.open(Logger::OUTPUT_LOG, "Log/" + fileNameStr + "-outputLog-" + nowTime + ".txt");
+    logger.open(Logger::LATEX_LOG, "Log/" + fileNameStr + "-latexLog-" + nowTime + ".txt");
     //ofstream csvLog("Log/" + fileNameStr + "-csvLog-" + nowTime + ".csv");
 
     //csvLog << "Length, Avg. Value, Avg. Time, Best Value found, Total time" << endl;
 
-    latexLog << "Solver, Avg Value, Best Value found, Avg. Time, Total time, Avg Iter" << endl;
+    LOG_FILE(Logger::LATEX_LOG) << "Solver, Avg Value, Best Value found, Avg. Time, Total time, Avg Iter";
+
+    if (mTargetGap >= 0 && mLowerBound <= 0) {
+        computeLowerBound();
+    }
+
+    // run r = solver r / #init solutions on init solution r % #init solutions
+    const int inits = mInitSolutions.size();
+    const int runs = mSolvers.size() * inits;
+
+    WorkStealingScheduler scheduler(mJobs);
+    const bool parallel = scheduler.threads() > 1 && runs > 1;
+
+    vector< unique_ptr<TSPSolution> > results(runs);
+    vector<string> outputs(parallel ? runs : 0);
+
+    // allocated before the runs: recording never allocates
+    mTraces.assign(mTraceCapacity > 0 ? runs : 0, ConvergenceTrace(mTraceCapacity));
+
+    try {
+        scheduler.run(runs, [&](int r) {
+            CaptureScope capture(parallel ? &outputs[r] : NULL);
+
+            unique_ptr<Solver> solver(mSolvers[r / inits]->clone());
+            solver->stopCriteria().setCancellation(&mCancellation);
+            if (mTargetGap >= 0) {
+                solver->stopCriteria().setTargetValue(mLowerBound * (1 + mTargetGap));
+            }
+            if (mTraceCapacity > 0) {
+                solver->stopCriteria().setTrace(&mTraces[r]);
+            }
+            results[r].reset(new TSPSolution(mTspInstance));
+            executeAndMeasureTime(*solver, *mInitSolutions[r % inits], *results[r]);
+        });
+    }
+    catch (...) {
+        // the scheduler ends every run before it throws: print their output, that
+        // of the failed run up to the error
+        for (size_t r = 0; r < outputs.size(); r++) {
+            logger.submit(Logger::CONSOLE, outputs[r]);
+        }
+        throw;
+    }
+
+    if (parallel) {
+        for (int r = 0; r < runs; r++) {
+            logger.submit(Logger::CONSOLE, outputs[r]);
+        }
+    }
+
+    vector< unique_ptr<TSPSolution> >::iterator result = results.begin();
 
 
     for (std::vector<Solver*>::iterator it = mSolvers.begin(); it != mSolvers.end(); ++it) {
 
-        latexLog << endl;
+        LOG_FILE(Logger::LATEX_LOG) << "";
 
         int i = 0;
         double values[mInitSolutions.size()];
@@ -68,32 +227,33 @@ void SolversExecutor::execute() {
 
         for (std::vector<TSPSolution*>::iterator inIt = mInitSolutions.begin(); inIt != mInitSolutions.end(); ++inIt) {
 
-            TSPSolution* bestSolution = new TSPSolution(mTspInstance);
-            executeAndMeasureTime(*(*it), **inIt, *bestSolution);
+            TSPSolution* bestSolution = (result++)->release();
 
             mBestSolutions.push_back(bestSolution);
 
 
             // print solution into log file
-            double value = bestSolution->evaluateObjectiveFunction(mTspInstance);
+            double value = bestSolution->value();
 
             if (value < bestOfBestvalue) {
                 bestOfBestvalue = value;
             }
 
             // print logconsole result of init solution solved
-            outputLog << std::endl << "----------------------------------------------------------------------" << std::endl
-                      << std::endl << bestSolution->solveBy << std::endl;
+            LOG_FILE(Logger::OUTPUT_LOG) << "\n----------------------------------------------------------------------\n"
+                                         << "\n" << bestSolution->solveBy;
 
             //bestSolution->print(outputLog);
 
-            outputLog << "(value : " << value << ")\t"
-                      << "sec. (user time) " << bestSolution->userTime << "\t"
-                      << "sec. (CPU time) " << bestSolution->cpuTime << "\t"
-                      << "Max iterations " << bestSolution->iterations << endl;
+            LOG_FILE(Logger::OUTPUT_LOG) << "(value : " << value << ")\t"
+                                         << "sec. (user time) " << bestSolution->userTime << "\t"
+                                         << "sec. (CPU time) " << bestSolution->cpuTime << "\t"
+                                         << "Max iterations " << bestSolution->iterations << "\t"
+                                         << "stop: " << bestSolution->stopBy;
+            printGap(Logger::OUTPUT_LOG, value);
 
             // print latex result of init solution solved
-            latexLog << bestSolution->solveBy << ", " << value << ", " << bestSolution->cpuTime << endl;
+            LOG_FILE(Logger::LATEX_LOG) << bestSolution->solveBy << ", " << value << ", " << bestSolution->cpuTime;
 
             // for compute average
             values[i] = value;
@@ -119,13 +279,12 @@ void SolversExecutor::execute() {
 
         //latexLog << endl;
         //latexLog << "Solver, Avg Value, Avg. Time, Best Value found, Total time, Avg Iter" << endl;
-        latexLog << (*it)->getSolverName()
-                 << ", " << avgValue
-                 << ", " << bestOfBestvalue
-                 << ", " << avgTime
-                 << ", " << sumTime
-                 << ", " << avgIter;
-        latexLog << endl;
+        LOG_FILE(Logger::LATEX_LOG) << (*it)->getSolverName()
+                                    << ", " << avgValue
+                                    << ", " << bestOfBestvalue
+                                    << ", " << avgTime
+                                    << ", " << sumTime
+                                    << ", " << avgIter;
 
 
         // Print result for Calibration of TS
@@ -139,8 +298,8 @@ void SolversExecutor::execute() {
     }
 
     //csvLog.close();
-    latexLog.close();
-    outputLog.close();
+    logger.close(Logger::LATEX_LOG);
+    logger.close(Logger::OUTPUT_LOG);
 }
 
 void SolversExecutor::executeAndMeasureTime(Solver& tspSolver, TSPSolution& initSol, TSPSolution& bestSol) {
@@ -148,46 +307,50 @@ void SolversExecutor::executeAndMeasureTime(Solver& tspSolver, TSPSolution& init
     bestSol.solveBy = tspSolver.getSolverName();
 
     std::string tmp = "-----------------------------";
-    std::cout << std::endl << tmp << tspSolver.getSolverName() << tmp << std::endl << std::endl;
+    LOG_INFO << "\n" << tmp << tspSolver.getSolverName() << tmp << "\n";
 
     // initialize clocks for running time recording
     //   two ways:
     //   1) CPU time (t2 - t1)
     //   2) wall-clock time (tv2 - tv1)
-    clock_t startClock, finishClock;
+    //   CPU time is the one of this thread, runs may execute in parallel, plus
+    //   that of the threads of the solver (islands)
+    double startClock, finishClock;
     timeval  tv1, tv2;
 
-    startClock = clock();
+    startClock = threadCpuTime();
     gettimeofday(&tv1, NULL);
 
     tspSolver.solve(mTspInstance, initSol, bestSol);
 
-    finishClock = clock();
+    finishClock = threadCpuTime();
     gettimeofday(&tv2, NULL);
 
     bestSol.userTime = (double)(tv2.tv_sec+tv2.tv_usec*1e-6 - (tv1.tv_sec+tv1.tv_usec*1e-6));
-    bestSol.cpuTime = (double)(finishClock - startClock) / CLOCKS_PER_SEC;
+    bestSol.cpuTime = finishClock - startClock + tspSolver.workerCpuTime();
+    bestSol.stopBy = tspSolver.stopCriteria().reasonName();
 }
 
 void SolversExecutor::printInitSolutions() const {
     for (vector<TSPSolution*>::const_iterator it = mInitSolutions.begin(); it != mInitSolutions.end(); ++it) {
-        cout << endl << (*it)->solveBy << endl;
-        cout << "(value : " << (*it)->evaluateObjectiveFunction(mTspInstance) << ")\n";
-        cout << "sec. (user time) " << (*it)->userTime << endl;
-        cout << "sec. (CPU time) " << (*it)->cpuTime << endl;
-        cout << "Max iterations " << (*it)->iterations << endl;
+        LOG_INFO << "\n" << (*it)->solveBy << "\n"
+                 << "(value : " << (*it)->value() << ")";
+        printGap(Logger::CONSOLE, (*it)->value());
+        LOG_INFO << "sec. (user time) " << (*it)->userTime << "\n"
+                 << "sec. (CPU time) " << (*it)->cpuTime << "\n"
+                 << "Max iterations " << (*it)->iterations;
     }
 }
 
 void SolversExecutor::printResults() const {
-    std::cout << "----------------------------------------------------------------------" << std::endl;
+    LOG_INFO << "----------------------------------------------------------------------";
 
     TSPSolution* bestSolutionFound;
     std::vector<TSPSolution*> bestSolutionsFound;
     double bestValue = 1e10;
 
     for (vector<TSPSolution*>::const_iterator it = mBestSolutions.begin(); it != mBestSolutions.end(); ++it) {
-        double value = (*it)->evaluateObjectiveFunction(mTspInstance);
+        double value = (*it)->value();
 
         if (value < bestValue) {
             bestValue = value;
@@ -198,34 +361,123 @@ void SolversExecutor::printResults() const {
             bestSolutionsFound.push_back(*it);
         }
 
-        std::cout << std::endl << (*it)->solveBy << std::endl;
-        std::cout << "(value : " << value << ")\n";
-        std::cout << "sec. (user time) " << (*it)->userTime << std::endl;
-        std::cout << "sec. (CPU time) " << (*it)->cpuTime << std::endl;
-        cout << "Max iterations " << (*it)->iterations << endl;
+        LOG_INFO << "\n" << (*it)->solveBy << "\n"
+                 << "(value : " << value << ")";
+        printGap(Logger::CONSOLE, value);
+        LOG_INFO << "sec. (user time) " << (*it)->userTime << "\n"
+                 << "sec. (CPU time) " << (*it)->cpuTime << "\n"
+                 << "Max iterations " << (*it)->iterations << "\n"
+                 << "stop: " << (*it)->stopBy;
     }
 
     if (mBestSolutions.size() > 1) {
 
-        std::cout << "------------------------------- THE WINNER -------------------------------------" << std::endl;
+        LOG_INFO << "------------------------------- THE WINNER -------------------------------------";
 
-        std::cout << std::endl << bestSolutionFound->solveBy << std::endl;
-        std::cout << "(value : " << bestValue << ")\n";
-        std::cout << "sec. (user time) " << bestSolutionFound->userTime << std::endl;
-        std::cout << "sec. (CPU time) " << bestSolutionFound->cpuTime << std::endl;
+        LOG_INFO << "\n" << bestSolutionFound->solveBy << "\n"
+                 << "(value : " << bestValue << ")";
+        printGap(Logger::CONSOLE, bestValue);
+        LOG_INFO << "sec. (user time) " << bestSolutionFound->userTime << "\n"
+                 << "sec. (CPU time) " << bestSolutionFound->cpuTime;
 
-        std::cout << "------------------------------- THE WINNERS -------------------------------------" << std::endl;
+        LOG_INFO << "------------------------------- THE WINNERS -------------------------------------";
 
         for (vector<TSPSolution*>::const_iterator it = bestSolutionsFound.begin(); it != bestSolutionsFound.end(); ++it) {
-            double value = (*it)->evaluateObjectiveFunction(mTspInstance);
+            double value = (*it)->value();
 
-            std::cout << std::endl << (*it)->solveBy << std::endl;
-            std::cout << "(value : " << value << ")\n";
-            std::cout << "sec. (user time) " << (*it)->userTime << std::endl;
-            std::cout << "sec. (CPU time) " << (*it)->cpuTime << std::endl;
+            LOG_INFO << "\n" << (*it)->solveBy << "\n"
+                     << "(value : " << value << ")";
+            printGap(Logger::CONSOLE, value);
+            LOG_INFO << "sec. (user time) " << (*it)->userTime << "\n"
+                     << "sec. (CPU time) " << (*it)->cpuTime;
         }
     }
 
-    cout << endl;
+    LOG_INFO << "";
 }
 
+void SolversExecutor::writeTrace(const string& filename) const {
+    ofstream out(filename.c_str());
+    if (!out) {
+        throw runtime_error("cannot create " + filename);
+    }
+    out.precision(10);
+    out << "run,solver,init,seconds,iteration,value\n";
+
+    const int inits = mInitSolutions.size();
+    size_t dropped = 0;
+
+    for (size_t r = 0; r < mTraces.size(); r++) {
+        const TSPSolution& init = *mInitSolutions[r % inits];
+        ostringstream columns;
+        columns << r << ',' << csvField(mSolvers[r / inits]->getSolverName()) << ',' << csvField(init.solveBy);
+
+        out << columns.str() << ",0,0," << init.value() << '\n';
+        mTraces[r].writeCsv(out, columns.str());
+        dropped += mTraces[r].dropped();
+    }
+
+    if (!out) {
+        throw runtime_error("cannot write " + filename);
+    }
+    if (dropped > 0) {
+        LOG_WARN << "trace: " << dropped << " later samples dropped (decimated), raise the capacity";
+    }
+    LOG_INFO << "trace written to " << filename;
+}
+
+void SolversExecutor::printTimeToTarget(const vector<double>& gaps) const {
+    if (mTraces.empty()) {
+        return;
+    }
+
+    double reference = mLowerBound;
+    const char* referenceName = "lower bound";
+    if (reference <= 0) {
+        reference = mTspInstance.infinite;
+        for (size_t r = 0; r < mBestSolutions.size(); r++) {
+            reference = min(reference, mBestSolutions[r]->value());
+        }
+        referenceName = "best value";
+    }
+
+    const int inits = mInitSolutions.size();
+
+    LOG_INFO << "------------------------------- TIME TO TARGET -------------------------------------";
+    LOG_INFO << "targets relative to the " << referenceName << " " << reference << ", wall-clock seconds";
+
+    for (size_t s = 0; s < mSolvers.size(); s++) {
+        LOG_INFO << "\n" << mSolvers[s]->getSolverName();
+
+        for (size_t g = 0; g < gaps.size(); g++) {
+            double target = reference * (1 + gaps[g]);
+
+            vector<double> times;
+            int upperBounds = 0;
+            for (int i = 0; i < inits; i++) {
+                bool exact = true;
+                double seconds = (mInitSolutions[i]->value() <= target) ? 0 : mTraces[s * inits + i].timeToTarget(target, &exact);
+                if (seconds >= 0) {
+                    times.push_back(seconds);
+                    upperBounds += exact ? 0 : 1;
+                }
+            }
+            sort(times.begin(), times.end());
+
+            if (times.empty()) {
+                LOG_INFO << "  " << 100 * gaps[g] << " % (" << target << "): reached 0/" << inits;
+            } else {
+                ostringstream dropped;
+                if (upperBounds > 0) {
+                    dropped << "\t(" << upperBounds << " upper bounds, trace samples dropped)";
+                }
+                LOG_INFO << "  " << 100 * gaps[g] << " % (" << target << "): reached " << times.size() << "/" << inits
+                         << "\tmin " << times.front()
+                         << "\tmedian " << (times[(times.size() - 1) / 2] + times[times.size() / 2]) / 2
+                         << "\tmax " << times.back() << dropped.str();
+            }
+        }
+    }
+
+    LOG_INFO << "";
+}
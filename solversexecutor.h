@@ -8,6 +8,10 @@
 #include "solver.h"
 #include "TSP.h"
 #include "TSPSolution.h"
+#include "TourConstruction.h"
+#include "StopCriteria.h"
+#include "Logger.h"
+#include "ConvergenceTrace.h"
 
 using namespace std;
 
@@ -22,17 +26,95 @@ private:
 
     vector<TSPSolution*> mInitSolutions;
 
+    int mJobs;
+
+    double mLowerBound;     // 0 until computeLowerBound()
+    double mTargetGap;      // < 0: no target
+
+    CancellationToken mCancellation;
+
+    size_t mTraceCapacity;              // 0: no trace
+    vector<ConvergenceTrace> mTraces;   // one per run, in the order of mBestSolutions
+
+    /** "gap to lower bound" line of a result, nothing without a bound */
+    void printGap(Logger::Channel channel, double value) const;
+
 public:
     SolversExecutor(const char *filename);
 
+    /**
+     * build the candidate lists of the instance, needed by the candidate scans
+     * @param k candidates per node
+     * @param quadrant use quadrant neighbours
+     */
+    void buildCandidateLists(int k, bool quadrant);
+
     void addRandomSeedInitSolution(int seed);
 
     void addRandomInitSolution();
 
+    /**
+     * initial solution built by a constructive heuristic, its time is recorded
+     * and reported by printInitSolutions()
+     */
+    void addConstructedInitSolution(TourConstruction::Method method);
+
     void addSolver(Solver* solver);
 
+    /**
+     * Held-Karp lower bound of the instance (see HeldKarpBound), the results then
+     * report their gap to it. The best initial solution sets the subgradient steps,
+     * so add the initial solutions first.
+     */
+    void computeLowerBound();
+
+    /**
+     * stop every run as soon as its tour is within gap of the lower bound
+     * (computed by execute() if it is not yet)
+     * @param gap relative gap, 0.01 = 1%
+     */
+    void setTargetGap(double gap);
+
+    /**
+     * cancelling it stops every run at its next stop criteria check, the runs keep
+     * their best tour (e.g. from a SIGINT handler)
+     */
+    CancellationToken& cancellation() {
+        return mCancellation;
+    }
+
+    /**
+     * number of runs (solver, initial solution) executed at the same time, on a
+     * work-stealing scheduler; every run uses its own clone of the solver
+     * @param jobs 1 = serial, 0 = one per hardware thread
+     */
+    void setJobs(int jobs);
+
+    /**
+     * every run records the improvements of its best value (see ConvergenceTrace),
+     * for writeTrace() and printTimeToTarget()
+     * @param capacity samples kept per run
+     */
+    void enableTrace(size_t capacity = ConvergenceTrace::DEFAULT_CAPACITY);
+
     void execute();
 
+    /**
+     * write the traces of the runs of execute(), CSV with the header
+     * run,solver,init,seconds,iteration,value; the first line of a run is its
+     * initial solution at 0 seconds
+     * @throw std::runtime_error if the file cannot be created
+     */
+    void writeTrace(const string& filename) const;
+
+    /**
+     * for every solver and target, how many runs reached the target and in how
+     * many wall-clock seconds (min, median, max)
+     * @param gaps targets, relative to the lower bound if computed, else to the
+     *        best value of all runs (0.01 = 1%)
+     */
+    void printTimeToTarget(const vector<double>& gaps) const;
+
     void executeAndMeasureTime(Solver& tspSolver, TSPSolution& initSol, TSPSolution& bestSol);
 
     void printInitSolutions() const;
@@ -0,0 +1,85 @@
+/**
+ * @file BenchmarkRunnerTest.cpp
+ * @brief BenchmarkRunner: config checks, results file round trip, comparison with itself
+ */
+
+#include <fstream>
+#include <cstdio>
+#include <stdexcept>
+
+#include "Check.h"
+#include "BenchmarkRunner.h"
+#include "Logger.h"
+
+using namespace std;
+
+namespace {
+
+const char* CONFIG = "test/BenchmarkRunnerTest.conf";
+const char* RESULTS = "test/BenchmarkRunnerTest.csv";
+
+void writeConfig(const string& text) {
+    ofstream out(CONFIG);
+    out << text;
+}
+
+bool rejected(const string& text) {
+    writeConfig(text);
+    BenchmarkRunner runner;
+    try {
+        runner.readConfig(CONFIG);
+    }
+    catch (runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+/** the names go into CSV fields */
+void testCommas() {
+    CHECK(!rejected("instance data/tsp12.dat\nsolver ls --ls\n"));
+    CHECK(rejected("instance data/tsp12,b.dat\nsolver ls --ls\n"));
+    CHECK(rejected("instance data/tsp12.dat\nsolver ls,fi --ls\n"));
+    CHECK(rejected("instance data/tsp12.dat\nsolver ls --ls\nbudget a,b --secs 1\n"));
+    CHECK(rejected("instance data/tsp12.dat\nsolver ls --bogus\n"));
+    CHECK(rejected("solver ls --ls\n"));
+}
+
+void testRoundTrip() {
+    writeConfig("instance data/tsp12.dat\n"
+                "solver ls --ls --fi\n"
+                "solver ts --ts --tenure 5 --maxIter 100\n"
+                "seeds 1 2 3\n");
+    BenchmarkRunner runner;
+    runner.readConfig(CONFIG);
+    runner.run();
+    runner.writeResults(RESULTS);
+
+    const vector<BenchmarkRunner::Cell>& cells = runner.cells();
+    vector<BenchmarkRunner::Cell> read = BenchmarkRunner::readResults(RESULTS);
+    CHECK(cells.size() == 2);
+    CHECK(read.size() == cells.size());
+    for (size_t c = 0; c < read.size() && c < cells.size(); c++) {
+        CHECK(read[c].instance == cells[c].instance);
+        CHECK(read[c].solver == cells[c].solver);
+        CHECK(read[c].budget == "default");
+        CHECK(read[c].value.n == 3);
+        CHECK_NEAR(read[c].value.mean, cells[c].value.mean, 1e-6 * cells[c].value.mean);
+    }
+
+    // a run against its own results: no regression
+    CHECK(runner.compare(read, 0.005, 0.1, 0.05) == 0);
+
+    remove(CONFIG);
+    remove(RESULTS);
+}
+
+}
+
+int main() {
+    Logger::setLevel(Logger::ERROR);
+
+    testCommas();
+    testRoundTrip();
+    return checkResult("BenchmarkRunner");
+}
@@ -0,0 +1,104 @@
+/**
+ * @file CandidateListsTest.cpp
+ * @brief CandidateLists against a brute force search, plain and quadrant lists
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include "Check.h"
+#include "CandidateLists.h"
+
+using namespace std;
+
+namespace {
+
+/** k distinct candidates per node, sorted by cost, none costing more than a non-candidate */
+void checkNearest(const TSP& tsp, const CandidateLists& lists, int k) {
+    for (int i = 0; i < tsp.n; i++) {
+        CHECK(lists.size(i) == min(k, tsp.n - 1));
+
+        double farthest = 0;
+        for (const int* it = lists.begin(i); it != lists.end(i); ++it) {
+            CHECK(*it != i);
+            CHECK(count(lists.begin(i), lists.end(i), *it) == 1);
+            if (it != lists.begin(i)) {
+                CHECK(tsp.cost(i, *(it - 1)) <= tsp.cost(i, *it));
+            }
+            farthest = max(farthest, tsp.cost(i, *it));
+        }
+        for (int j = 0; j < tsp.n; j++) {
+            if (j != i && !lists.contains(i, j)) {
+                CHECK(tsp.cost(i, j) >= farthest);
+            }
+        }
+    }
+}
+
+void testMatrix() {
+    TSP tsp;
+    randomInstance(tsp, 120, 1);
+    CandidateLists lists(tsp, 8);
+    checkNearest(tsp, lists, 8);
+    CHECK(!lists.quadrant());
+
+    CandidateLists all(tsp, 500);
+    CHECK(all.k() == tsp.n - 1);
+    checkNearest(tsp, all, tsp.n - 1);
+}
+
+/** the grid search of coordinate instances finds the nearest nodes too */
+void testGrid() {
+    TSP tsp;
+    randomInstance(tsp, 2000, 2, false);
+    checkNearest(tsp, CandidateLists(tsp, 10), 10);
+    checkNearest(tsp, CandidateLists(tsp, 1), 1);
+}
+
+/** the k/4 nearest nodes of each quadrant are candidates, at most k in all */
+void testQuadrant(int k) {
+    TSP tsp;
+    randomInstance(tsp, 1000, 3, false);
+    const TSPCoordinates& coords = *tsp.coordinates();
+    CandidateLists lists(tsp, k, true);
+    CHECK(lists.quadrant());
+
+    const int perQuadrant = max(1, k / 4);
+    for (int i = 0; i < tsp.n; i++) {
+        CHECK(lists.size(i) == k);
+
+        vector< pair<double, int> > quadrants[4];
+        for (int j = 0; j < tsp.n; j++) {
+            if (j != i) {
+                double dx = coords.x(j) - coords.x(i);
+                double dy = coords.y(j) - coords.y(i);
+                quadrants[(dx >= 0 ? 0 : 1) + (dy >= 0 ? 0 : 2)].push_back(make_pair(dx * dx + dy * dy, j));
+            }
+        }
+
+        int present = 0;
+        for (int q = 0; q < 4; q++) {
+            sort(quadrants[q].begin(), quadrants[q].end());
+            for (int t = 0; t < perQuadrant && t < (int)quadrants[q].size(); t++) {
+                present += lists.contains(i, quadrants[q][t].second) ? 1 : 0;
+            }
+        }
+        int expected = 0;
+        for (int q = 0; q < 4; q++) {
+            expected += min(perQuadrant, (int)quadrants[q].size());
+        }
+        // k < 4: the nearest nodes of k quadrants, fewer if some are empty
+        CHECK(present == min(k, expected));
+    }
+}
+
+}
+
+int main() {
+    testMatrix();
+    testGrid();
+    for (int k = 1; k <= 8; k++) {
+        testQuadrant(k);
+    }
+    return checkResult("CandidateLists");
+}
@@ -0,0 +1,75 @@
+/**
+ * @file Check.h
+ * @brief Minimal checks for the behaviour tests of make check
+ *
+ */
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <iostream>
+#include <random>
+#include <cmath>
+
+#include "TSP.h"
+#include "TSPCoordinates.h"
+
+/**
+ * A test program calls its test functions from main() and returns
+ * checkResult(): every failed CHECK is printed with its line, the program
+ * fails if any did.
+ */
+inline int& checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline bool checkReport(bool ok, const char* expression, const char* file, int line) {
+    if (!ok) {
+        std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+        checkFailures()++;
+    }
+    return ok;
+}
+
+#define CHECK(condition) checkReport((condition), #condition, __FILE__, __LINE__)
+
+#define CHECK_NEAR(a, b, tolerance) \
+    checkReport(std::fabs((double)(a) - (double)(b)) <= (tolerance), #a " ~ " #b, __FILE__, __LINE__)
+
+inline int checkResult(const char* test) {
+    if (checkFailures() > 0) {
+        std::cerr << test << ": " << checkFailures() << " failed" << std::endl;
+        return 1;
+    }
+    std::cout << test << ": ok" << std::endl;
+    return 0;
+}
+
+/**
+ * random points in a 1000 x 1000 square, the same for a given seed
+ * @param matrix store the distance matrix, else compute the distances on demand
+ */
+inline void randomInstance(TSP& tsp, int n, unsigned seed, bool matrix = true) {
+    std::minstd_rand random(seed);
+    std::uniform_real_distribution<double> coordinate(0, 1000);
+    std::vector<double> x(n), y(n);
+    for (int i = 0; i < n; i++) {
+        x[i] = coordinate(random);
+        y[i] = coordinate(random);
+    }
+    std::shared_ptr<const TSPCoordinates> points(new TSPCoordinates(TSPCoordinates::EUC_2D, x, y));
+
+    if (!matrix) {
+        tsp.adoptCoordinates(points);
+        return;
+    }
+    tsp.resize(n);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            tsp.setCost(i, j, points->distance(i, j));
+        }
+    }
+}
+
+#endif /* CHECK_H */
@@ -0,0 +1,121 @@
+/**
+ * @file ConvergenceTraceTest.cpp
+ * @brief ConvergenceTrace: decimation when full, time to target, merge of the islands
+ */
+
+#include "Check.h"
+#include "ConvergenceTrace.h"
+#include "AllocationCounter.h"
+
+using namespace std;
+
+namespace {
+
+// improvement r at r seconds, value 1000 - r
+void recordImprovements(ConvergenceTrace& trace, int improvements) {
+    for (int r = 1; r <= improvements; r++) {
+        trace.record(r, 10 * r, 1000 - r);
+    }
+}
+
+void testTimeToTarget() {
+    ConvergenceTrace trace(16);
+    recordImprovements(trace, 10);
+
+    bool exact = false;
+    CHECK(trace.size() == 10);
+    CHECK(trace.dropped() == 0);
+    CHECK(trace.timeToTarget(995, &exact) == 5);
+    CHECK(exact);
+    CHECK(trace.timeToTarget(994.5) == 6);
+    CHECK(trace.timeToTarget(2000) == 1);
+    CHECK(trace.timeToTarget(989) < 0);
+}
+
+/** full buffer: the first half is kept, the rest decimated, the last sample kept */
+void testDecimation() {
+    const int capacity = 16;
+    const int improvements = 1000;
+    ConvergenceTrace trace(capacity);
+    recordImprovements(trace, improvements);
+
+    CHECK(trace.size() <= (size_t)capacity);
+    CHECK(trace.size() + trace.dropped() == (size_t)improvements);
+    for (int i = 0; i < capacity / 2; i++) {
+        CHECK(trace[i].seconds == i + 1);
+    }
+    CHECK(trace[trace.size() - 1].seconds == improvements);
+    for (size_t i = 1; i < trace.size(); i++) {
+        CHECK(trace[i - 1].seconds < trace[i].seconds);
+        CHECK(trace[i - 1].value > trace[i].value);
+    }
+
+    // loose targets, reached in the first half: exact
+    bool exact = false;
+    CHECK(trace.timeToTarget(996, &exact) == 4);
+    CHECK(exact);
+
+    // tight targets: an upper bound of the true time, flagged as such unless exact
+    for (double target = 990; target >= 1000 - improvements; target -= 7) {
+        double seconds = trace.timeToTarget(target, &exact);
+        CHECK(seconds >= 1000 - target);
+        if (exact) {
+            CHECK(seconds == 1000 - target);
+        }
+    }
+    CHECK(trace.timeToTarget(1000 - improvements) == improvements);
+}
+
+void testRecordDoesNotAllocate() {
+    ConvergenceTrace trace(64);
+    unsigned long before = AllocationCounter::count();
+    recordImprovements(trace, 10000);
+    if (AllocationCounter::enabled()) {
+        CHECK(AllocationCounter::count() == before);
+    }
+}
+
+void testMergeBest() {
+    ConvergenceTrace a(16), b(16), merged(16);
+    a.record(1, 1, 100);
+    a.record(3, 2, 90);
+    a.record(6, 3, 70);
+    b.record(2, 1, 95);
+    b.record(4, 2, 92);     // not an improvement of the best of both
+    b.record(5, 3, 80);
+
+    vector<const ConvergenceTrace*> traces;
+    traces.push_back(&a);
+    traces.push_back(&b);
+    merged.mergeBest(traces);
+
+    const double seconds[] = {1, 2, 3, 5, 6};
+    const double values[] = {100, 95, 90, 80, 70};
+    CHECK(merged.size() == 5);
+    for (size_t i = 0; i < merged.size() && i < 5; i++) {
+        CHECK(merged[i].seconds == seconds[i]);
+        CHECK(merged[i].value == values[i]);
+    }
+
+    bool exact = false;
+    CHECK(merged.timeToTarget(85, &exact) == 5);
+    CHECK(exact);
+
+    // a decimated island: no exact time any more
+    ConvergenceTrace full(4);
+    recordImprovements(full, 20);
+    traces.push_back(&full);
+    merged.mergeBest(traces);
+    merged.timeToTarget(999, &exact);
+    CHECK(!exact);
+}
+
+}
+
+int main() {
+    testTimeToTarget();
+    testDecimation();
+    testRecordDoesNotAllocate();
+    testMergeBest();
+    return checkResult("ConvergenceTrace");
+}
@@ -0,0 +1,251 @@
+/**
+ * @file MoveJournalTest.cpp
+ * @brief MoveJournal against a naive copy of the best solution, rollback, and its allocations
+ */
+
+#include <random>
+#include <stdexcept>
+
+#include "Check.h"
+#include "TSPSolution.h"
+#include "MoveJournal.h"
+#include "AllocationCounter.h"
+
+using namespace std;
+
+namespace {
+
+// a random legal move of the three types on a tour of n nodes
+TSPMove randomMove(minstd_rand& random, int n) {
+    const int last = n;     // position of the closing node 0
+    TSPMove move;
+    int type = random() % 3;
+
+    if (type == 0) {
+        move.type = TSPMove::TWO_OPT;
+        move.from = 1 + random() % (last - 2);
+        move.to = move.from + 1 + random() % (last - 1 - move.from);
+    } else if (type == 1) {
+        move.type = TSPMove::NODE_SWAP;
+        move.from = 1 + random() % (last - 2);
+        move.to = move.from + 1 + random() % (last - 1 - move.from);
+    } else {
+        move.type = TSPMove::OR_OPT;
+        move.length = 1 + random() % 3;
+        move.reversed = random() % 2 == 0;
+        move.from = 1 + random() % (last - move.length);
+        do {
+            move.to = random() % last;
+        } while (move.to >= move.from - 1 && move.to <= move.from + move.length - 1);
+    }
+    return move;
+}
+
+/**
+ * a walk of random moves, the best marked at the improvements and at random:
+ * best() must be the naive copy made at the last mark, every journal call after
+ * the warm-up must not allocate
+ */
+void testAgainstNaiveCopy(int n, int steps, unsigned seed) {
+    TSP tsp;
+    randomInstance(tsp, n, seed);
+    minstd_rand random(seed);
+
+    TSPSolution current(tsp);
+    current.initRandom(seed);
+    current.evaluate(tsp);
+    TSPSolution naive(current);
+
+    MoveJournal journal;
+    journal.reset(current);
+
+    const int warmup = 4 * (n + 1);     // the journal fills up and compacts at least once
+    unsigned long allocations = 0;
+
+    for (int step = 0; step < steps; step++) {
+        TSPMove move = randomMove(random, n);
+        current.apply(tsp, move);
+
+        unsigned long before = AllocationCounter::count();
+        journal.record(tsp, move);
+        if (current.value() < naive.value() || random() % 20 == 0) {
+            journal.markBest(current);
+            naive = current;
+        }
+        if (step % 97 == 0) {
+            const TSPSolution& best = journal.best(tsp);
+            CHECK(best.sequence == naive.sequence);
+        }
+        if (step >= warmup) {
+            allocations += AllocationCounter::count() - before;
+        }
+    }
+
+    const TSPSolution& best = journal.best(tsp);
+    CHECK(best.sequence == naive.sequence);
+    CHECK_NEAR(best.value(), naive.evaluateObjectiveFunction(tsp), 1e-6);
+    CHECK_NEAR(best.value(), best.evaluateObjectiveFunction(tsp), 1e-6);
+    if (AllocationCounter::enabled()) {
+        CHECK(allocations == 0);
+    }
+}
+
+/** no mark after the start: the journal overflows, best() is still the start */
+void testOverflowWithoutMark() {
+    TSP tsp;
+    randomInstance(tsp, 30, 7);
+    minstd_rand random(7);
+
+    TSPSolution current(tsp);
+    TSPSolution start(current);
+    MoveJournal journal;
+    journal.reset(current);
+
+    for (int step = 0; step < 1000; step++) {
+        TSPMove move = randomMove(random, tsp.n);
+        current.apply(tsp, move);
+        journal.record(tsp, move);
+    }
+    CHECK(journal.best(tsp).sequence == start.sequence);
+
+    // the next mark copies the current solution
+    journal.markBest(current);
+    CHECK(journal.best(tsp).sequence == current.sequence);
+}
+
+/**
+ * mark, trial moves with the best marked now and then, rollback: the current
+ * and the best solution must be those at the mark, without allocation after
+ * the warm-up. Long walks without a best in between detach the journal.
+ */
+void testRollback(int n, unsigned seed) {
+    TSP tsp;
+    randomInstance(tsp, n, seed);
+    minstd_rand random(seed);
+
+    TSPSolution current(tsp);
+    current.initRandom(seed);
+    current.evaluate(tsp);
+    TSPSolution naive(current);
+    TSPSolution atMark(current), bestAtMark(current);
+
+    MoveJournal journal;
+    journal.reset(current);
+
+    unsigned long allocations = 0;
+    for (int trial = 0; trial < 300; trial++) {
+        unsigned long before = AllocationCounter::count();
+
+        // a walk, long enough at times to overflow the journal
+        int walk = (trial % 7 == 0) ? 3 * n : random() % 20;
+        bool marking = trial % 5 != 0;
+        for (int step = 0; step < walk; step++) {
+            TSPMove move = randomMove(random, n);
+            current.apply(tsp, move);
+            journal.record(tsp, move);
+            if (marking && (current.value() < naive.value() || random() % 20 == 0)) {
+                journal.markBest(current);
+                naive = current;
+            }
+        }
+
+        journal.mark();
+        atMark = current;
+        bestAtMark = naive;
+
+        int trialMoves = 1 + random() % (n / 2);
+        for (int step = 0; step < trialMoves; step++) {
+            TSPMove move = randomMove(random, n);
+            current.apply(tsp, move);
+            journal.record(tsp, move);
+            if (random() % 4 == 0) {
+                journal.markBest(current);
+                naive = current;
+            }
+            if (random() % 8 == 0) {
+                CHECK(journal.best(tsp).sequence == naive.sequence);
+            }
+        }
+
+        if (random() % 3 == 0) {
+            journal.rollback(tsp, current);
+            naive = bestAtMark;
+            CHECK(current.sequence == atMark.sequence);
+            CHECK_NEAR(current.value(), atMark.value(), 1e-6);
+        }
+        CHECK(journal.best(tsp).sequence == naive.sequence);
+
+        if (trial >= 10) {
+            allocations += AllocationCounter::count() - before;
+        }
+    }
+    CHECK_NEAR(current.value(), current.evaluateObjectiveFunction(tsp), 1e-6);
+    if (AllocationCounter::enabled()) {
+        CHECK(allocations == 0);
+    }
+}
+
+/** a trial longer than the journal cannot be rolled back, nor a journal without a mark */
+void testRollbackOverflow() {
+    TSP tsp;
+    randomInstance(tsp, 100, 9);
+    minstd_rand random(9);
+
+    TSPSolution current(tsp);
+    MoveJournal journal;
+    journal.reset(current);
+
+    bool thrown = false;
+    try {
+        journal.rollback(tsp, current);
+    }
+    catch (runtime_error&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+
+    journal.mark();
+    for (int step = 0; step < 1000; step++) {
+        TSPMove move = randomMove(random, tsp.n);
+        current.apply(tsp, move);
+        journal.record(tsp, move);
+    }
+    thrown = false;
+    try {
+        journal.rollback(tsp, current);
+    }
+    catch (runtime_error&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+/** reset() on a journal of the same size reuses its buffers */
+void testResetDoesNotAllocate() {
+    TSP tsp;
+    randomInstance(tsp, 50, 3);
+    TSPSolution sol(tsp);
+    MoveJournal journal;
+    journal.reset(sol);
+
+    unsigned long before = AllocationCounter::count();
+    journal.reset(sol);
+    if (AllocationCounter::enabled()) {
+        CHECK(AllocationCounter::count() == before);
+    }
+}
+
+}
+
+int main() {
+    testAgainstNaiveCopy(12, 5000, 1);
+    testAgainstNaiveCopy(100, 20000, 2);
+    testAgainstNaiveCopy(257, 20000, 3);
+    testOverflowWithoutMark();
+    testRollback(12, 4);
+    testRollback(100, 5);
+    testRollback(257, 6);
+    testRollbackOverflow();
+    testResetDoesNotAllocate();
+    return checkResult("MoveJournal");
+}
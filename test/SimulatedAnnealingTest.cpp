@@ -0,0 +1,65 @@
+/**
+ * @file SimulatedAnnealingTest.cpp
+ * @brief SimulatedAnnealingSolver: the O(1) move variations against the applied moves
+ */
+
+#include "Check.h"
+#include "SimulatedAnnealingSolver.h"
+#include "ConvergenceTrace.h"
+#include "Logger.h"
+
+using namespace std;
+
+namespace {
+
+/**
+ * the solver tracks the value of its tour by adding up the variations of the
+ * accepted 2-opt and Or-opt moves: the best value it recorded in the trace must
+ * be the value of the tour it returns, evaluated from scratch
+ */
+void testVariations(int n, bool matrix, unsigned seed) {
+    TSP tsp;
+    randomInstance(tsp, n, seed, matrix);
+
+    TSPSolution init(tsp);
+    init.initRandom(seed);
+    init.evaluate(tsp);
+
+    ConvergenceTrace trace;
+    SimulatedAnnealingSolver solver(100, NULL, seed, 20);
+    solver.stopCriteria().setIterationLimit(60).setTrace(&trace);
+
+    TSPSolution best(init);
+    CHECK(solver.solve(tsp, init, best));
+    CHECK(best.iterations > 0);
+    CHECK(trace.size() > 0);
+
+    double value = best.evaluateObjectiveFunction(tsp);
+    CHECK(value < init.value());
+    CHECK_NEAR(best.value(), value, 1e-6 * value);
+    if (trace.size() > 0) {
+        CHECK_NEAR(trace[trace.size() - 1].value, value, 1e-6 * value);
+    }
+
+    // a permutation of the nodes, 0 first and last
+    vector<int> count(n, 0);
+    for (size_t i = 0; i < best.sequence.size(); i++) {
+        count[best.sequence[i]]++;
+    }
+    CHECK(best.sequence.front() == 0 && best.sequence.back() == 0);
+    CHECK(count[0] == 2);
+    for (int i = 1; i < n; i++) {
+        CHECK(count[i] == 1);
+    }
+}
+
+}
+
+int main() {
+    Logger::setLevel(Logger::WARN);
+
+    testVariations(8, true, 1);
+    testVariations(60, true, 2);
+    testVariations(200, false, 3);
+    return checkResult("SimulatedAnnealing");
+}
@@ -0,0 +1,172 @@
+/**
+ * @file SolverDaemonTest.cpp
+ * @brief SolverDaemon: the line protocol, through a client on the Unix socket
+ */
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <cstring>
+#include <cstdlib>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Check.h"
+#include "SolverDaemon.h"
+#include "Logger.h"
+
+using namespace std;
+
+namespace {
+
+const char* INSTANCE = "data/tsp12.dat";
+
+/** blocking line client, every read gives up after 30 s */
+class Client
+{
+public:
+
+    explicit Client(const string& path) : mFd(socket(AF_UNIX, SOCK_STREAM, 0)) {
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        CHECK(connect(mFd, (sockaddr*)&address, sizeof(address)) == 0);
+    }
+
+    ~Client() {
+        close(mFd);
+    }
+
+    void send(const string& line) {
+        string text = line + "\n";
+        CHECK(write(mFd, text.data(), text.size()) == (ssize_t)text.size());
+    }
+
+    /** the next reply line, "" on timeout or when the daemon closed the connection */
+    string receive() {
+        for (;;) {
+            size_t end = mBuffer.find('\n');
+            if (end != string::npos) {
+                string line = mBuffer.substr(0, end);
+                mBuffer.erase(0, end + 1);
+                return line;
+            }
+            pollfd readable = {mFd, POLLIN, 0};
+            char chunk[4096];
+            ssize_t got = (poll(&readable, 1, 30000) == 1) ? read(mFd, chunk, sizeof(chunk)) : 0;
+            if (got <= 0) {
+                return "";
+            }
+            mBuffer.append(chunk, got);
+        }
+    }
+
+private:
+
+    int mFd;
+    string mBuffer;
+};
+
+/** first word, then the key=value words of a reply */
+map<string, string> fields(const string& reply) {
+    map<string, string> result;
+    istringstream words(reply);
+    string word;
+    words >> result[""];
+    while (words >> word) {
+        size_t equal = word.find('=');
+        if (equal != string::npos) {
+            result[word.substr(0, equal)] = word.substr(equal + 1);
+        }
+    }
+    return result;
+}
+
+void testProtocol(Client& client) {
+    TSP tsp;
+    tsp.readFromFile(INSTANCE);
+
+    // load, then solve the cached instance by its key
+    client.send(string("load ") + INSTANCE);
+    CHECK(client.receive() == "queued 1");
+    map<string, string> loaded = fields(client.receive());
+    CHECK(loaded[""] == "loaded");
+    CHECK(loaded["nodes"] == "12");
+    CHECK(loaded["cached"] == "0");
+    CHECK(!loaded["instance"].empty());
+
+    client.send("solve @" + loaded["instance"] + " --ls --fi --seed 3");
+    CHECK(client.receive() == "queued 2");
+    string reply = client.receive();
+    CHECK(reply.compare(0, 9, "result 2 ") == 0);
+    map<string, string> result = fields(reply);
+    CHECK(result["instance"] == loaded["instance"]);
+    CHECK(result["cached"] == "1");
+    CHECK(result["stop"] == "converged");
+
+    // the tour: node 0 first and last, every node once, of the value replied
+    vector<int> tour;
+    istringstream nodes(result["tour"]);
+    for (string node; getline(nodes, node, ','); ) {
+        tour.push_back(atoi(node.c_str()));
+    }
+    CHECK(tour.size() == 13);
+    if (tour.size() == 13) {
+        vector<int> count(12, 0);
+        double value = 0;
+        for (size_t i = 0; i < tour.size(); i++) {
+            CHECK(tour[i] >= 0 && tour[i] < 12);
+            count[tour[i] % 12]++;
+            if (i > 0) {
+                value += tsp.cost(tour[i - 1], tour[i]);
+            }
+        }
+        CHECK(tour.front() == 0 && tour.back() == 0);
+        count[0]--;
+        CHECK(count == vector<int>(12, 1));
+        CHECK_NEAR(atof(result["value"].c_str()), value, 1e-3);
+    }
+
+    // errors: unknown request (id 0), bad option (the id of the request), missing file
+    client.send("frobnicate");
+    CHECK(client.receive().compare(0, 8, "error 0 ") == 0);
+    client.send(string("solve ") + INSTANCE + " --bogus");
+    CHECK(client.receive().compare(0, 8, "error 3 ") == 0);
+    client.send("solve data/no-such-instance.dat --ls");
+    CHECK(client.receive() == "queued 4");
+    CHECK(client.receive().compare(0, 8, "error 4 ") == 0);
+
+    client.send("stats");
+    map<string, string> stats = fields(client.receive());
+    CHECK(stats[""] == "stats");
+    CHECK(stats["instances"] == "1");
+    CHECK(stats["hits"] == "1");
+    // a job counts as done just after its reply
+    CHECK(stats["queued"] == "0");
+    CHECK(atoi(stats["running"].c_str()) + atoi(stats["done"].c_str()) == 3);
+}
+
+}
+
+int main() {
+    Logger::setLevel(Logger::ERROR);
+
+    const string socketPath = "/tmp/tspd-test-" + to_string(getpid()) + ".sock";
+    {
+        SolverDaemon daemon(socketPath, 2, 64 << 20);
+        thread server([&daemon]() { daemon.serve(); });
+        {
+            Client client(socketPath);
+            testProtocol(client);
+        }
+        daemon.stop();
+        server.join();
+    }
+    CHECK(access(socketPath.c_str(), F_OK) != 0);
+    return checkResult("SolverDaemon");
+}
@@ -0,0 +1,84 @@
+/**
+ * @file StatisticsTest.cpp
+ * @brief Statistics: summary, Student t quantiles, confidence intervals, Welch's test
+ */
+
+#include "Check.h"
+#include "Statistics.h"
+
+using namespace std;
+
+namespace {
+
+void testSummary() {
+    Statistics odd(vector<double>{5, 1, 4, 2, 3});
+    CHECK(odd.n == 5);
+    CHECK_NEAR(odd.mean, 3, 1e-12);
+    CHECK_NEAR(odd.median, 3, 1e-12);
+    CHECK(odd.min == 1 && odd.max == 5);
+    CHECK_NEAR(odd.sd, sqrt(2.5), 1e-12);
+
+    Statistics even(vector<double>{4, 1, 3, 2});
+    CHECK_NEAR(even.median, 2.5, 1e-12);
+
+    Statistics single(vector<double>{7});
+    CHECK(single.n == 1 && single.sd == 0 && single.median == 7);
+
+    Statistics empty(vector<double>{});
+    CHECK(empty.n == 0);
+}
+
+/** table values of Student's t */
+void testStudent() {
+    CHECK_NEAR(Statistics::studentQuantile(0.975, 1), 12.7062, 1e-3);
+    CHECK_NEAR(Statistics::studentQuantile(0.975, 4), 2.7764, 1e-3);
+    CHECK_NEAR(Statistics::studentQuantile(0.975, 30), 2.0423, 1e-3);
+    CHECK_NEAR(Statistics::studentQuantile(0.95, 10), 1.8125, 1e-3);
+    CHECK_NEAR(Statistics::studentQuantile(0.975, 1e6), 1.9600, 1e-3);
+    CHECK_NEAR(Statistics::studentQuantile(0.025, 4), -2.7764, 1e-3);
+
+    CHECK_NEAR(Statistics::studentCdf(0, 3), 0.5, 1e-9);
+    CHECK_NEAR(Statistics::studentCdf(1, 8), 0.8267, 1e-4);
+    CHECK_NEAR(Statistics::studentCdf(-1, 8), 1 - 0.8267, 1e-4);
+    for (double p = 0.01; p < 1; p += 0.07) {
+        CHECK_NEAR(Statistics::studentCdf(Statistics::studentQuantile(p, 6), 6), p, 1e-6);
+    }
+}
+
+void testConfidence() {
+    // t0.975,4 s / sqrt(n) with s^2 = 2.5
+    Statistics sample(vector<double>{1, 2, 3, 4, 5});
+    CHECK_NEAR(sample.confidenceHalfWidth(), 2.7764 * sqrt(2.5) / sqrt(5.0), 1e-3);
+    CHECK(sample.confidenceHalfWidth(0.99) > sample.confidenceHalfWidth(0.95));
+
+    Statistics single(vector<double>{3});
+    CHECK(single.confidenceHalfWidth() == 0);
+}
+
+void testWelch() {
+    // t = -1 with 8 degrees of freedom
+    Statistics a(vector<double>{1, 2, 3, 4, 5});
+    Statistics b(vector<double>{2, 3, 4, 5, 6});
+    CHECK_NEAR(Statistics::pGreater(a, b), 0.8267, 1e-3);
+    CHECK_NEAR(Statistics::pGreater(b, a), 1 - 0.8267, 1e-3);
+
+    Statistics far(vector<double>{100, 101, 102, 103, 104});
+    CHECK(Statistics::pGreater(far, a) < 1e-6);
+    CHECK(Statistics::pGreater(a, far) > 1 - 1e-6);
+
+    // no variance
+    Statistics one(vector<double>{1}), two(vector<double>{2});
+    CHECK(Statistics::pGreater(two, one) == 0);
+    CHECK(Statistics::pGreater(one, two) == 1);
+    CHECK(Statistics::pGreater(one, one) == 1);
+}
+
+}
+
+int main() {
+    testSummary();
+    testStudent();
+    testConfidence();
+    testWelch();
+    return checkResult("Statistics");
+}
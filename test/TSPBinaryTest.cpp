@@ -0,0 +1,105 @@
+/**
+ * @file TSPBinaryTest.cpp
+ * @brief TSPBinary: write and map round trip, headers that must not be mapped
+ */
+
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+
+#include "Check.h"
+#include "TSPBinary.h"
+#include "Logger.h"
+
+using namespace std;
+
+namespace {
+
+const char* BINARY = "test/TSPBinaryTest.bin";
+const char* CRAFTED = "test/TSPBinaryTest-crafted.bin";
+
+void testRoundTrip() {
+    TSP tsp;
+    randomInstance(tsp, 37, 1);
+    TSPBinary::write(tsp, BINARY);
+
+    TSP mapped;
+    TSPBinary::map(BINARY, mapped);
+    CHECK(mapped.n == tsp.n);
+    bool same = true;
+    for (int i = 0; i < tsp.n; i++) {
+        for (int j = 0; j < tsp.n; j++) {
+            same = same && mapped.cost(i, j) == tsp.cost(i, j);
+        }
+    }
+    CHECK(same);
+}
+
+/** the file written by testRoundTrip() with its header changed, and `size` bytes long (0: as is) */
+bool rejected(void (*change)(TSPBinary::Header&, const vector<char>&), size_t size = 0) {
+    ifstream in(BINARY, ios::binary);
+    vector<char> bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    TSPBinary::Header header;
+    memcpy(&header, &bytes[0], sizeof(header));
+    change(header, bytes);
+    memcpy(&bytes[0], &header, sizeof(header));
+    if (size > 0) {
+        bytes.resize(size);
+    }
+    ofstream out(CRAFTED, ios::binary);
+    out.write(&bytes[0], bytes.size());
+    out.close();
+
+    TSP tsp;
+    try {
+        TSPBinary::map(CRAFTED, tsp);
+    }
+    catch (runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void unchanged(TSPBinary::Header&, const vector<char>&) {}
+void offsetInHeader(TSPBinary::Header& header, const vector<char>&) { header.dataOffset = 0; }
+void offsetUnaligned(TSPBinary::Header& header, const vector<char>&) { header.dataOffset += 8; }
+void noNodes(TSPBinary::Header& header, const vector<char>&) { header.n = 0; }
+void strideBelowN(TSPBinary::Header& header, const vector<char>&) { header.stride = header.n - 1; }
+void strideAboveInt(TSPBinary::Header& header, const vector<char>&) { header.stride = (int64_t)1 << 40; }
+/**
+ * n * stride = 2^61 + 8: with the offset of 64, 8 n stride + dataOffset wraps around
+ * to 128 on 64 bits, and the checksum loop ends after 8 doubles: that is the checksum
+ */
+void wrappingSize(TSPBinary::Header& header, const vector<char>& bytes) {
+    header.n = 1073807362;
+    header.stride = 2147352580;
+    header.checksum = TSPBinary::checksum(reinterpret_cast<const double*>(&bytes[header.dataOffset]), 8);
+}
+void badVersion(TSPBinary::Header& header, const vector<char>&) { header.version++; }
+
+void testCraftedHeaders() {
+    CHECK(!rejected(unchanged));
+    CHECK(rejected(unchanged, 100));
+    CHECK(rejected(offsetInHeader));
+    CHECK(rejected(offsetUnaligned));
+    CHECK(rejected(noNodes));
+    CHECK(rejected(strideBelowN));
+    CHECK(rejected(strideAboveInt));
+    CHECK(rejected(wrappingSize));
+    CHECK(rejected(badVersion));
+
+    remove(BINARY);
+    remove(CRAFTED);
+}
+
+}
+
+int main() {
+    Logger::setLevel(Logger::ERROR);
+
+    testRoundTrip();
+    testCraftedHeaders();
+    return checkResult("TSPBinary");
+}
@@ -0,0 +1,91 @@
+/**
+ * @file TabuMemoryTest.cpp
+ * @brief TabuMemory against a map of the last tabu iteration of every move
+ */
+
+#include <map>
+#include <random>
+
+#include "Check.h"
+#include "TabuMemory.h"
+#include "AllocationCounter.h"
+
+using namespace std;
+
+namespace {
+
+/**
+ * random moves, movesPerIteration of them per iteration: isTabu() must agree
+ * with the map, and collect() too while the ring holds every tabu move
+ */
+void testAgainstMap(int last, int tenure, int movesPerIteration, unsigned seed) {
+    minstd_rand random(seed);
+    map< pair<int, int>, int > expiry;
+    TabuMemory tabu;
+    tabu.reset(tenure);
+
+    vector< pair<int, int> > collected;
+
+    for (int iter = 1; iter <= 5000; iter++) {
+        for (int m = 0; m < movesPerIteration; m++) {
+            int from = 1 + random() % (last - 2);
+            int to = from + 1 + random() % (last - 1 - from);
+            tabu.add(from, to, iter);
+            expiry[make_pair(from, to)] = iter + tenure;
+        }
+
+        const int now = iter + 1;
+        for (int k = 0; k < 20; k++) {
+            int from = 1 + random() % (last - 2);
+            int to = from + 1 + random() % (last - 1 - from);
+            map< pair<int, int>, int >::const_iterator it = expiry.find(make_pair(from, to));
+            CHECK(tabu.isTabu(from, to, now) == (it != expiry.end() && it->second >= now));
+        }
+        for (map< pair<int, int>, int >::const_iterator it = expiry.begin(); it != expiry.end(); ++it) {
+            if (it->second >= now) {
+                CHECK(tabu.isTabu(it->first.first, it->first.second, now));
+            }
+        }
+
+        if (movesPerIteration == 1 && iter % 50 == 0) {
+            tabu.collect(now, collected);
+            size_t tabuMoves = 0;
+            for (map< pair<int, int>, int >::const_iterator it = expiry.begin(); it != expiry.end(); ++it) {
+                tabuMoves += it->second >= now;
+            }
+            CHECK(collected.size() == tabuMoves);
+        }
+    }
+}
+
+/** one move per iteration: no allocation after reset() */
+void testAddDoesNotAllocate(int tenure) {
+    TabuMemory tabu;
+    tabu.reset(tenure);
+    minstd_rand random(5);
+
+    unsigned long before = AllocationCounter::count();
+    int tabuMoves = 0;
+    for (int iter = 1; iter <= 100000; iter++) {
+        int from = 1 + random() % 998;
+        int to = from + 1 + random() % (999 - from);
+        tabu.add(from, to, iter);
+        tabuMoves += tabu.isTabu(from, to, iter + 1);
+    }
+    CHECK(tabuMoves == 100000);
+    if (AllocationCounter::enabled()) {
+        CHECK(AllocationCounter::count() == before);
+    }
+}
+
+}
+
+int main() {
+    testAgainstMap(20, 7, 1, 1);            // few moves: the same ones again and again
+    testAgainstMap(1000, 50, 1, 2);
+    testAgainstMap(100000, 200, 1, 3);
+    testAgainstMap(1000, 10, 8, 4);         // more tabu moves than the tenure
+    testAddDoesNotAllocate(1);
+    testAddDoesNotAllocate(100);
+    return checkResult("TabuMemory");
+}
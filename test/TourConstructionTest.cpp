@@ -0,0 +1,79 @@
+/**
+ * @file TourConstructionTest.cpp
+ * @brief TourConstruction: every method builds an evaluated permutation
+ */
+
+#include <stdexcept>
+
+#include "Check.h"
+#include "TourConstruction.h"
+
+using namespace std;
+
+namespace {
+
+/** node 0 first and last, every node once, of the value of the tour */
+void checkTour(const TSP& tsp, TourConstruction::Method method) {
+    TSPSolution sol(tsp);
+    TourConstruction::build(tsp, method, sol);
+
+    CHECK(sol.sequence.size() == (size_t)tsp.n + 1);
+    if (sol.sequence.size() != (size_t)tsp.n + 1) {
+        return;
+    }
+    CHECK(sol.sequence.front() == 0 && sol.sequence.back() == 0);
+    vector<int> count(tsp.n, 0);
+    for (int k = 0; k < tsp.n; k++) {
+        CHECK(sol.sequence[k] >= 0 && sol.sequence[k] < tsp.n);
+        count[sol.sequence[k] % tsp.n]++;
+    }
+    CHECK(count == vector<int>(tsp.n, 1));
+    CHECK_NEAR(sol.value(), sol.evaluateObjectiveFunction(tsp), 1e-6);
+}
+
+void testMethods(int n, unsigned seed) {
+    const TourConstruction::Method methods[] = {
+        TourConstruction::RANDOM,
+        TourConstruction::NEAREST_NEIGHBOR,
+        TourConstruction::GREEDY,
+        TourConstruction::CHEAPEST_INSERTION,
+        TourConstruction::FARTHEST_INSERTION
+    };
+
+    TSP matrix;
+    randomInstance(matrix, n, seed);
+    TSP coordinates;
+    randomInstance(coordinates, n, seed, false);
+    for (size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++) {
+        checkTour(matrix, methods[m]);
+        checkTour(coordinates, methods[m]);
+    }
+    checkTour(coordinates, TourConstruction::SPACE_FILLING_CURVE);
+}
+
+/** the space-filling curve needs coordinates */
+void testCurveOnMatrix() {
+    TSP tsp;
+    randomInstance(tsp, 50, 1);
+    TSPSolution sol(tsp);
+    bool thrown = false;
+    try {
+        TourConstruction::build(tsp, TourConstruction::SPACE_FILLING_CURVE, sol);
+    }
+    catch (runtime_error&) {
+        thrown = true;
+    }
+    CHECK(thrown);
+}
+
+}
+
+int main() {
+    testMethods(3, 1);
+    testMethods(5, 2);
+    testMethods(12, 3);
+    testMethods(200, 4);
+    testMethods(1500, 5);
+    testCurveOnMatrix();
+    return checkResult("TourConstruction");
+}
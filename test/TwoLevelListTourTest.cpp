@@ -0,0 +1,91 @@
+/**
+ * @file TwoLevelListTourTest.cpp
+ * @brief TwoLevelListTour against ArrayTour over random flips
+ */
+
+#include <algorithm>
+#include <random>
+
+#include "Check.h"
+#include "ArrayTour.h"
+#include "TwoLevelListTour.h"
+
+using namespace std;
+
+namespace {
+
+/**
+ * the two tours are the same cycle; a flip may reverse either path, so the
+ * list may run through it the other way round
+ * @return true if the list runs the other way round
+ */
+bool checkSameCycle(const ArrayTour& array, const TwoLevelListTour& list, minstd_rand& random) {
+    const int n = array.size();
+    const bool mirrored = n > 2 && list.next(0) != array.next(0);
+
+    for (int a = 0; a < n; a++) {
+        CHECK(list.next(a) == (mirrored ? array.prev(a) : array.next(a)));
+        CHECK(list.prev(a) == (mirrored ? array.next(a) : array.prev(a)));
+        CHECK(list.prev(list.next(a)) == a);
+    }
+    for (int k = 0; k < 50; k++) {
+        int a = random() % n, b = random() % n, c = random() % n;
+        CHECK(list.between(a, b, c) == (mirrored ? array.between(c, b, a) : array.between(a, b, c)));
+    }
+
+    vector<int> expected, sequence;
+    array.toSequence(expected);
+    list.toSequence(sequence);
+    if (mirrored) {
+        reverse(expected.begin(), expected.end());
+    }
+    CHECK(sequence == expected);
+    return mirrored;
+}
+
+/** random 2-opt flips on both tours, from a random tour */
+void testAgainstArray(int n, int flips, unsigned seed) {
+    minstd_rand random(seed);
+
+    vector<int> start(n + 1);
+    for (int i = 0; i < n; i++) {
+        start[i] = i;
+    }
+    shuffle(start.begin() + 1, start.begin() + n, random);
+    start[n] = 0;
+
+    ArrayTour array(n);
+    TwoLevelListTour list(n);
+    array.load(start);
+    list.load(start);
+    bool mirrored = checkSameCycle(array, list, random);
+
+    for (int f = 0; f < flips; f++) {
+        int a = random() % n;
+        int c = random() % n;
+        int b = array.next(a);
+        int d = array.next(c);
+
+        array.flip(a, b, c, d);
+        // the same edges (a, b) and (c, d), seen from the other direction
+        if (mirrored) {
+            list.flip(b, a, d, c);
+        } else {
+            list.flip(a, b, c, d);
+        }
+        mirrored = checkSameCycle(array, list, random);
+    }
+}
+
+}
+
+int main() {
+    // a single segment, one partly filled, n a multiple of the segment size
+    testAgainstArray(5, 200, 1);
+    testAgainstArray(8, 200, 2);
+    testAgainstArray(13, 500, 3);
+    testAgainstArray(64, 2000, 4);
+    testAgainstArray(101, 2000, 5);
+    testAgainstArray(1000, 3000, 6);
+    return checkResult("TwoLevelListTour");
+}
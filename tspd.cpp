@@ -0,0 +1,95 @@
+/**
+ * @file tspd.cpp
+ * @brief solver daemon: serve solve jobs on a Unix domain socket (see SolverDaemon)
+ *
+ * ./tspd /tmp/tspd.sock --jobs 4 --cache 2048
+ * echo "solve $PWD/data/rnd100.dat --ts --tenure 20 --secs 1 --seed 7" | socat - UNIX-CONNECT:/tmp/tspd.sock
+ */
+
+#include <stdexcept>
+#include <string>
+#include <cstdlib>
+
+#include <getopt.h>
+#include <signal.h>
+
+#include "SolverDaemon.h"
+#include "Logger.h"
+
+using namespace std;
+
+static struct option long_options[] = {
+    {"jobs", required_argument, NULL, 'j'},     // Jobs run at the same time (0 = all cores)
+    {"cache", required_argument, NULL, 'c'},    // Instance cache capacity (MB)
+    {"log", required_argument, NULL, 'L'},      // Console log level: error, warn, info, debug or trace
+    {0, 0, 0, 0}
+};
+
+// SIGINT / SIGTERM stop the daemon, the running jobs reply with their best tour
+static SolverDaemon* daemonToStop = NULL;
+
+static void onStop(int) {
+    if (daemonToStop != NULL) {
+        daemonToStop->stop();
+    }
+}
+
+int main (int argc, char *argv[]) {
+    int status = 0;
+
+    try {
+
+        int jobs = 0;
+        double cacheMegabytes = 1024;
+
+        int c;
+        int option_index;
+
+        while ((c = getopt_long(argc, argv, "j:c:L:", long_options, &option_index)) != EOF) {
+            switch (c) {
+                case 'j': {
+                    jobs = (int)strtol(optarg, NULL, 0);
+                    break;
+                }
+                case 'c': {
+                    cacheMegabytes = strtod(optarg, NULL);
+                    if (cacheMegabytes <= 0) {
+                        throw runtime_error("the cache capacity must be > 0 (MB)");
+                    }
+                    break;
+                }
+                case 'L': {
+                    Logger::setLevel(Logger::parseLevel(optarg));
+                    break;
+                }
+                default: {
+                    throw runtime_error("usage: ./tspd <socket> [--jobs n] [--cache MB] [--log level]");
+                }
+            }
+        }
+
+        if (optind != argc - 1) {
+            throw runtime_error("usage: ./tspd <socket> [--jobs n] [--cache MB] [--log level]");
+        }
+
+        SolverDaemon daemon(argv[optind], jobs, (size_t)(cacheMegabytes * (1 << 20)));
+
+        daemonToStop = &daemon;
+        signal(SIGINT, onStop);
+        signal(SIGTERM, onStop);
+
+        daemon.serve();
+
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTERM, SIG_DFL);
+        daemonToStop = NULL;
+
+    }
+    catch (std::exception& e) {
+        LOG_ERROR << ">>>EXCEPTION: " << e.what();
+        status = 1;
+    }
+
+    Logger::instance().flush();
+    return status;
+}